@@ -0,0 +1,132 @@
+/*
+ * autotune.c
+ *
+ *  Created on: 17 OCT. 2026
+ *  Relay feedback experiment on the Vin loop, PI gains from the limit cycle
+ *
+ *  While the experiment runs the PWM interrupt bypasses the regulator: its output is the
+ *  operating point +/- the relay step, switched by the sign of the Vin error with a
+ *  hysteresis band. More duty pulls the PV voltage down, so the relay is high while
+ *  Vin is above the band. The loop settles into a limit cycle at the ultimate frequency.
+ *  Period and peak-to-peak error are taken from rising switch to rising switch over
+ *  AUTOTUNE_CYCLES cycles, after AUTOTUNE_SETTLE_CYCLES.
+ *
+ *  Describing function of a relay with hysteresis: Ku = 4h / (pi * sqrt(a^2 - eps^2)),
+ *  a the error amplitude, eps the hysteresis, h the relay step. The gains are per unit
+ *  like DCDC_setPidGains: error base 2^errorShift volts, output 1.0 = full period,
+ *  Ki per PWM period.
+ */
+
+#include "autotune.h"
+#include "adc.h"
+#include <math.h>
+
+#define AUTOTUNE_PI						3.14159265f
+
+volatile uint8_t autoTuneState = AUTOTUNE_IDLE;
+
+static int32_t atOut;																										// Q31 operating point
+static int32_t atRelay;																									// Q31 relay step
+static int32_t atHyst;																									// Q16 V
+static int8_t atSign;																										// 1 - relay high
+static int32_t atMax;																										// error extremes of the running cycle, Q16
+static int32_t atMin;
+static uint32_t atPeriods;																							// periods since the start
+static uint32_t atLastRise;
+static uint16_t atCycles;																								// rising switches
+static uint32_t atPeriodSum;																						// measured cycles
+static uint32_t atSwingSum;																							// Q16 V peak-to-peak
+
+/******************************************************************************************
+*  Arm the experiment, the PWM interrupt starts the relay at its next period.
+*  The relay starts high, the first cycle is partial and is part of the settling.
+*******************************************************************************************/
+void autoTuneStart(int32_t outQ31, int32_t relayQ31, int32_t hystQ){
+	autoTuneState = AUTOTUNE_IDLE;																				// not read by the interrupt
+	atOut = outQ31;
+	atRelay = relayQ31;
+	atHyst = hystQ;
+	atSign = 1;
+	atMax = 0;
+	atMin = 0;
+	atPeriods = 0;
+	atLastRise = 0;
+	atCycles = 0;
+	atPeriodSum = 0;
+	atSwingSum = 0;
+	autoTuneState = AUTOTUNE_RUNNING;
+}
+
+/******************************************************************************************
+*  PWM interrupt: Vin error of the last sample, returns the output of the next period,
+*  the operating point once the experiment is over
+*******************************************************************************************/
+int32_t autoTuneStep(int32_t vInErrorQ){
+	uint32_t period;
+
+	if(autoTuneState != AUTOTUNE_RUNNING) { return atOut; }
+
+	period = ++atPeriods;
+	if(vInErrorQ > atMax) { atMax = vInErrorQ; }
+	if(vInErrorQ < atMin) { atMin = vInErrorQ; }
+
+	if((atSign < 0) && (vInErrorQ > atHyst))																	// rising switch, one cycle complete
+	{
+		atSign = 1;
+		if(atCycles >= AUTOTUNE_SETTLE_CYCLES)
+		{
+			atPeriodSum += period - atLastRise;
+			atSwingSum += (uint32_t)(atMax - atMin);
+		}
+		atLastRise = period;
+		atMax = vInErrorQ;
+		atMin = vInErrorQ;
+		if(++atCycles >= AUTOTUNE_SETTLE_CYCLES + AUTOTUNE_CYCLES)
+		{
+			autoTuneState = AUTOTUNE_MEASURED;
+			return atOut;
+		}
+	}
+	else if((atSign > 0) && (vInErrorQ < -atHyst))
+	{
+		atSign = -1;
+	}
+
+	if(period >= AUTOTUNE_MAX_PERIODS)
+	{
+		autoTuneState = AUTOTUNE_FAIL;
+		return atOut;
+	}
+
+	return (atSign > 0) ? atOut + atRelay : atOut - atRelay;
+}
+
+void autoTuneStop(autoTuneState_ent state){
+	autoTuneState = state;
+}
+
+/******************************************************************************************
+*  Gains of the measured limit cycle, AUTOTUNE_DONE; a swing within the hysteresis is
+*  noise, not a limit cycle, AUTOTUNE_FAIL
+*******************************************************************************************/
+int autoTuneGains(uint8_t errorShift, float* pKp, float* pKi){
+	float tu, a, eps, h, ku;
+
+	if(autoTuneState != AUTOTUNE_MEASURED) { return -1; }
+
+	tu = (float)atPeriodSum * (1.0f / AUTOTUNE_CYCLES);														// PWM periods
+	a = (float)atSwingSum * (0.5f / (AUTOTUNE_CYCLES * (float)FIXED_ONE));					// V
+	eps = (float)atHyst * (1.0f / FIXED_ONE);
+	h = (float)atRelay * (1.0f / 2147483648.0f);
+	if((a <= eps) || (tu < 2.0f))
+	{
+		autoTuneState = AUTOTUNE_FAIL;
+		return -1;
+	}
+
+	ku = 4.0f * h * (float)(1UL << errorShift) / (AUTOTUNE_PI * sqrtf(a * a - eps * eps));
+	*pKp = AUTOTUNE_KP_KU * ku;
+	*pKi = *pKp / (AUTOTUNE_TI_TU * tu);
+	autoTuneState = AUTOTUNE_DONE;
+	return 0;
+}
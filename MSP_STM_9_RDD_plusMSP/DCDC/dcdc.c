@@ -1,11 +1,27 @@
 
-#include "Stm32f3xx.h"
+#include "stm32f3xx.h"
 #include "BoardInit.h"
 #include "HiResTim.h"
 #include "adc.h"
+#include "spread.h"
+#include "isrprof.h"
+#include "decim.h"
+#include "recip.h"
+#include "ivtrace.h"
+#include "autotune.h"
+#include "fra.h"
+#include "phase.h"
+#include "deadtime.h"
+#include "comp.h"
+#include "pcmc.h"
+#include "deadbeat.h"
+#include "protect.h"
 
 
 #include "dcdc.h"
+#if DCDC_REGULATOR == DCDC_REG_PI
+#include "arm_math.h"
+#endif
 
 /*
 *
@@ -48,7 +64,10 @@ volatile struct DCDC_Flags{
 	uint8_t CURRENT_LIMIT				  ;
 	uint8_t MAX_DUTY_LIMIT			  ;
 	uint8_t MIN_DUTY_LIMIT				;
-	uint8_t PERIOD_STEP_UP				;
+	uint8_t PID_GAINS_UPDATE			;
+	uint8_t BURST_MODE						;
+	uint8_t PROTECT_UPDATE				;
+	uint8_t SCALES_VALID					;
 };
 
  
@@ -57,35 +76,103 @@ volatile struct DCDC_Flags{
 #define VOUT_STAB				12U			// V
 #define IOUT_STAB				70U			// A
 
+#if DCDC_REGULATOR == DCDC_REG_PI
+#define PID_ERROR_SHIFT(b)	(31 - FIXED_Q - (b))												// Q16 volts / amperes to Q31 per unit
+#define PID_ERROR_LIMIT(b)	(1L << (FIXED_Q + (b) - 1))									// +/-0.5 pu, no overflow in the accumulator of pidStepQ31
+#endif
+#define CURR_LIMIT_AMPS_PER_CODE	(REFERENCE_VOLTAGE * 50 * I_CONVERCE_COEFF / 4096)		// nominal, until the slow path has a scale
+#define PID_DUTY_MIN_Q31		((int32_t)((uint64_t)DUTY_MIN * 0x80000000UL / BUCK_PERIOD))	// duty limits as Q31 ratio
+#define PID_DUTY_MAX_Q31		((int32_t)((uint64_t)DUTY_MAX * 0x80000000UL / BUCK_PERIOD))
+#if HRTIM_PEAK_CURRENT || DCDC_DEADBEAT
+#define PID_OUT_MIN_Q31			0																						// peak / inductor current 0..currLimitAmps
+#define PID_OUT_MAX_Q31			0x7FFFFFFF
+typedef char dcdcPeakCurrentCheck_t[(DCDC_REGULATOR == DCDC_REG_PI) ? 1 : -1];
+typedef char dcdcDeadbeatCheck_t[(!DCDC_DEADBEAT || (!HRTIM_PEAK_CURRENT && DCDC_FIXED_POINT)) ? 1 : -1];	// one current loop, Q16 load current
+#else
+#define PID_OUT_MIN_Q31			PID_DUTY_MIN_Q31
+#define PID_OUT_MAX_Q31			PID_DUTY_MAX_Q31
+#endif
+
 /**  Global variables declarations start **/
 
 static volatile  struct  DCDC_Flags statusFlags; 
 
 
-volatile __align(4)  regAdcValue_t momentValue = {0,0,0,0,0,0,0,0,0,0,0,0}; //for DMA
+volatile regAdcValue_t adcDmaBuf[2];		//DMA ping-pong: HT - [0] complete, TC - [1] complete
+volatile uint32_t adcSeq = 0;							//(completed sets << 1) | index of the last complete half
+#if ADC_INJECTED_FAST
+volatile uint32_t adcSlowDma[ADC_SLOW_SLOTS];	//DMA of the regular sequence, copied into the sets by the JEOS path
+#if ADC_SLOW_ROUND_ROBIN
+volatile uint32_t adcSlowPairs[ADC_SLOW_PAIRS];	//last rotation of the slow pairs, the sets carry the fast pairs only
+volatile uint32_t adcSlowRounds = 0;			//complete rotations, taken by measureExecute
+#endif
+uint16_t adcTrigNext = ADC_TRG;						//CMP2 written last, the ADC trigger of the running period
+#endif
+regAdcValue_t momentValue = {0}; 					//coherent snapshot of the last complete half
+uint32_t adcLost = 0;											//sets completed but not taken by measureExecute
 
-__align(4) wordAdcValue_t sumValueBank_1 = {0,0,0,0,0,0,0,0,0,0,0,0}; //temporary summ 1
-__align(4) wordAdcValue_t sumValueBank_2 = {0,0,0,0,0,0,0,0,0,0,0,0}; //temporary summ 2
- uint32_t *pSumValueNow = (uint32_t*)&sumValueBank_1;
- uint32_t *pSumValueStored = (uint32_t*)&sumValueBank_2;
+wordAdcValue_t decimValue = {0,0,0,0,0,0,0,0,0,0,0,0}; //decimator outputs, code * ADC_AVERAGE_NUMBER
+slowAdcValue_t slowValue = {0,0,0,0,0,0,0,0};		//slow channels, average codes at the slow decimator rate
 
 
  float adcVoutStab = VOUT_STAB;   //RD Target max output voltage  in Volts 
  float adcIoutStab = IOUT_STAB;   //RD Target max output current 
  uint16_t dutyCycle = DUTY_MIN;
+ uint16_t dutyRef = DUTY_MIN;   //duty in counts of BUCK_PERIOD, scaled to buckPeriod by spreadScaleDuty
  uint16_t buckPeriod = BUCK_PERIOD_MAX;  // ????
 
 
 
  int16_t delta;   //??????
-// int16_t delta_duty;   //spectr
- int32_t delta_duty;   //spectr
  uint16_t offset = 500;  //????
 
  float efficiency; //??????
 
  float Vin_Target=0; //target input voltage for MPPT
 
+int32_t Vin_TargetQ = 0; //target input voltage for MPPT, Q16
+uint32_t vInCodeScale = 0;  //volts per Vin ADC code, Q32, updated by the slow path
+uint32_t vOutCodeScale = 0; //volts per Vout ADC code, Q32
+uint32_t iOutCodeScale = 0; //amperes per Iout ADC code above ZERO_CURR_CODE, Q32
+int32_t vOutLimitQ = (int32_t)(VOUT_STAB * FIXED_ONE);	//output voltage limit, Q16
+int32_t iOutLimitQ = (int32_t)(IOUT_STAB * FIXED_ONE);	//output current limit, Q16
+uint8_t activeLoop = DCDC_LOOP_VIN;											//loop that set the duty of the last period
+int32_t ffDuty = 0;																			//feed-forward duty Vout/Vin of the last period, Q31
+int32_t burstEnterQ = (int32_t)(DCDC_BURST_ENTER_IOUT * FIXED_ONE);	//light load: pulse skipping below, Q16
+int32_t burstExitQ = (int32_t)(DCDC_BURST_EXIT_IOUT * FIXED_ONE);		//and back to every period above, Q16
+int32_t burstIoutQ = 0;																	//output current of the thresholds, DCDC_BURST_FILTER_LOG2, Q16
+volatile uint32_t workCycles = 0;																	//work cycles ended, for DCDC_Loop
+float currLimitAmps = DCDC_CYCLE_CURR_LIMIT;											//cycle-by-cycle current limit, A
+uint32_t currLimitEvents = 0;																			//PWM periods cut short by the current limit
+float slopeCompAmps = DCDC_PCMC_SLOPE;																		//peak current mode: compensation ramp, A/us
+volatile uint8_t faultCause = DCDC_FAULT_NONE;															//first analog watchdog fault since the last start
+protectLimits_t protectLimits;																						//AWD2 / AWD3 windows, applied by DCDC_Loop
+static uint8_t awdSeen = 0;																								//AWD2 / AWD3 tripped in the running sample set, bit per fault cause
+static uint8_t awdCount[DCDC_FAULT_VOUT + 1];																				//sample sets in a row out of the window
+float autoTuneKp = 0.0f;																									//Vin loop gains of the last autotune, per unit
+float autoTuneKi = 0.0f;
+uint8_t autoTuneNew = 0;																									//not taken by DCDC_getAutoTuneGains yet
+uint16_t fraFreqSingle;																											//Hz, the point of DCDC_startFra(freq)
+
+/* Hz, the sweep of DCDC_startFra(0), log spaced */
+static const uint16_t fraSweep[] = { 20, 25, 32, 41, 52, 66, 84, 107, 136, 174, 221, 280,
+																		 357, 453, 576, 733, 931, 1184, 1505, 1914, 2433, 3094, 3933, 5000 };
+
+typedef char dcdcAutoTuneCheck_t[(!DCDC_AUTOTUNE || DCDC_REGULATOR == DCDC_REG_PI) ? 1 : -1];	// tunes the PI gains
+typedef char dcdcFraCheck_t[(!DCDC_FRA || DCDC_REGULATOR == DCDC_REG_PI) ? 1 : -1];				// injects into the PI output
+typedef char dcdcFraSweepCheck_t[(sizeof(fraSweep) / sizeof(fraSweep[0]) <= FRA_POINTS_MAX) ? 1 : -1];
+
+#if DCDC_FIXED_POINT
+fixedValue_t fixedValue;																						// Q16 values of the last work cycle
+wordAdcValue_t averageCode;																// sums of the last work cycle for DCDC_Loop
+#endif
+
+#if DCDC_REGULATOR == DCDC_REG_PI
+static arm_pid_instance_q31 pid[DCDC_LOOPS_NUM];													// input Q31 error, output Q31 duty
+static q31_t pidGainsNew[DCDC_LOOPS_NUM][3];																// Kp, Ki, Kd waiting for the PWM interrupt
+static const uint8_t pidErrorBase[DCDC_LOOPS_NUM] = { DCDC_PID_VIN_SHIFT, DCDC_PID_IOUT_SHIFT, DCDC_PID_VOUT_SHIFT };
+#endif
+
 //extern Ctrl ctrl;
 
 /**  Global variables declarations end **/
@@ -99,6 +186,7 @@ __align(4) wordAdcValue_t sumValueBank_2 = {0,0,0,0,0,0,0,0,0,0,0,0}; //temporar
 int setVin(float Vin)
 {
 	Vin_Target=Vin;
+	Vin_TargetQ = (int32_t)(Vin * FIXED_ONE);
 	return 0;
 };
 
@@ -116,6 +204,267 @@ int DCDC_Enable_Disable(uint8_t ED)
 	statusFlags.CONTROL_ENABLE=ED;
 }; //RDD 1-Enable: DCDC work in stop mode; 0-Disable :  Not control DCDC, not regulator, but adc work
 
+#if DCDC_REGULATOR == DCDC_REG_PI
+static q31_t pidGainToQ31(float k)
+{
+	if(k >= 1.0f) { return 0x7FFFFFFF; }
+	if(k <= 0.0f) { return 0; }
+	return (q31_t)(k * 2147483648.0f);
+}
+#endif
+
+int DCDC_setPidGains(uint8_t loop, float kp, float ki, float kd)
+{
+#if DCDC_REGULATOR == DCDC_REG_PI
+	if(loop >= DCDC_LOOPS_NUM) { return -1; }
+	pidGainsNew[loop][0] = pidGainToQ31(kp);
+	pidGainsNew[loop][1] = pidGainToQ31(ki);
+	pidGainsNew[loop][2] = pidGainToQ31(kd);
+	statusFlags.PID_GAINS_UPDATE |= 1U << loop;														// taken over by the PWM interrupt
+	return 0;
+#else
+	return -1;
+#endif
+}
+
+int DCDC_setVoutLimit(float vOut)
+{
+	if(vOut < 0.0f) { return -1; }
+	vOutLimitQ = (int32_t)(vOut * FIXED_ONE);
+	return 0;
+}
+
+int DCDC_setIoutLimit(float iOut)
+{
+	if(iOut < 0.0f) { return -1; }
+	iOutLimitQ = (int32_t)(iOut * FIXED_ONE);
+	return 0;
+}
+
+uint8_t DCDC_getActiveLoop(void)
+{
+	return activeLoop;
+}
+
+int DCDC_setPhaseTrim(uint8_t phase, float duty)
+{
+	return phaseSetTrim(phase, (int16_t)(duty * BUCK_PERIOD));
+}
+
+int DCDC_setBurstThresholds(float iEnter, float iExit)
+{
+	if((iEnter < 0.0f) || (iExit <= iEnter)) { return -1; }
+	burstEnterQ = (int32_t)(iEnter * FIXED_ONE);
+	burstExitQ = (int32_t)(iExit * FIXED_ONE);
+	return 0;
+}
+
+uint8_t DCDC_isBurstMode(void)
+{
+	return statusFlags.BURST_MODE;
+}
+
+float DCDC_getEfficiency(void)
+{
+	return deadTimeEfficiency();
+}
+
+/******************************************************************************************
+*  DAC code of the current limit, the same ZERO_CURR_CODE offset and scale as the ADC
+*******************************************************************************************/
+static float currAmpsPerCode(void)
+{
+	return (iOutCodeScale != 0) ? iOutCodeScale * (1.0f / 4294967296.0f) : CURR_LIMIT_AMPS_PER_CODE;
+}
+
+#if HRTIM_CURR_LIMIT_EEV
+static uint16_t currLimitDacCode(float amps)
+{
+	float code = ZERO_CURR_CODE + amps / currAmpsPerCode();
+
+	return (code >= COMP_DAC_MAX) ? COMP_DAC_MAX : (uint16_t)code;
+}
+#endif
+
+#if HRTIM_PEAK_CURRENT
+/******************************************************************************************
+*  Limit and ramp of the peak current mode in DAC codes, the PWM interrupt takes them
+*******************************************************************************************/
+static void pcmcUpdateScale(void)
+{
+	float slope = slopeCompAmps * PCMC_STEP_US / currAmpsPerCode();
+
+	pcmcSetScale(currLimitDacCode(currLimitAmps), (slope >= COMP_DAC_MAX) ? COMP_DAC_MAX : (uint16_t)slope);
+}
+#endif
+
+int DCDC_setCycleCurrLimit(float amps)
+{
+#if HRTIM_CURR_LIMIT_EEV || DCDC_DEADBEAT
+	if(amps <= 0.0f) { return -1; }
+	currLimitAmps = amps;
+#if HRTIM_PEAK_CURRENT
+	pcmcUpdateScale();																										// DAC2 plays the ramp
+#elif HRTIM_CURR_LIMIT_EEV
+	setCurrLimitCode(currLimitDacCode(amps));
+#endif
+#if DCDC_DEADBEAT
+	deadbeatSetScale(amps);																								// reference 1.0 of the loops
+#endif
+	return 0;
+#else
+	(void)amps;
+	return -1;																														// no comparator
+#endif
+}
+
+int DCDC_setPlantModel(float inductance, float capacitance)
+{
+#if DCDC_DEADBEAT
+	return deadbeatSetModel(inductance, capacitance);
+#else
+	return -1;
+#endif
+}
+
+int DCDC_setSlopeComp(float ampsPerUs)
+{
+#if HRTIM_PEAK_CURRENT
+	if(ampsPerUs < 0.0f) { return -1; }
+	slopeCompAmps = ampsPerUs;
+	pcmcUpdateScale();
+	return 0;
+#else
+	return -1;
+#endif
+}
+
+uint32_t DCDC_getCurrLimitEvents(void)
+{
+	return currLimitEvents;
+}
+
+int DCDC_setProtectLimits(float vInMax, float vOutMax, float iInMin, float iInMax, float iOutMax)
+{
+	if((vInMax <= 0.0f) || (vOutMax <= 0.0f) || (iInMin >= iInMax) || (iOutMax <= 0.0f)) { return -1; }
+	protectLimits.vInMax = vInMax;
+	protectLimits.vOutMax = vOutMax;
+	protectLimits.iInMin = iInMin;
+	protectLimits.iInMax = iInMax;
+	protectLimits.iOutMax = iOutMax;
+	statusFlags.PROTECT_UPDATE = 1;																				// the ADCs are stopped out of the interrupts
+	return 0;
+}
+
+uint8_t DCDC_getFault(void)
+{
+	return faultCause;
+}
+
+int DCDC_startIvTrace(void)
+{
+#if DCDC_IV_TRACE
+	float ratio;
+	uint16_t dutyNow = DUTY_MAX;
+
+	if(!statusFlags.CONTROL_ENABLE || ivTraceActive() || autoTuneActive() || fraActive() || (vInCodeScale == 0)) { return -1; }
+	if(calculatedValue.vInSensor > 0.0f)																					// ideal buck duty of the operating point, any regulator
+	{
+		ratio = calculatedValue.vOutSensor / calculatedValue.vInSensor;
+		if(ratio < (float)DUTY_MAX / BUCK_PERIOD) { dutyNow = (ratio > (float)DUTY_MIN / BUCK_PERIOD) ? (uint16_t)(ratio * BUCK_PERIOD) : DUTY_MIN; }
+	}
+#if DCDC_LIGHT_LOAD
+	statusFlags.BURST_MODE = 0;																					// every period of the sweep has its pulse
+	hrtimersBurstStop();
+#endif
+	ivTraceStart(vInCodeScale, iOutCodeScale, dutyNow);										// Iin and Iout sensors have the same scale
+	return 0;
+#else
+	return -1;
+#endif
+}
+
+/******************************************************************************************
+*  Relay around the present output of the Vin loop, DCDC_Loop sets the gains after it
+*******************************************************************************************/
+int DCDC_startAutoTune(void)
+{
+#if DCDC_AUTOTUNE
+	q31_t out = pid[DCDC_LOOP_VIN].state[2];																// applied output, back-calculation
+	q31_t relay = (q31_t)(DCDC_AUTOTUNE_RELAY * 2147483648.0f);
+
+	if(!statusFlags.CONTROL_ENABLE || ivTraceActive() || autoTuneActive() || fraActive() || (activeLoop != DCDC_LOOP_VIN)) { return -1; }
+	if((out < PID_OUT_MIN_Q31 + relay) || (out > PID_OUT_MAX_Q31 - relay)) { return -1; }	// no room for the relay
+#if DCDC_LIGHT_LOAD
+	statusFlags.BURST_MODE = 0;																					// every period of the experiment has its pulse
+	hrtimersBurstStop();
+#endif
+	autoTuneNew = 0;
+	autoTuneStart(out, relay, (int32_t)(DCDC_AUTOTUNE_HYST * FIXED_ONE));
+	return 0;
+#else
+	return -1;
+#endif
+}
+
+uint8_t DCDC_getAutoTuneState(void)
+{
+	return autoTuneState;
+}
+
+int DCDC_getAutoTuneGains(float* pKp, float* pKi)
+{
+	if(!autoTuneNew) { return -1; }
+	autoTuneNew = 0;
+	*pKp = autoTuneKp;
+	*pKi = autoTuneKi;
+	return 0;
+}
+
+/******************************************************************************************
+*  Injection around the present output of the Vin loop: freq 0 - the sweep, else one
+*  point at freq Hz
+*******************************************************************************************/
+int DCDC_startFra(uint16_t freq)
+{
+#if DCDC_FRA
+	q31_t out = pid[DCDC_LOOP_VIN].state[2];																// applied output, back-calculation
+	q31_t amp = (q31_t)(DCDC_FRA_AMPLITUDE * 2147483648.0f);
+
+	if(!statusFlags.CONTROL_ENABLE || ivTraceActive() || autoTuneActive() || fraActive() || (activeLoop != DCDC_LOOP_VIN)) { return -1; }
+	if((out < PID_OUT_MIN_Q31 + amp) || (out > PID_OUT_MAX_Q31 - amp)) { return -1; }		// no room for the injection
+	if((freq != 0) && ((freq < FRA_FREQ_MIN) || (freq > FRA_FREQ_MAX))) { return -1; }
+#if DCDC_LIGHT_LOAD
+	statusFlags.BURST_MODE = 0;																					// every period of the response has its pulse
+	hrtimersBurstStop();
+#endif
+	if(freq == 0) { fraStart(fraSweep, sizeof(fraSweep) / sizeof(fraSweep[0]), amp); }
+	else
+	{
+		fraFreqSingle = freq;
+		fraStart(&fraFreqSingle, 1, amp);
+	}
+	return 0;
+#else
+	return -1;
+#endif
+}
+
+uint8_t DCDC_getFraState(void)
+{
+	return fraState;
+}
+
+uint16_t DCDC_getFraPointsNum(void)
+{
+	return fraGetPointsNum();
+}
+
+int DCDC_getFraPoint(uint16_t n, float* pFreq, float* pPlantDb, float* pPlantDeg, float* pLoopDb, float* pLoopDeg)
+{
+	return fraGetPoint(n, pFreq, pPlantDb, pPlantDeg, pLoopDb, pLoopDeg);
+}
+
 
 
 /*************************************************************************************************************************
@@ -123,12 +472,22 @@ int DCDC_Enable_Disable(uint8_t ED)
 *         Interrupt Handlers
 *
 **************************************************************************************************************************/
+static void awdPersist(void);
+
 void DMA1_Channel1_IRQHandler(void)
 {
+	ISR_PROF_ENTER();
 //	GPIOB->BSRR = GPIO_BSRR_BR_1;
-	
+	uint32_t flags = DMA1->ISR;
+	uint32_t done = ((flags & DMA_ISR_HTIF1) ? 1 : 0) + ((flags & DMA_ISR_TCIF1) ? 1 : 0);
 	DMA1->IFCR = DMA_IFCR_CGIF1;
+	
+	/* the half being written by the DMA now tells which one is complete, even if HT and TC came together */
+	adcSeq = ((adcSeq >> 1) + done) << 1 | ((DMA1_Channel1->CNDTR > ADC_PAIRS_NUM) ? 1 : 0);
 	statusFlags.ADC_CONVERS_COMPLIT = 1;
+#if !ADC_INJECTED_FAST
+	awdPersist();
+#endif
 	//EXTI->SWIER=EXTI_IMR_MR0;
 	
 	
@@ -136,24 +495,137 @@ void DMA1_Channel1_IRQHandler(void)
 	//measureExecute(); 
 	
 //	GPIOB->BSRR = GPIO_BSRR_BS_1;
-	
+	ISR_PROF_EXIT(ISR_PROF_DMA1_CH1);
 }
 
 
 //*************************************************************************************************************************
-void ADC1_2_IRQHandler(void){    //RDD fault
+static void faultLatch(uint8_t cause)
+{
+	hrtimersOutDisable();
+	statusFlags.FAULT_DETECT = 1;
+	if(faultCause == DCDC_FAULT_NONE) { faultCause = cause; }											// the first cause stays until the next start
+}
+
+/******************************************************************************************
+*  Window watchdogs: awdSeen has a bit per fault cause of the windows tripped since the last
+*  complete sample set, a window latches its fault after DCDC_AWD_PERSIST sets in a row.
+*  Is called at the end of every sample set, JEOS or the DMA half, both at ADC1_2 priority
+*******************************************************************************************/
+static void awdPersist(void)
+{
+	uint8_t seen = awdSeen;
+	uint8_t k;
+
+	awdSeen = 0;
+	for(k = DCDC_FAULT_IOUT; k <= DCDC_FAULT_VOUT; k++)
+	{
+		if(!(seen & (1U << k))) { awdCount[k] = 0; }
+			else if(++awdCount[k] >= DCDC_AWD_PERSIST) { faultLatch(k); }
+	}
+}
+
+#if ADC_INJECTED_FAST
+static void controlExecute(void);
+
+/******************************************************************************************
+*  JEOS: the injected pairs and the last slow pairs make the next set of the ping-pong,
+*  published like a DMA half, so the readers don't change. Every 2^ADC_SLOW_DIV_LOG2
+*  sets the regular sequence of the slow channels is started.
+*  ADC_SLOW_ROUND_ROBIN: the sets get the fast pairs only, the slow pair of the last start
+*  goes to adcSlowPairs and the next pair of the rotation is started.
+*******************************************************************************************/
+static void adcInjectedExecute(void)
+{
+	static uint32_t slowDiv = 0;
+	uint32_t seq = adcSeq;
+	uint32_t half = (seq & 1) ^ 1;
+	volatile regAdcValue_t* pSet = &adcDmaBuf[half];
+
+	pSet->pair[0] = (ADC1->JDR1 & ADC_JDR1_JDATA) | (ADC2->JDR1 << 16);						// iIn, vIn
+	pSet->pair[1] = (ADC1->JDR2 & ADC_JDR2_JDATA) | (ADC2->JDR2 << 16);						// iOut, vOut
+#if !ADC_SLOW_ROUND_ROBIN
+	{
+		uint16_t i = 0;
+		while(i < ADC_SLOW_PAIRS){
+			pSet->pair[ADC_FAST_PAIRS + i] = adcSlowDma[i];
+			i++;
+		}
+	}
+#endif
+	adcSeq = (((seq >> 1) + 1) << 1) | half;
+	statusFlags.ADC_CONVERS_COMPLIT = 1;
+
+	if((++slowDiv & ((1U << ADC_SLOW_DIV_LOG2) - 1)) == 0)
+	{
+#if ADC_SLOW_ROUND_ROBIN
+		static uint8_t slowPair = 0;
+
+		if(ADC1->ISR & ADC_ISR_EOS)																									// not after a restart by adcStop
+		{
+			ADC1->ISR = ADC_ISR_EOS;
+			adcSlowPairs[slowPair] = adcSlowDma[0];
+			if(slowPair == ADC_SLOW_PAIRS - 1) { adcSlowRounds++; }
+		}
+		slowPair = (slowPair + 1) & (ADC_SLOW_PAIRS - 1);
+		adcSlowStart(slowPair);
+#else
+		adcSlowStart(0);																													// one slow sequence, the master starts ADC2
+#endif
+	}
+
+	controlExecute();
+}
+#endif
+
+void ADC1_2_IRQHandler(void){    //RDD fault, the control interrupt spends no cycles on the limits
+	ISR_PROF_ENTER();
+	uint32_t isr1 = ADC1->ISR;
+	uint32_t isr2 = ADC2->ISR;
 	
-	if ( ADC1->ISR & ADC_ISR_AWD1){
+	if ( isr1 & ADC_ISR_AWD1){
 		ADC1->ISR = ADC_ISR_AWD1;
-		statusFlags.FAULT_DETECT = 1;
-		hrtimersOutDisable();
+		faultLatch(DCDC_FAULT_IOUT_PEAK);
+	}
+	if ( isr1 & ADC_ISR_AWD3){
+		ADC1->ISR = ADC_ISR_AWD3;
+		awdSeen |= 1U << DCDC_FAULT_IOUT;
 	}
+	if ( isr1 & ADC_ISR_AWD2){
+		ADC1->ISR = ADC_ISR_AWD2;
+		awdSeen |= 1U << DCDC_FAULT_IIN;
+	}
+	if ( isr2 & ADC_ISR_AWD2){
+		ADC2->ISR = ADC_ISR_AWD2;
+		awdSeen |= 1U << DCDC_FAULT_VIN;
+	}
+	if ( isr2 & ADC_ISR_AWD3){
+		ADC2->ISR = ADC_ISR_AWD3;
+		awdSeen |= 1U << DCDC_FAULT_VOUT;
+	}
+#if ADC_INJECTED_FAST
+	if ( isr1 & ADC_ISR_JEOS){																										// after the faults, a tripped period gets no new duty
+		ADC1->ISR = ADC_ISR_JEOS;
+		awdPersist();
+		adcInjectedExecute();
+	}
+#endif
+	ISR_PROF_EXIT(ISR_PROF_ADC1_2);
 }
 //*************************************************************************************************************************
-void EXTI0_IRQHandler(void)   //software interrupt for regulator
+static void controlStartStop(void);
+
+void EXTI0_IRQHandler(void)   //software interrupt after the PWM interrupt: averaging, scaling, start/stop
 {
 	GPIOB->BSRR = GPIO_BSRR_BR_1;
 		EXTI->PR=EXTI_IMR_MR0;
+
+	  measureExecute(); 
+	  
+	  endOfCycleExecute();
+
+	  controlStartStop();
+
 	GPIOB->BSRR = GPIO_BSRR_BS_1;
 //static	uint16_t tooglPin=0;
 //		switch(tooglPin)
@@ -172,29 +644,51 @@ void EXTI0_IRQHandler(void)   //software interrupt for regulator
 }
 
 //*************************************************************************************************************************
-uint16_t  Regulator(float Vin);
+uint16_t  Regulator(int32_t Vin);
 
-void HRTIM1_TIMA_IRQHandler(void)  
+/*
+* Critical path only: latest sample set -> regulator -> CMP1xR/CMP2xR.
+* Everything else is deferred to EXTI0 (priority 2).
+* Runs in the HRTIM REP interrupt, or at the injected JEOS with ADC_INJECTED_FAST.
+*/
+static void controlExecute(void)
 {
 	GPIOB->BSRR = GPIO_BSRR_BR_1;
-		HRTIM1->sTimerxRegs[TIM_A].TIMxICR=HRTIM_TIMICR_REPC;
-	//  EXTI->SWIER=EXTI_IMR_MR0; //software interrupt for regulator
-	
-	  measureExecute(); 
-	  
-	  endOfCycleExecute();
+#if HRTIM_CURR_LIMIT_EEV
+		if(HRTIM1->sTimerxRegs[TIM_A].TIMxISR & HRTIM_TIMISR_CPT1)									// EEV1 cut the last period
+		{
+			HRTIM1->sTimerxRegs[TIM_A].TIMxICR = HRTIM_TIMICR_CPT1C;
+			currLimitEvents++;
+		}
+#endif
 	
 	 	if(statusFlags.CONTROL_ENABLE)
 		{ 
-			dutyCycle= Regulator(Vin_Target);
+			dutyCycle= Regulator(Vin_TargetQ);
 			hrtimerUpdateDuty(dutyCycle);
+#if ADC_INJECTED_FAST && ISR_PROFILE
+			isrProfRecord(ISR_PROF_CTRL_LATENCY, (uint16_t)(HRTIM1->sTimerxRegs[TIM_A].CNTxR - adcTrigNext) >> 4);	// 16 HRTIM counts per CPU cycle
+#endif
+#if ADC_INJECTED_FAST
+			adcTrigNext = dutyCycle + ADC_OFFSET;
+#endif
 /*
 			efficiency = (calculatedValue.vOutSensor * calculatedValue.iOutSensor) /
 									 (calculatedValue.vInSensor * calculatedValue.iInSensor) * 100;
 */
 		}
+
+	EXTI->SWIER = EXTI_SWIER_SWIER0; //software interrupt for averaging, scaling and start/stop
 	
 	GPIOB->BSRR = GPIO_BSRR_BS_1;
+}
+
+void HRTIM1_TIMA_IRQHandler(void)  
+{
+	ISR_PROF_ENTER();
+		HRTIM1->sTimerxRegs[TIM_A].TIMxICR=HRTIM_TIMICR_REPC;
+		controlExecute();
+	ISR_PROF_EXIT(ISR_PROF_HRTIM);
 //static	uint16_t tooglPin=0;
 //		switch(tooglPin)
 //			{
@@ -226,9 +720,46 @@ int DCDC_Init()
 {
 	initCoreIoPins();
 	initAdcToDualRegularSimultaneousMode();
-	initDmaForAdc( (uint32_t)&momentValue,  (sizeof(momentValue)/sizeof(uint32_t)) );
+#if ADC_INJECTED_FAST
+	initDmaForAdc( (uint32_t)adcSlowDma,  ADC_SLOW_SLOTS );
+#else
+	initDmaForAdc( (uint32_t)adcDmaBuf,  (sizeof(adcDmaBuf)/sizeof(uint32_t)) );
+#endif
 	setAdcMasterAnalogWatchdogThresholds( FAULT_CURR_CODE, 0);
 	initHighResolutionTimer();
+#if HRTIM_CURR_LIMIT_EEV
+	initCurrLimitComparator(currLimitDacCode(currLimitAmps));
+#endif
+#if HRTIM_PEAK_CURRENT
+	pcmcInit(currLimitDacCode(currLimitAmps));
+	pcmcUpdateScale();
+#endif
+#if DCDC_DEADBEAT
+	deadbeatSetModel(DCDC_DEADBEAT_L, DCDC_DEADBEAT_C);
+	deadbeatSetScale(currLimitAmps);
+#endif
+	phaseInit();
+	deadTimeInit();
+	spreadInit();
+	fraInit();
+	decimInit();
+
+#if DCDC_REGULATOR == DCDC_REG_PI
+	pid[DCDC_LOOP_VIN].Kp = pidGainToQ31(DCDC_PID_KP);
+	pid[DCDC_LOOP_VIN].Ki = pidGainToQ31(DCDC_PID_KI);
+	pid[DCDC_LOOP_VIN].Kd = pidGainToQ31(DCDC_PID_KD);
+	pid[DCDC_LOOP_IOUT].Kp = pidGainToQ31(DCDC_PID_IOUT_KP);
+	pid[DCDC_LOOP_IOUT].Ki = pidGainToQ31(DCDC_PID_IOUT_KI);
+	pid[DCDC_LOOP_VOUT].Kp = pidGainToQ31(DCDC_PID_VOUT_KP);
+	pid[DCDC_LOOP_VOUT].Ki = pidGainToQ31(DCDC_PID_VOUT_KI);
+	{
+		uint16_t n = 0;
+		while(n < DCDC_LOOPS_NUM){
+			arm_pid_init_q31(&pid[n], 1);
+			n++;
+		}
+	}
+#endif
 
 
 	//delay_ms(100);
@@ -247,12 +778,101 @@ int DCDC_Init()
 	return 1;
 }
 
+#if DCDC_FIXED_POINT
+/******************************************************************************************
+* Float copies of the last work cycle for MEAS_update, out of the PWM interrupt.
+* Sequence lock on workCycles: EXTI0 writes averageCode / fixedValue and then counts the
+* cycle, it can't be preempted by the thread, so a copy is whole if the count didn't change.
+* Returns the work cycle of the copy.
+*******************************************************************************************/
+static uint32_t updateFloatValue(void)
+{
+	wordAdcValue_t code;
+	fixedValue_t value;
+	uint32_t* pCode = (uint32_t*)&code;
+	float* pAverageValue = (float*)&averageValue;
+	uint32_t cycle;
+	uint16_t i = 0;
+
+	do{
+		cycle = workCycles;
+		__DMB();
+		code = averageCode;
+		value = fixedValue;
+		__DMB();
+	} while(cycle != workCycles);																								// EXTI0 ran meanwhile, copy again
+
+	while(i < ADC_STRUCT_MEMBERS_NUM){
+		*pAverageValue = *pCode * 1.0f / ADC_SAMPLE_NUMBER;
+		pCode++;
+		pAverageValue++;
+		i++;
+	}
+
+	calculatedValue.vInSensor = value.vInSensor * (1.0f / FIXED_ONE);
+	calculatedValue.vOutSensor = value.vOutSensor * (1.0f / FIXED_ONE);
+	calculatedValue.iInSensor = value.iInSensor * (1.0f / FIXED_ONE);
+	calculatedValue.iOutSensor = value.iOutSensor * (1.0f / FIXED_ONE);
+	calculatedValue.iOutComSensor = value.iOutComSensor * (1.0f / FIXED_ONE);
+	calculatedValue.v12Sensor = value.v12Sensor * (1.0f / FIXED_ONE);
+	calculatedValue.vrefCpu = value.vrefCpu * (1.0f / FIXED_ONE);
+	return cycle;
+}
+#endif
+
 int DCDC_Loop(char l)
 {
+	static uint32_t lastCycle = 0;
+
 	do 
 	{
 		//measureExecute();
 		//endOfCycleExecute();
+		if(workCycles != lastCycle)																							// once per work cycle
+		{
+#if DCDC_FIXED_POINT
+			lastCycle = updateFloatValue();																			// only a new decimator output is copied
+#else
+			lastCycle = workCycles;
+#endif
+			if(statusFlags.PROTECT_UPDATE && (vInCodeScale != 0))
+			{
+				adcWatchdogs_t wd;
+				statusFlags.PROTECT_UPDATE = 0;
+				protectThresholds(&protectLimits, vInCodeScale * (1.0f / 4294967296.0f), vOutCodeScale * (1.0f / 4294967296.0f),
+													currAmpsPerCode(), &wd);
+				setAdcWindowWatchdogs(&wd);
+			}
+#if HRTIM_PEAK_CURRENT
+			pcmcUpdateScale();																								// follows the Vref correction of the current scale
+#elif HRTIM_CURR_LIMIT_EEV
+			setCurrLimitCode(currLimitDacCode(currLimitAmps));										// follows the Vref correction of the current scale
+#endif
+#if DCDC_AUTOTUNE
+			if(autoTuneState == AUTOTUNE_MEASURED)
+			{
+				float kp, ki;
+				if(autoTuneGains(DCDC_PID_VIN_SHIFT, &kp, &ki) == 0)
+				{
+					DCDC_setPidGains(DCDC_LOOP_VIN, kp, ki, 0.0f);
+					autoTuneKp = kp;
+					autoTuneKi = ki;
+					autoTuneNew = 1;
+				}
+			}
+#endif
+#if DCDC_DEAD_TIME_ESC
+			if(statusFlags.CONTROL_ENABLE && !statusFlags.BURST_MODE && !ivTraceActive() && !autoTuneActive() && !fraActive())
+			{
+				deadTimeUpdate(calculatedValue.vInSensor * calculatedValue.iInSensor,
+											 calculatedValue.vOutSensor * calculatedValue.iOutSensor, calculatedValue.iOutSensor);
+			}
+			else
+			{
+				deadTimeHold();
+			}
+#endif
+		}
 	}
 	while(l);
 	return 1;
@@ -316,53 +936,244 @@ int DCDC_Loop(char l)
 //		}
 //	return dutyCycle;	
 //}
+#if DCDC_REGULATOR == DCDC_REG_PI
+/*****************************************************************************************
+* arm_pid_q31 with a saturating add of y[n-1]: the current reference of HRTIM_PEAK_CURRENT
+* and DCDC_DEADBEAT has its limit at 0x7FFFFFFF, the back-calculation parks the state there
+******************************************************************************************/
+static __inline q31_t pidStepQ31(arm_pid_instance_q31* S, q31_t in)
+{
+	q63_t acc = (q63_t)S->A0 * in + (q63_t)S->A1 * S->state[0] + (q63_t)S->A2 * S->state[1];
+	q31_t out = __QADD((q31_t)(acc >> 31), S->state[2]);
+
+	S->state[1] = S->state[0];
+	S->state[0] = in;
+	S->state[2] = out;
+	return out;
+}
+
+/*****************************************************************************************
+* Min-select of the PI loops on pidStepQ31, errors in Q16 volts / amperes, positive
+* error asks for more duty. Returns the Q31 ratio: duty, or the peak current of the
+* limit with HRTIM_PEAK_CURRENT. A ratio needs no spread spectrum compensation.
+* Back-calculation: every loop's output state is set to the applied duty, so the loops
+* that lost the selection don't wind up and take over without a bump.
+* Feed-forward: the output states are moved by the change of the ideal duty before the
+* loops run, so the loops only integrate the correction.
+******************************************************************************************/
+static q31_t piRegulator(const int32_t* pError, q31_t ffStep)
+{
+	q31_t out = 0x7FFFFFFF;
+	uint8_t active = DCDC_LOOP_VIN;
+	uint16_t n;
+
+	if(statusFlags.PID_GAINS_UPDATE)
+	{
+		uint8_t mask = statusFlags.PID_GAINS_UPDATE;
+		statusFlags.PID_GAINS_UPDATE = 0;
+		for(n = 0; n < DCDC_LOOPS_NUM; n++)
+		{
+			if(!(mask & (1U << n))) { continue; }
+			pid[n].Kp = pidGainsNew[n][0];
+			pid[n].Ki = pidGainsNew[n][1];
+			pid[n].Kd = pidGainsNew[n][2];
+			arm_pid_init_q31(&pid[n], 0);																		// keep the state, bumpless
+		}
+	}
+
+	for(n = 0; n < DCDC_LOOPS_NUM; n++)
+	{
+		int32_t error = pError[n];
+		int32_t limit = PID_ERROR_LIMIT(pidErrorBase[n]);
+		q31_t proposal;
+
+		pid[n].state[2] = __QADD(pid[n].state[2], ffStep);
+
+		if(error > limit) { error = limit; }
+			else if(error < -limit) { error = -limit; }
+
+		proposal = pidStepQ31(&pid[n], error << PID_ERROR_SHIFT(pidErrorBase[n]));
+		if(proposal < out) { out = proposal; active = n; }
+	}
+
+	if(out >= PID_OUT_MAX_Q31) { out = PID_OUT_MAX_Q31; statusFlags.MAX_DUTY_LIMIT = 1; }
+		else if(out <= PID_OUT_MIN_Q31) { out = PID_OUT_MIN_Q31; statusFlags.MIN_DUTY_LIMIT = 1; }
+
+	for(n = 0; n < DCDC_LOOPS_NUM; n++)
+	{
+		pid[n].state[2] = out;																						// back-calculation
+	}
+	activeLoop = active;
+
+	return out;
+}
+#endif
+
+/*****************************************************************************************
+* Regulator takes over at duty (counts of BUCK_PERIOD, dutyQ31 the same as Q31 ratio)
+******************************************************************************************/
+static void regulatorReset(uint16_t duty, int32_t dutyQ31)
+{
+#if DCDC_REGULATOR == DCDC_REG_PI
+	uint16_t n = 0;
+	while(n < DCDC_LOOPS_NUM){
+		arm_pid_reset_q31(&pid[n]);
+		pid[n].state[2] = dutyQ31;
+		n++;
+	}
+#endif
+	dutyRef = duty;
+}
+
+#if DCDC_DEADBEAT
+/*****************************************************************************************
+* Deadbeat: the Q31 current reference of the loops to the duty of the next period,
+* counts of buckPeriod
+******************************************************************************************/
+static uint16_t deadbeatDutyCycle(q31_t ref, const deadbeatSample_t* pNow)
+{
+	int32_t duty = deadbeatStep(ref, pNow);
+
+	if(duty >= PID_DUTY_MAX_Q31) { duty = PID_DUTY_MAX_Q31; statusFlags.MAX_DUTY_LIMIT = 1; }
+		else if(duty <= PID_DUTY_MIN_Q31) { duty = PID_DUTY_MIN_Q31; statusFlags.MIN_DUTY_LIMIT = 1; }
+	return (uint16_t)(((uint64_t)duty * buckPeriod) >> 31);
+}
+#endif
+
 /*****************************************************************************************
 * Go to state with target Vin voltage.
 */////////////////////////////////////////////////////////////////////////////////////////
-uint16_t  Regulator(float Vin)// Regulator like PID
+uint16_t  Regulator(int32_t Vin)// Regulator like PID, Vin in Q16
 {
+	const volatile regAdcValue_t* pNow = &adcDmaBuf[adcSeq & 1];															// last complete sample
+	int32_t vInNow = (int32_t)(((uint64_t)pNow->vInSensor * vInCodeScale) >> FIXED_Q);					// Q16
+	int32_t vOutNow = (int32_t)(((uint64_t)pNow->vOutSensor * vOutCodeScale) >> FIXED_Q);
+	int32_t iOutNow = (int32_t)(((int64_t)((int32_t)pNow->iOutSensor - (int32_t)ZERO_CURR_CODE) * iOutCodeScale) >> FIXED_Q);
+	int32_t ffStep = 0;
+#if DCDC_REGULATOR == DCDC_REG_PI
+	int32_t error[DCDC_LOOPS_NUM];
+#endif
+#if DCDC_DEADBEAT
+	deadbeatSample_t dbNow;
+
+	dbNow.vIn = vInNow;
+	dbNow.vOut = vOutNow;
+	dbNow.iL = iOutNow;																												// the output sensor is in series with the inductor
+	dbNow.iLoad = fixedValue.iOutSensor;
+	dbNow.duty = recipRatioQ31(dutyCycle, buckPeriod);																// applied in the running period
+	dbNow.period = buckPeriod;
+#endif
 
 //	static workMode_ent workMode = MODE_VOLTAGE_STAB;
 //RDD Spread spectrum begin
 
-//	delta_duty = (PERIOD_STEP * 100) / (buckPeriod / (dutyCycle / 100));  //spectr
-	delta_duty = (buckPeriod *1000 / dutyCycle);  //koef-t spectr 
-	delta_duty = PERIOD_STEP*1000 / delta_duty  ;  //delta_duty spectr
-	
-	if(statusFlags.PERIOD_STEP_UP == 0)   //RDD Spread spectrum
-	{                               
-		buckPeriod -= PERIOD_STEP;                                       // PERIOD_STEP_UP only there 
-//		delta_duty = -100;              //spectr
-		delta_duty = -1*delta_duty;              //spectr
-		if(buckPeriod == BUCK_PERIOD_MIN) {statusFlags.PERIOD_STEP_UP = 1;}  //RD Replace to <= ?
-	} else 
-	{
-		buckPeriod += PERIOD_STEP;
-//		delta_duty = 100;              //spectr
-		if(buckPeriod == BUCK_PERIOD_MAX) {statusFlags.PERIOD_STEP_UP = 0;}
-	}
-
-	HRTIM1->sTimerxRegs[TIM_A].PERxR = buckPeriod;														// next period for timer
+	buckPeriod = spreadNextPeriod();
+	hrtimerUpdatePeriod(buckPeriod);																					// next period for timer, the phase shifts follow
+#if DCDC_DEADBEAT
+	dbNow.periodNext = buckPeriod;
+#endif
 
 //RDD Spread spectrum end	
 
-				delta = (Vin> calculatedValue.vInSensor) ?  - 10 : +10;
-//				if(delta > MAX_DUTY_STEP_POS){ delta = MAX_DUTY_STEP_POS;}
-//					else if (delta < MAX_DUTY_STEP_NEG){delta = MAX_DUTY_STEP_NEG;}
-//				dutyCycle = dutyCycle + delta;	
-				dutyCycle = dutyCycle + delta + delta_duty;	//spectr
-			
-
 	statusFlags.MIN_DUTY_LIMIT = 0;
 	statusFlags.MAX_DUTY_LIMIT = 0;
 
-	if( dutyCycle >= DUTY_MAX){
-		dutyCycle = DUTY_MAX;
-		statusFlags.MAX_DUTY_LIMIT = 1;
-	} else if (dutyCycle <= DUTY_MIN){
-			dutyCycle = DUTY_MIN;
-			statusFlags.MIN_DUTY_LIMIT = 1;		
+#if DCDC_FEED_FORWARD && !HRTIM_PEAK_CURRENT && !DCDC_DEADBEAT											// the current loop has no duty to feed
+	if(statusFlags.SCALES_VALID && (vInNow > vOutNow))																// else the ratio saturates at 1.0, no step, ffDuty is kept
+	{
+		int32_t ff = recipRatioQ31((uint32_t)vOutNow, (uint32_t)vInNow);										// ideal buck duty, Q31, vOutNow >= 0
+#if DCDC_REGULATOR == DCDC_REG_PI
+		ffStep = ff - ffDuty;
+#else
+		ffStep = (int32_t)(((int64_t)ff * BUCK_PERIOD) >> 31) - (int32_t)(((int64_t)ffDuty * BUCK_PERIOD) >> 31);	// counts
+#endif
+		ffDuty = ff;
+	}
+#endif
+
+#if DCDC_IV_TRACE
+	if(ivTraceActive())
+	{
+		if((iOutNow > iOutLimitQ) || (vOutNow > vOutLimitQ)) { ivTraceStop(IVTRACE_LIMIT); }
+			else { dutyRef = ivTraceStep(pNow->vInSensor, pNow->iInSensor); }
+#if HRTIM_PEAK_CURRENT
+		pcmcPeriod(PID_OUT_MAX_Q31);																						// the duty of the sweep ends the pulse
+#endif
+#if HRTIM_PEAK_CURRENT || DCDC_DEADBEAT
+		if(!ivTraceActive())																										// bumpless from the last current of the sweep
+		{
+			regulatorReset(dutyRef, recipRatioQ31((iOutNow > 0) ? iOutNow : 0, (uint32_t)(currLimitAmps * FIXED_ONE)));
 		}
+#else
+		if(!ivTraceActive()) { regulatorReset(dutyRef, recipRatioQ31(dutyRef, BUCK_PERIOD)); }	// bumpless from the last duty of the sweep
+#endif
+		return spreadScaleDuty(dutyRef);
+	}
+#endif
+
+#if DCDC_AUTOTUNE
+	if(autoTuneActive())
+	{
+		q31_t out;
+		if((iOutNow > iOutLimitQ) || (vOutNow > vOutLimitQ)) { autoTuneStop(AUTOTUNE_LIMIT); }
+		out = autoTuneStep(vInNow - Vin);
+		if(out > PID_OUT_MAX_Q31) { out = PID_OUT_MAX_Q31; }
+			else if(out < PID_OUT_MIN_Q31) { out = PID_OUT_MIN_Q31; }
+#if HRTIM_PEAK_CURRENT
+		pcmcPeriod(out);
+		dutyCycle = spreadScaleDuty(DUTY_MAX);
+#elif DCDC_DEADBEAT
+		dutyCycle = deadbeatDutyCycle(out, &dbNow);
+#else
+		dutyCycle = (uint16_t)(((uint64_t)out * buckPeriod) >> 31);
+#endif
+		if(!autoTuneActive()) { regulatorReset(dutyRef, out); }												// bumpless from the operating point
+		return dutyCycle;
+	}
+#endif
+
+#if DCDC_REGULATOR == DCDC_REG_PI
+				error[DCDC_LOOP_VIN] = vInNow - Vin;
+				error[DCDC_LOOP_IOUT] = iOutLimitQ - iOutNow;
+				error[DCDC_LOOP_VOUT] = vOutLimitQ - vOutNow;
+			{
+				q31_t out = piRegulator(error, ffStep);
+#if DCDC_FRA
+				if(fraActive())
+				{
+					if(activeLoop != DCDC_LOOP_VIN) { fraStop(FRA_LIMIT); }										// a limit loop took over
+						else { out = fraStep(vInNow, out, buckPeriod); }
+					if(out > PID_OUT_MAX_Q31) { out = PID_OUT_MAX_Q31; }
+						else if(out < PID_OUT_MIN_Q31) { out = PID_OUT_MIN_Q31; }
+				}
+#endif
+#if HRTIM_PEAK_CURRENT
+				pcmcPeriod(out);
+				dutyCycle = spreadScaleDuty(DUTY_MAX);																// the comparator ends the pulse before
+#elif DCDC_DEADBEAT
+				dutyCycle = deadbeatDutyCycle(out, &dbNow);
+#else
+				dutyCycle = (uint16_t)(((uint64_t)out * buckPeriod) >> 31);
+#endif
+			}
+#else
+				delta = (Vin> vInNow) ?  - 10 : +10;
+//				if(delta > MAX_DUTY_STEP_POS){ delta = MAX_DUTY_STEP_POS;}
+//					else if (delta < MAX_DUTY_STEP_NEG){delta = MAX_DUTY_STEP_NEG;}
+	{
+		int32_t ref = (int32_t)dutyRef + delta + ffStep;
+
+		if( ref >= DUTY_MAX){
+			ref = DUTY_MAX;
+			statusFlags.MAX_DUTY_LIMIT = 1;
+		} else if (ref <= DUTY_MIN){
+				ref = DUTY_MIN;
+				statusFlags.MIN_DUTY_LIMIT = 1;		
+			}
+		dutyRef = (uint16_t)ref;
+	}
+	dutyCycle = spreadScaleDuty(dutyRef);																				// same ratio for any period
+#endif
 	return dutyCycle;	
 };	
 /*****************************************************************************************
@@ -383,61 +1194,232 @@ uint16_t  Regulator(float Vin)// Regulator like PID
 //}
 
 
+/******************************************************************************************
+*  Copies the last complete DMA half to pDst, returns its sequence number.
+*  Sequence lock: the copy is repeated if the DMA interrupt published another half meanwhile.
+*******************************************************************************************/
+static uint32_t adcSnapshot(regAdcValue_t* pDst){
+	uint32_t seq;
+
+	do{
+		const volatile regAdcValue_t* pSrc;
+		uint16_t i = 0;
+		seq = adcSeq;
+		pSrc = &adcDmaBuf[seq & 1];
+		while(i < ADC_PAIRS_NUM){
+			pDst->pair[i] = pSrc->pair[i];
+			i++;
+		}
+	} while(seq != adcSeq);
+
+	return seq >> 1;
+}
+
 /******************************************************************************************
 * 
 *
 *******************************************************************************************/
 void measureExecute(void){
 
-	static uint16_t index = 0;
+	static uint8_t slowReady = 0;
+	static uint32_t lastSeq = 0;
+	uint32_t seq;
+	uint8_t ready;
 	
 	if (!statusFlags.ADC_CONVERS_COMPLIT){ return; }
 
 	statusFlags.ADC_CONVERS_COMPLIT = 0;
 
-	//updateSumValue((uint16_t*)&momentValue, pSumValueNow);
-{
-	uint16_t* pMomentVal=(uint16_t*)&momentValue;
-	uint32_t* pSumValue=pSumValueNow;
-	uint16_t i = 0; ;
-	while(i < ADC_STRUCT_MEMBERS_NUM){
-		*pSumValue += *pMomentVal;																							// add the new value to the sum	
-		pSumValue++;
-		pMomentVal++;
-		i++;
+	seq = adcSnapshot(&momentValue);
+	if(seq - lastSeq > 1){ adcLost += seq - lastSeq - 1; }
+	lastSeq = seq;
+
+	ready = decimUpdate(&momentValue, &decimValue);
+#if ADC_SLOW_ROUND_ROBIN
+	{
+		static uint32_t lastRound = 0;
+		uint32_t round = adcSlowRounds;
+		if(round != lastRound)																											// the rotation is stable for 2^ADC_SLOW_DIV_LOG2 sets
+		{
+			lastRound = round;
+			ready |= decimSlowUpdate(adcSlowPairs, &decimValue);
+		}
 	}
-}	
+#endif
+	if(ready & DECIM_SLOW_READY)
+	{
+		slowValue.vrefCpu = decimValue.vrefCpu >> DECIM_OUT_FRAC;
+		slowValue.v12Sensor = decimValue.v12Sensor >> DECIM_OUT_FRAC;
+		slowValue.tmpCmp = decimValue.tmpCmp >> DECIM_OUT_FRAC;
+		slowValue.iOutComSensor = decimValue.iOutComSensor >> DECIM_OUT_FRAC;
+		slowValue.vLeakRef = decimValue.vLeakRef >> DECIM_OUT_FRAC;
+		slowValue.vLeakCheck = decimValue.vLeakCheck >> DECIM_OUT_FRAC;
+		slowValue.tmpCase = decimValue.tmpCase >> DECIM_OUT_FRAC;
+		slowValue.vRefInt = decimValue.vRefInt >> DECIM_OUT_FRAC;
+	}
+	slowReady |= ready & DECIM_SLOW_READY;																				// vrefCpu is a slow channel
 	
 //	MEAS_update();
 
-	index++;
-	if (index == ADC_AVERAGE_NUMBER)   //#define ADC_AVERAGE_NUMBER		1
+	if ((ready & DECIM_FAST_READY) && slowReady)
 		{
-		uint32_t *ptrTmp = pSumValueNow;  //swap the buffers
-		pSumValueNow = pSumValueStored;
-		pSumValueStored = ptrTmp;
-		//updateAverageValue((float*)&averageValue, pSumValueStored);	
+#if !DCDC_FIXED_POINT  // fixed point: the outputs are scaled directly in endOfCycleExecute
       float* pAverageValue=(float*)&averageValue;
-  		uint32_t* pSumValue=pSumValueStored;		
+  		uint32_t* pSumValue=(uint32_t*)&decimValue;		
       uint16_t i = 0; 
     	while(i < ADC_STRUCT_MEMBERS_NUM)
 				{
 	  	   *pAverageValue = *pSumValue * 1.0f / ADC_SAMPLE_NUMBER ;								// calc average value
-		     *pSumValue = 0;																													// erase sum value
 	   	    pSumValue++;
 	  	    pAverageValue++;
 	  	    i++;
 	      }
+#endif
 
-		//
-		
-		index = 0;
 		statusFlags.WORK_CYCLE_END = 1;  // 
 
 	  }	
 
 }
 
+/******************************************************************************************
+*  Set control bits, stop/start HR timers
+*  A start stays pending until the first work cycle has set the code scales: the regulator
+*  would see Vin = Vout = 0 before.
+*  Is called from EXTI0, the PWM interrupt may preempt it
+*******************************************************************************************/
+static void controlStartStop(void){
+
+		if(statusFlags.CONTROL_STOP)
+			{
+			statusFlags.CONTROL_STOP = 0;
+			statusFlags.CONTROL_START = 0;
+			statusFlags.CONTROL_ENABLE = 0;
+			offset = 500;
+			hrtimersOutDisable();																		// burst mode ends too
+			statusFlags.BURST_MODE = 0;
+#if DCDC_IV_TRACE
+			if(ivTraceActive()) { ivTraceStop(IVTRACE_ABORT); }
+#endif
+#if DCDC_AUTOTUNE
+			if(autoTuneActive()) { autoTuneStop(AUTOTUNE_ABORT); }
+#endif
+#if DCDC_FRA
+			if(fraActive()) { fraStop(FRA_ABORT); }
+#endif
+		  }
+			else
+			{
+	      if(statusFlags.CONTROL_START && statusFlags.SCALES_VALID)							// the start waits for the first slow output
+					{
+		       statusFlags.CONTROL_START = 0;
+					 statusFlags.FAULT_DETECT = 0;
+					 faultCause = DCDC_FAULT_NONE;															// a fault still present trips again at the next conversion
+					 dutyCycle = hrtimersOutEnable(DUTY_MIN);
+#if ADC_INJECTED_FAST
+					 adcTrigNext = DUTY_MIN + ADC_OFFSET;																// CMP2 of the first period
+#endif
+					 ffDuty = PID_DUTY_MIN_Q31;																// first period steps from DUTY_MIN to Vout/Vin
+					 regulatorReset(DUTY_MIN, PID_OUT_MIN_Q31);
+	      	 statusFlags.CONTROL_ENABLE = 1;														// regulator state is ready for the PWM interrupt
+					}
+		  }
+}
+
+/******************************************************************************************
+*  Light load: burst mode below burstEnterQ of the filtered output current, every
+*  period again above burstExitQ or when the regulator needs the full duty.
+*  In burst mode the Vin loop runs a limit cycle over a few bursts and the current of
+*  one work cycle swings over both thresholds, the filter spans the limit cycle.
+*  Is called once per work cycle.
+*******************************************************************************************/
+static void lightLoadExecute(int32_t iOut){
+#if DCDC_LIGHT_LOAD
+	if(!statusFlags.CONTROL_ENABLE || ivTraceActive() || autoTuneActive() || fraActive())				// stop, trace, autotune and FRA end the burst themselves
+	{
+		burstIoutQ = burstExitQ;																							// a start switches every period, the current rises from 0
+		return;
+	}
+	burstIoutQ += (iOut - burstIoutQ) >> DCDC_BURST_FILTER_LOG2;
+	iOut = burstIoutQ;
+
+	if(statusFlags.BURST_MODE)
+	{
+		if((iOut > burstExitQ) || statusFlags.MAX_DUTY_LIMIT)
+		{
+			hrtimersBurstStop();
+			statusFlags.BURST_MODE = 0;
+		}
+	}
+	else if((iOut < burstEnterQ) && !statusFlags.MAX_DUTY_LIMIT)
+	{
+		hrtimersBurstStart();
+		statusFlags.BURST_MODE = 1;
+	}
+#endif
+}
+
+/******************************************************************************************
+*  Q16 scale of one decimator output: sum * (K * 2^32 / vrefSum) / 2^32
+*******************************************************************************************/
+static __inline uint32_t channelScale(uint32_t k, uint32_t vrefRecip){
+	return (uint32_t)(((uint64_t)k * vrefRecip) >> FIXED_Q);
+}
+
+/******************************************************************************************
+*  Q32 scales of one sample for the PWM interrupt, integer in both DCDC_FIXED_POINT
+*  variants: the duty of every period doesn't depend on the switch
+*******************************************************************************************/
+static void codeScalesUpdate(uint32_t vrefRecip){
+	vInCodeScale = channelScale(VIN_SCALE_Q, vrefRecip) * ADC_AVERAGE_NUMBER;
+	vOutCodeScale = channelScale(VOUT_SCALE_Q, vrefRecip) * ADC_AVERAGE_NUMBER;
+	iOutCodeScale = channelScale(I_SCALE_Q, vrefRecip) * ADC_AVERAGE_NUMBER;
+	statusFlags.SCALES_VALID = 1;
+}
+
+#if DCDC_FIXED_POINT
+static __inline int32_t scaleSum(uint32_t sum, uint32_t scale){
+	return (int32_t)(((uint64_t)sum * scale) >> FIXED_Q);
+}
+
+static __inline int32_t scaleCurrSum(uint32_t sum, uint32_t scale){
+	int32_t delta = (int32_t)sum - (int32_t)(ZERO_CURR_CODE * ADC_AVERAGE_NUMBER);
+	return (delta > 0) ? scaleSum((uint32_t)delta, scale) : 0;										//only positive value
+}
+
+/******************************************************************************************
+*  Calculated normalized value, Q16
+*  The decimator gain cancels against the vrefCpu output, one divide per work cycle
+*******************************************************************************************/
+void endOfCycleExecute(void){
+
+	if(!statusFlags.WORK_CYCLE_END) { return; } // no average value
+
+	wordAdcValue_t* pSumValue = &decimValue;
+
+	if(pSumValue->vrefCpu != 0)
+	{
+		uint32_t vrefRecip = 0xFFFFFFFFUL / pSumValue->vrefCpu;									// Q32 correction according extern ref
+		uint32_t currScale = channelScale(I_SCALE_Q, vrefRecip);
+
+		fixedValue.vInSensor = scaleSum(pSumValue->vInSensor, channelScale(VIN_SCALE_Q, vrefRecip));
+		fixedValue.vOutSensor = scaleSum(pSumValue->vOutSensor, channelScale(VOUT_SCALE_Q, vrefRecip));
+		fixedValue.iInSensor = scaleCurrSum(pSumValue->iInSensor, currScale);
+		fixedValue.iOutSensor = scaleCurrSum(pSumValue->iOutSensor, currScale);
+		fixedValue.iOutComSensor = scaleCurrSum(pSumValue->iOutComSensor, currScale);
+		fixedValue.v12Sensor = scaleSum(pSumValue->v12Sensor, channelScale(V12_SCALE_Q, vrefRecip)); //12V on the board
+		fixedValue.vrefCpu = (int32_t)(CPU_VREF_VALUE * FIXED_ONE);								//External Ref
+		codeScalesUpdate(vrefRecip);
+	}
+
+	averageCode = decimValue;																										// keep for DCDC_Loop
+	lightLoadExecute(fixedValue.iOutSensor);
+	workCycles++;
+
+	statusFlags.WORK_CYCLE_END = 0;
+
+}
+#else
 /******************************************************************************************
 *  Calculated normalized value
 *
@@ -468,30 +1450,14 @@ void endOfCycleExecute(void){
 
 	pCalcValue->v12Sensor = pAverageValue->v12Sensor * adcMultipler * V12_CONVERCE_COEFF; //12V on the board
 	pCalcValue->vrefCpu = pAverageValue->vrefCpu * adcMultipler;	//External Ref?
-	
-	
-  //set control bits, stop/start HR timers
-		
-		if(statusFlags.CONTROL_STOP)
-			{
-			statusFlags.CONTROL_STOP = 0;
-			statusFlags.CONTROL_START = 0;
-			statusFlags.CONTROL_ENABLE = 0;
-			offset = 500;
-			hrtimersOutDisable();
-		  }
-			else
-			{
-	      if(statusFlags.CONTROL_START)
-					{
-	      	 statusFlags.CONTROL_ENABLE = 1;
-		       statusFlags.CONTROL_START = 0;
-					 dutyCycle = hrtimersOutEnable(DUTY_MIN);
-					}
-		  }
+	if(decimValue.vrefCpu != 0) { codeScalesUpdate(0xFFFFFFFFUL / decimValue.vrefCpu); }			// for the PWM interrupt
+
 		       
 //	calculatedValue.tmpCase = getTemperatureValue((uint32_t)averageValue.tmpCase );
+	lightLoadExecute((int32_t)(pCalcValue->iOutSensor * FIXED_ONE));
+	workCycles++;
 	
 	statusFlags.WORK_CYCLE_END = 0;
 
 }
+#endif
@@ -0,0 +1,89 @@
+/*
+ * deadbeat.c
+ *
+ *  Created on: 17 OCT. 2026
+ *  Deadbeat inductor current control: the duty from the buck model
+ *
+ *  The regulator output is the inductor current reference as a ratio of the cycle-by-cycle
+ *  limit, like in peak current mode, and this model turns it into the duty. Over a period T
+ *  with the duty D the inductor current moves by (D * Vin - Vout) * T / L, the output
+ *  capacitor takes the current above the load: dVout = (iL - iLoad) * T / C.
+ *  The sample is the average of the running period, the value of its middle, and the duty
+ *  of the running period was written one period ago. So the sample is first carried half
+ *  a period to the end of the running period with that duty, then the duty of the next
+ *  period is the one that puts the current on the reference at its end:
+ *    i1 = i0 + (D0 * Vin - Vout) * T0 / 2L
+ *    v1 = Vout + (i0 - iLoad) * T0 / 2C
+ *    D1 = (v1 + (iRef - i1) * L / T1) / Vin
+ *  Carried a whole period the current of the period end moves by half the last step the
+ *  wrong way, a pole at -1. With the model exact the sample two periods after this one is
+ *  on the reference.
+ *  T0 and T1 follow the spread spectrum. Losses and the dead time are left to the
+ *  outer loops, they see them as a slow offset of the reference.
+ */
+
+#include "deadbeat.h"
+#include "recip.h"
+
+#define DEADBEAT_CURR_MAX				32767.0f																// A, Q16 in 32 bits
+
+typedef
+	struct{
+		uint32_t timeL;																									// T / L per HRTIM count, Q40 A/V
+		uint32_t timeC;																									// T / C per HRTIM count, Q40 V/A
+		int32_t inductance;																							// L / T at BUCK_PERIOD_MIN, Q16 V/A
+} deadbeatModel_t;
+
+static deadbeatModel_t dbModel;																					// of the PWM interrupt
+static deadbeatModel_t dbModelNew;																			// staged by the thread
+static volatile uint8_t dbModelUpdate;																	// 1 - dbModelNew is complete
+static int32_t dbRefScale;																							// Q16 A of the reference 1.0
+
+/******************************************************************************************
+*  Plant model, the reference scale is set apart, is called by the thread.
+*  The model is staged, the PWM interrupt takes it over at its next period.
+*******************************************************************************************/
+int deadbeatSetModel(float inductance, float capacitance){
+	float lOverT = inductance * DEADBEAT_HRTIM_CLK / BUCK_PERIOD_MIN;
+
+	if((inductance < DEADBEAT_MODEL_MIN) || (capacitance < DEADBEAT_MODEL_MIN)) { return -1; }
+	if(lOverT * 65536.0f >= 2147483648.0f) { return -1; }
+	dbModelUpdate = 0;																											// not taken over half written
+	__DMB();
+	dbModelNew.timeL = (uint32_t)(1099511627776.0f / (inductance * DEADBEAT_HRTIM_CLK));	// 2^40
+	dbModelNew.timeC = (uint32_t)(1099511627776.0f / (capacitance * DEADBEAT_HRTIM_CLK));
+	dbModelNew.inductance = (int32_t)(lOverT * 65536.0f);
+	__DMB();
+	dbModelUpdate = 1;
+	return 0;
+}
+
+void deadbeatSetScale(float amps){
+	if(amps > DEADBEAT_CURR_MAX) { amps = DEADBEAT_CURR_MAX; }
+	dbRefScale = (int32_t)(amps * 65536.0f);
+}
+
+/******************************************************************************************
+*  PWM interrupt: duty of the next period for the Q31 current reference
+*******************************************************************************************/
+int32_t deadbeatStep(int32_t refQ31, const deadbeatSample_t* pNow){
+	int32_t tOverL, tOverC, lOverT, iRef;
+	int32_t vL, i1, v1, vNeed;
+
+	if(dbModelUpdate)
+	{
+		dbModel = dbModelNew;
+		dbModelUpdate = 0;
+	}
+	tOverL = (int32_t)(((uint64_t)pNow->period * dbModel.timeL) >> 24);										// Q16 A/V
+	tOverC = (int32_t)(((uint64_t)pNow->period * dbModel.timeC) >> 24);										// Q16 V/A
+	lOverT = (int32_t)(((int64_t)dbModel.inductance * recipRatioQ31(BUCK_PERIOD_MIN, pNow->periodNext)) >> 31);
+	iRef = (int32_t)(((int64_t)refQ31 * dbRefScale) >> 31);
+
+	vL = (int32_t)(((int64_t)pNow->duty * pNow->vIn) >> 31) - pNow->vOut;
+	i1 = pNow->iL + (int32_t)(((int64_t)vL * tOverL) >> 17);														// half of T0
+	v1 = pNow->vOut + (int32_t)(((int64_t)(pNow->iL - pNow->iLoad) * tOverC) >> 17);
+	vNeed = v1 + (int32_t)(((int64_t)(iRef - i1) * lOverT) >> 16);
+
+	return recipRatioQ31((vNeed > 0) ? (uint32_t)vNeed : 0, (pNow->vIn > 0) ? (uint32_t)pNow->vIn : 0);
+}
@@ -0,0 +1,129 @@
+/*
+ * deadtime.c
+ *
+ *  Created on: 17 OCT. 2026
+ *  Dead time of the buck legs tuned for the best efficiency by extremum seeking
+ *
+ *  Efficiency Pout/Pin of every work cycle is averaged over DT_DWELL cycles with the
+ *  dead time DT_DITHER above the centre, then with it DT_DITHER below. The difference of
+ *  the two averages is the sign of the gradient, the centre moves DT_STEP that way.
+ *  Rising and falling dead time take turns. The centre is kept per output current bin,
+ *  the operating point of a bin finds its learned dead time again. A bin is left
+ *  DT_BIN_HYST past its edges. The centre stays DT_DITHER inside DT_MIN..DT_MAX, so the
+ *  dither never applies a dead time outside of it.
+ */
+
+#include "deadtime.h"
+
+typedef
+	enum {
+		DT_AXIS_RISE = 0,
+		DT_AXIS_FALL,
+		DT_AXIS_NUM
+	} dtAxis_ent;
+
+static uint16_t dtCentre[DT_BINS][DT_AXIS_NUM];
+static uint8_t dtBin;
+static uint8_t dtAxis;
+static uint8_t dtHalf;																											// 0 - centre + DT_DITHER, 1 - centre - DT_DITHER
+static uint16_t dtCycles;
+static float dtEffSum[2];
+static float dtEff;
+
+/******************************************************************************************
+*  Dead time of the current half of the dither cycle to the phase timers
+*******************************************************************************************/
+static void dtApply(void){
+	uint16_t dt[DT_AXIS_NUM];
+
+	dt[DT_AXIS_RISE] = dtCentre[dtBin][DT_AXIS_RISE];
+	dt[DT_AXIS_FALL] = dtCentre[dtBin][DT_AXIS_FALL];
+	dt[dtAxis] = (dtHalf == 0) ? dt[dtAxis] + DT_DITHER : dt[dtAxis] - DT_DITHER;
+	hrtimerSetDeadTime(dt[DT_AXIS_RISE], dt[DT_AXIS_FALL]);
+}
+
+static void dtRestart(void){
+	dtHalf = 0;
+	dtCycles = 0;
+	dtEffSum[0] = 0.0f;
+	dtEffSum[1] = 0.0f;
+	dtApply();
+}
+
+void deadTimeInit(void){
+	uint8_t n;
+
+	for(n = 0; n < DT_BINS; n++){
+		dtCentre[n][DT_AXIS_RISE] = DEAD_TIME_INIT;
+		dtCentre[n][DT_AXIS_FALL] = DEAD_TIME_INIT;
+	}
+	dtBin = 0;
+	dtAxis = DT_AXIS_RISE;
+	dtEff = 0.0f;
+	dtRestart();
+}
+
+void deadTimeHold(void){
+	hrtimerSetDeadTime(dtCentre[dtBin][DT_AXIS_RISE], dtCentre[dtBin][DT_AXIS_FALL]);
+	dtCycles = 0;
+}
+
+/******************************************************************************************
+*  Efficiency estimate and one step of the seeking loop
+*******************************************************************************************/
+void deadTimeUpdate(float pIn, float pOut, float iOut){
+	uint8_t bin;
+	float eff;
+
+	if(pIn < DT_PIN_MIN) { deadTimeHold(); return; }													// efficiency is noise at low power
+
+	eff = pOut / pIn;
+	dtEff += (eff - dtEff) * DT_EFF_ALPHA;
+
+	bin = (iOut > 0.0f) ? (uint8_t)(iOut * (1.0f / DT_BIN_WIDTH)) : 0;
+	if(bin >= DT_BINS) { bin = DT_BINS - 1; }
+	if((iOut > dtBin * DT_BIN_WIDTH - DT_BIN_HYST) && (iOut < (dtBin + 1) * DT_BIN_WIDTH + DT_BIN_HYST))
+	{
+		bin = dtBin;																														// the ripple at an edge doesn't restart the dither
+	}
+	if(bin != dtBin)
+	{
+		dtBin = bin;																														// centre of the old bin is kept as learned
+		dtRestart();
+		return;
+	}
+	if(dtCycles == 0) { dtRestart(); }																				// after a hold
+
+	dtCycles++;
+	if(dtCycles <= DT_SETTLE) { return; }
+	dtEffSum[dtHalf] += eff;
+	if(dtCycles < DT_SETTLE + DT_DWELL) { return; }
+
+	if(dtHalf == 0)
+	{
+		dtHalf = 1;
+		dtCycles = 1;																														// not 0, that is a hold
+		dtApply();
+		return;
+	}
+
+	{
+		float grad = (dtEffSum[0] - dtEffSum[1]) * (1.0f / DT_DWELL);						// above minus below the centre
+		uint16_t* pCentre = &dtCentre[dtBin][dtAxis];
+
+		if((grad > DT_GRAD_MIN) && (*pCentre + DT_STEP <= DT_MAX - DT_DITHER)) { *pCentre += DT_STEP; }
+			else if((grad < -DT_GRAD_MIN) && (*pCentre - DT_STEP >= DT_MIN + DT_DITHER)) { *pCentre -= DT_STEP; }
+	}
+	dtAxis = (dtAxis == DT_AXIS_RISE) ? DT_AXIS_FALL : DT_AXIS_RISE;
+	dtRestart();
+}
+
+float deadTimeEfficiency(void){
+	return dtEff;
+}
+
+void deadTimeGet(uint8_t bin, uint16_t* pRise, uint16_t* pFall){
+	if(bin >= DT_BINS) { bin = DT_BINS - 1; }
+	*pRise = dtCentre[bin][DT_AXIS_RISE];
+	*pFall = dtCentre[bin][DT_AXIS_FALL];
+}
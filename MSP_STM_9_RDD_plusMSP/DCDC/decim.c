@@ -0,0 +1,213 @@
+/*
+ * decim.c
+ *
+ *  Created on: 17 OCT. 2026
+ *  CIC / boxcar decimator for the dual ADC stream
+ *
+ *  One sample set per PWM period. The six DMA words are first summed over 2^PRESUM
+ *  samples as packed ADC1/ADC2 halfword pairs, one add per two channels. The pre-sum
+ *  feeds the integrators, combs run at the output rate of the group. The response is a
+ *  2^PRESUM boxcar followed by a CIC of ratio 2^(LOG2R - PRESUM), gain
+ *  2^(PRESUM + ORDER * (LOG2R - PRESUM)). The arithmetic is modulo 2^32, exact while
+ *  the gain keeps 12 bit codes inside 32 bit. Outputs are normalised to
+ *  code * 2^DECIM_OUT_FRAC, so the gain is removed with a shift only.
+ *
+ *  ADC_SLOW_ROUND_ROBIN: the sets carry the fast pairs only. The slow pairs arrive one
+ *  rotation at a time through decimSlowUpdate and are integrated without pre-sum, the
+ *  ratio of the group is counted in rotations.
+ */
+
+#include "decim.h"
+
+typedef
+	struct{
+		uint8_t first;																													// first channel of the group
+		uint8_t number;
+		uint8_t order;
+		uint8_t log2r;																													// ratio in input sets
+		uint8_t presum;																													// log2 of the pre-sum ahead of the integrators
+		uint16_t count;
+	} decimGroup_t;
+
+#define DECIM_GAIN_LOG2(presum, order, log2r)	((presum) + (order) * ((log2r) - (presum)))
+#define DECIM_SLOW_IN_LOG2R		(DECIM_SLOW_LOG2R - DECIM_SLOW_INPUT_LOG2)
+
+#if ADC_SLOW_ROUND_ROBIN
+#define DECIM_SET_PAIRS				ADC_FAST_PAIRS
+#else
+#define DECIM_SET_PAIRS				ADC_PAIRS_NUM
+#endif
+
+/*  two halfword lanes added as one word: no carry crosses from the ADC1 lane while the
+    lane sum stays below 2^16, so a plain ADD does the same as UADD16 */
+#if defined(__ARM_FEATURE_DSP) || defined(ARM_MATH_CM4)
+	#define DECIM_ADD16(acc, x)		__UADD16((acc), (x))
+#else
+	#define DECIM_ADD16(acc, x)		((acc) + (x))
+#endif
+
+typedef char decimCheckPresum_t[(DECIM_PRESUM_LOG2 <= 4 && DECIM_PRESUM_LOG2 <= DECIM_FAST_LOG2R &&
+																 DECIM_PRESUM_LOG2 <= DECIM_SLOW_LOG2R) ? 1 : -1];
+typedef char decimCheckFast_t[(DECIM_FAST_ORDER >= 1 && DECIM_FAST_ORDER <= DECIM_MAX_ORDER &&
+															 DECIM_GAIN_LOG2(DECIM_PRESUM_LOG2, DECIM_FAST_ORDER, DECIM_FAST_LOG2R) <= 20) ? 1 : -1];
+typedef char decimCheckSlow_t[(DECIM_SLOW_ORDER >= 1 && DECIM_SLOW_ORDER <= DECIM_MAX_ORDER &&
+															 DECIM_SLOW_IN_LOG2R >= DECIM_SLOW_PRESUM_LOG2 &&
+															 DECIM_GAIN_LOG2(DECIM_SLOW_PRESUM_LOG2, DECIM_SLOW_ORDER, DECIM_SLOW_IN_LOG2R) <= 20) ? 1 : -1];
+typedef char decimCheckPairs_t[(DECIM_FAST_CHANNELS == 2 * ADC_FAST_PAIRS) ? 1 : -1];
+
+static decimGroup_t groupFast = { 0, DECIM_FAST_CHANNELS, DECIM_FAST_ORDER, DECIM_FAST_LOG2R, DECIM_PRESUM_LOG2, 0 };
+static decimGroup_t groupSlow = { DECIM_FAST_CHANNELS, DECIM_SLOW_CHANNELS, DECIM_SLOW_ORDER, DECIM_SLOW_IN_LOG2R,
+																	DECIM_SLOW_PRESUM_LOG2, 0 };
+
+static uint32_t integ[ADC_STRUCT_MEMBERS_NUM][DECIM_MAX_ORDER];
+static uint32_t comb[ADC_STRUCT_MEMBERS_NUM][DECIM_MAX_ORDER];
+static uint32_t presum[ADC_PAIRS_NUM];
+static uint16_t presumCount;
+
+/******************************************************************************************
+*
+*
+*******************************************************************************************/
+void decimInit(void){
+	uint16_t ch = 0;
+
+	while(ch < ADC_STRUCT_MEMBERS_NUM){
+		uint16_t k = 0;
+		while(k < DECIM_MAX_ORDER){
+			integ[ch][k] = 0;
+			comb[ch][k] = 0;
+			k++;
+		}
+		ch++;
+	}
+	ch = 0;
+	while(ch < ADC_PAIRS_NUM){
+		presum[ch] = 0;
+		ch++;
+	}
+	presumCount = 0;
+	groupFast.count = 0;
+	groupSlow.count = 0;
+}
+
+/******************************************************************************************
+*  Integrators of one group, every 2^presum input sets
+*******************************************************************************************/
+static void decimIntegrate(const decimGroup_t* pGroup, const uint32_t* pSample){
+	uint16_t ch = pGroup->first;
+	uint16_t last = pGroup->first + pGroup->number;
+
+	while(ch < last){
+		uint32_t* pInteg = integ[ch];
+		uint32_t x = pSample[ch];
+		uint16_t k = 0;
+		while(k < pGroup->order){
+			pInteg[k] += x;
+			x = pInteg[k];
+			k++;
+		}
+		ch++;
+	}
+}
+
+/******************************************************************************************
+*  Combs of one group, every 2^log2r samples
+*******************************************************************************************/
+static void decimComb(const decimGroup_t* pGroup, uint32_t* pOut){
+	uint16_t ch = pGroup->first;
+	uint16_t last = pGroup->first + pGroup->number;
+	int16_t shift = DECIM_GAIN_LOG2(pGroup->presum, pGroup->order, pGroup->log2r) - DECIM_OUT_FRAC;
+
+	while(ch < last){
+		uint32_t* pComb = comb[ch];
+		uint32_t y = integ[ch][pGroup->order - 1];
+		uint16_t k = 0;
+		while(k < pGroup->order){
+			uint32_t x = y;
+			y = x - pComb[k];
+			pComb[k] = x;
+			k++;
+		}
+		pOut[ch] = (shift >= 0) ? (y >> shift) : (y << -shift);
+		ch++;
+	}
+}
+
+/******************************************************************************************
+*  Feeds one sample set, returns DECIM_FAST_READY / DECIM_SLOW_READY when the group
+*  output in pOut was updated. The other group keeps its last output.
+*******************************************************************************************/
+uint8_t decimUpdate(const volatile regAdcValue_t* pSample, wordAdcValue_t* pOut){
+	uint8_t ready = 0;
+	uint32_t sum[ADC_STRUCT_MEMBERS_NUM];
+
+	presum[0] = DECIM_ADD16(presum[0], pSample->pair[0]);
+	presum[1] = DECIM_ADD16(presum[1], pSample->pair[1]);
+#if !ADC_SLOW_ROUND_ROBIN
+	presum[2] = DECIM_ADD16(presum[2], pSample->pair[2]);
+	presum[3] = DECIM_ADD16(presum[3], pSample->pair[3]);
+	presum[4] = DECIM_ADD16(presum[4], pSample->pair[4]);
+	presum[5] = DECIM_ADD16(presum[5], pSample->pair[5]);
+#endif
+
+	if(++presumCount < (1U << DECIM_PRESUM_LOG2)) return 0;
+	presumCount = 0;
+
+	{
+		uint16_t p = 0;
+		while(p < DECIM_SET_PAIRS){																							// unpack lanes in field order
+			sum[2 * p] = presum[p] & 0xFFFF;
+			sum[2 * p + 1] = presum[p] >> 16;
+			presum[p] = 0;
+			p++;
+		}
+	}
+
+	decimIntegrate(&groupFast, sum);
+#if !ADC_SLOW_ROUND_ROBIN
+	decimIntegrate(&groupSlow, sum);
+#endif
+
+	if(++groupFast.count >= (1U << (groupFast.log2r - groupFast.presum))){
+		groupFast.count = 0;
+		decimComb(&groupFast, (uint32_t*)pOut);
+		ready |= DECIM_FAST_READY;
+	}
+
+#if !ADC_SLOW_ROUND_ROBIN
+	if(++groupSlow.count >= (1U << (groupSlow.log2r - groupSlow.presum))){
+		groupSlow.count = 0;
+		decimComb(&groupSlow, (uint32_t*)pOut);
+		ready |= DECIM_SLOW_READY;
+	}
+#endif
+
+	return ready;
+}
+
+#if ADC_SLOW_ROUND_ROBIN
+/******************************************************************************************
+*  Feeds one rotation of the slow pairs, returns DECIM_SLOW_READY when the slow
+*  outputs in pOut were updated
+*******************************************************************************************/
+uint8_t decimSlowUpdate(const volatile uint32_t* pSlowPairs, wordAdcValue_t* pOut){
+	uint32_t sum[ADC_STRUCT_MEMBERS_NUM];
+	uint16_t p = 0;
+
+	while(p < ADC_SLOW_PAIRS){
+		uint32_t w = pSlowPairs[p];
+		sum[DECIM_FAST_CHANNELS + 2 * p] = w & 0xFFFF;
+		sum[DECIM_FAST_CHANNELS + 2 * p + 1] = w >> 16;
+		p++;
+	}
+
+	decimIntegrate(&groupSlow, sum);
+
+	if(++groupSlow.count >= (1U << (groupSlow.log2r - groupSlow.presum))){
+		groupSlow.count = 0;
+		decimComb(&groupSlow, (uint32_t*)pOut);
+		return DECIM_SLOW_READY;
+	}
+	return 0;
+}
+#endif
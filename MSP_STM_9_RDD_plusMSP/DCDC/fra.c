@@ -0,0 +1,198 @@
+/*
+ * fra.c
+ *
+ *  Created on: 17 OCT. 2026
+ *  Frequency response of the Vin loop, sine injection into the regulator output
+ *
+ *  While a point runs the PWM interrupt adds d = A * sin(wk) to the output of the PI
+ *  loops, the loop state keeps the output u without it, the power stage gets x = u + d.
+ *  Vin and u of every period are correlated with the cosine and the sine of the same
+ *  phase, a single DFT bin locked to the injection: 4 MACs per period, no window, the
+ *  sums run over whole cycles after FRA_SETTLE_CYCLES. The bin of the injection itself
+ *  is known, D = -j * A * N / 2, so the thread gets per point
+ *    plant  G = Vin / X      V per unit of the regulator output
+ *    loop   T = -U / X       crossover at |T| = 0 dB, phase margin 180 deg + arg T
+ *  with X = U + D. The phase steps per PWM period: with spread spectrum the real
+ *  frequency of a point is taken from the HRTIM counts of its periods.
+ */
+
+#include "fra.h"
+#include <math.h>
+
+#define FRA_PI									3.14159265f
+#define FRA_STEP_PER_HZ					(uint32_t)(0x100000000ULL / BUCK_CLK)					// phase step of 1 Hz at BUCK_CLK
+#define FRA_HRTIM_CLK						(72000000.0f * 16)													// HRTIM counts per second
+
+typedef char fraStepCheck_t[((uint64_t)FRA_FREQ_MAX * FRA_STEP_PER_HZ <= 0xFFFFFFFFUL) ? 1 : -1];
+
+volatile uint8_t fraState = FRA_IDLE;
+
+static int16_t fraSine[FRA_SINE_SIZE];
+static fraPoint_t fraBuf[FRA_POINTS_MAX];
+static const uint16_t* fraFreq;																					// Hz of the points
+static uint16_t fraPoints;
+static volatile uint16_t fraPoint;																			// points done
+static int32_t fraAmp;																									// Q31 injection amplitude
+static uint32_t fraPhase;
+static uint32_t fraPhaseStep;
+static uint16_t fraCycles;																							// phase wraps of the running point
+static uint8_t fraMeasure;																							// 0 - settling
+static int32_t fraVin0;																									// first measured sample, Q16 V
+static int32_t fraOut0;																									// Q31
+
+/******************************************************************************************
+*  Sine table, once at DCDC_Init
+*******************************************************************************************/
+void fraInit(void){
+	uint16_t k;
+
+	for(k = 0; k < FRA_SINE_SIZE; k++){
+		fraSine[k] = (int16_t)(32767.0f * sinf(2.0f * FRA_PI * k / FRA_SINE_SIZE));
+	}
+}
+
+static void fraPointStart(uint16_t n){
+	fraPhaseStep = fraFreq[n] * FRA_STEP_PER_HZ;
+	fraPhase = 0;
+	fraCycles = 0;
+	fraMeasure = 0;
+}
+
+/******************************************************************************************
+*  Arm a new response, the PWM interrupt starts the injection at its next period.
+*  pFreq stays in use until the end.
+*******************************************************************************************/
+void fraStart(const uint16_t* pFreq, uint16_t points, int32_t ampQ31){
+	uint16_t n;
+
+	fraState = FRA_IDLE;																									// buffer is not read by the interrupt
+	if(points > FRA_POINTS_MAX) { points = FRA_POINTS_MAX; }
+	for(n = 0; n < points; n++){
+		fraBuf[n].vInCos = 0;
+		fraBuf[n].vInSin = 0;
+		fraBuf[n].outCos = 0;
+		fraBuf[n].outSin = 0;
+		fraBuf[n].periodSum = 0;
+		fraBuf[n].periods = 0;
+		fraBuf[n].cycles = 0;
+	}
+	fraFreq = pFreq;
+	fraPoints = points;
+	fraPoint = 0;
+	fraAmp = ampQ31;
+	fraPointStart(0);
+	fraState = FRA_RUNNING;
+}
+
+/******************************************************************************************
+*  PWM interrupt: Vin of the last sample, output of the PI loops and the HRTIM period
+*  of the next period; returns the output with the injection, not limited
+*******************************************************************************************/
+int32_t fraStep(int32_t vInQ, int32_t outQ31, uint16_t period){
+	fraPoint_t* pPoint = &fraBuf[fraPoint];
+	uint32_t phase = fraPhase;
+	uint32_t k;
+	int32_t s, c;
+
+	if(fraState != FRA_RUNNING) { return outQ31; }
+
+	k = phase >> (32 - FRA_SINE_LOG2);
+	s = fraSine[k];
+	c = fraSine[(k + FRA_SINE_SIZE / 4) & (FRA_SINE_SIZE - 1)];
+
+	if(fraMeasure)
+	{
+		int32_t v, u;
+		if(pPoint->periods >= FRA_MAX_PERIODS)															// no whole cycle, the point is lost
+		{
+			fraStop(FRA_LIMIT);
+			return outQ31;
+		}
+		if(pPoint->periods == 0)																							// the offsets keep the sums small
+		{
+			fraVin0 = vInQ;
+			fraOut0 = outQ31;
+		}
+		v = vInQ - fraVin0;
+		u = (outQ31 - fraOut0) >> 16;																				// Q15
+		pPoint->vInCos += (int64_t)v * c;
+		pPoint->vInSin += (int64_t)v * s;
+		pPoint->outCos += (int64_t)u * c;
+		pPoint->outSin += (int64_t)u * s;
+		pPoint->periodSum += period;
+		pPoint->periods++;
+	}
+
+	fraPhase = phase + fraPhaseStep;
+	if(fraPhase < phase)																										// the sample of this period ends a cycle
+	{
+		fraCycles++;
+		if(!fraMeasure)
+		{
+			if(fraCycles >= FRA_SETTLE_CYCLES)
+			{
+				fraMeasure = 1;
+				fraCycles = 0;
+			}
+		}
+		else if((fraCycles >= FRA_CYCLES) && (pPoint->periods >= FRA_MIN_PERIODS))
+		{
+			pPoint->cycles = fraCycles;
+			if(fraPoint + 1 >= fraPoints)
+			{
+				fraPoint = fraPoints;
+				fraState = FRA_DONE;
+				return outQ31;
+			}
+			fraPoint++;
+			fraPointStart(fraPoint);
+		}
+	}
+
+	return outQ31 + (int32_t)(((int64_t)fraAmp * s) >> 15);
+}
+
+void fraStop(fraState_ent state){
+	fraState = state;
+}
+
+/******************************************************************************************
+*  Points measured, the whole sweep once it is over
+*******************************************************************************************/
+uint16_t fraGetPointsNum(void){
+	if(fraState == FRA_IDLE) { return 0; }
+	return fraPoint;
+}
+
+/******************************************************************************************
+*  Hz, dB and degrees of the plant G and of the loop T of a measured point
+*******************************************************************************************/
+int fraGetPoint(uint16_t n, float* pFreq, float* pPlantDb, float* pPlantDeg, float* pLoopDb, float* pLoopDeg){
+	const fraPoint_t* pPoint;
+	float vRe, vIm, uRe, uIm, xRe, xIm, x2, re, im;
+
+	if(n >= fraGetPointsNum()) { return -1; }
+	pPoint = &fraBuf[n];
+
+	vRe = (float)pPoint->vInCos * (1.0f / 2147483648.0f);										// Q16 * Q15
+	vIm = -(float)pPoint->vInSin * (1.0f / 2147483648.0f);
+	uRe = (float)pPoint->outCos * (1.0f / 1073741824.0f);										// Q15 * Q15
+	uIm = -(float)pPoint->outSin * (1.0f / 1073741824.0f);
+	xRe = uRe;
+	xIm = uIm - (float)fraAmp * (0.5f / 2147483648.0f) * pPoint->periods;
+	x2 = xRe * xRe + xIm * xIm;
+	if((x2 == 0.0f) || (pPoint->periodSum == 0)) { return -1; }
+
+	*pFreq = (float)pPoint->cycles * FRA_HRTIM_CLK / (float)pPoint->periodSum;
+
+	re = (vRe * xRe + vIm * xIm) / x2;																		// G = V / X
+	im = (vIm * xRe - vRe * xIm) / x2;
+	*pPlantDb = 10.0f * log10f(re * re + im * im + 1e-20f);
+	*pPlantDeg = atan2f(im, re) * (180.0f / FRA_PI);
+
+	re = -(uRe * xRe + uIm * xIm) / x2;																		// T = -U / X
+	im = -(uIm * xRe - uRe * xIm) / x2;
+	*pLoopDb = 10.0f * log10f(re * re + im * im + 1e-20f);
+	*pLoopDeg = atan2f(im, re) * (180.0f / FRA_PI);
+	return 0;
+}
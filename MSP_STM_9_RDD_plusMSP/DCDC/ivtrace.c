@@ -0,0 +1,112 @@
+/*
+ * ivtrace.c
+ *
+ *  Created on: 17 OCT. 2026
+ *  PV I-V curve trace by a duty sweep DUTY_MAX..DUTY_MIN
+ *
+ *  While the trace runs the PWM interrupt bypasses the regulator: the duty first moves
+ *  from the operating point to DUTY_MAX at the rate of the sweep, then ramps down
+ *  linearly over up to IVTRACE_PERIODS periods and the Vin / Iin codes of every period
+ *  are summed into IVTRACE_POINTS points of a static buffer. The sample of a period was
+ *  converted with the duty of the period before, so summing starts one period late.
+ *  The sweep goes from the short circuit side to the open circuit and ends at the first
+ *  point without string current: below the duty of Vout / Voc the synchronous buck would
+ *  boost the battery back into the input capacitor.
+ *  The codes are converted with the Q32 scales latched at the start, the slow path
+ *  does not have to keep up with the sweep.
+ */
+
+#include "ivtrace.h"
+#include "adc.h"
+
+#define IVTRACE_DUTY_SPAN			((uint32_t)(DUTY_MAX - DUTY_MIN))
+#define IVTRACE_SUM_SCALE			(1.0f / 68719476736.0f)											// 2^-32 of the scale, 2^-4 of the sum
+#define IVTRACE_APPROACH_STEP	((IVTRACE_DUTY_SPAN >> (IVTRACE_POINTS_LOG2 + IVTRACE_AVERAGE_LOG2)) + 1)	// counts per period to DUTY_MAX
+#define IVTRACE_OPEN_SUM			((ZERO_CURR_CODE + IVTRACE_OPEN_CODES) << IVTRACE_AVERAGE_LOG2)	// Iin sum of a point at open circuit
+
+typedef char ivTraceSpanCheck_t[(IVTRACE_DUTY_SPAN <= 0xFFFFFFFFUL / IVTRACE_PERIODS) ? 1 : -1];		// no overflow of the ramp
+typedef char ivTraceScaleCheck_t[(IVTRACE_AVERAGE_LOG2 == 4) ? 1 : -1];					// IVTRACE_SUM_SCALE
+
+volatile uint8_t ivTraceState = IVTRACE_IDLE;
+
+static ivTracePoint_t ivTraceBuf[IVTRACE_POINTS];
+static volatile uint16_t ivTracePeriod;																	// periods of the sweep done
+static uint16_t ivTraceDuty;																						// duty of the approach to DUTY_MAX, counts
+static uint32_t ivTraceVinScale;																				// volts per code, Q32
+static uint32_t ivTraceIinScale;																				// amperes per code above ZERO_CURR_CODE, Q32
+
+/******************************************************************************************
+*  Arm a new trace, the PWM interrupt starts the sweep at its next period
+*******************************************************************************************/
+void ivTraceStart(uint32_t vScale, uint32_t iScale, uint16_t dutyNow){
+	uint16_t n = 0;
+
+	ivTraceState = IVTRACE_IDLE;																					// buffer is not read by the interrupt
+	while(n < IVTRACE_POINTS){
+		ivTraceBuf[n].vInSum = 0;
+		ivTraceBuf[n].iInSum = 0;
+		n++;
+	}
+	ivTraceVinScale = vScale;
+	ivTraceIinScale = iScale;
+	ivTracePeriod = 0;
+	ivTraceDuty = dutyNow;
+	ivTraceState = IVTRACE_RUNNING;
+}
+
+/******************************************************************************************
+*  PWM interrupt: add the last sample, return the duty of the next period
+*******************************************************************************************/
+uint16_t ivTraceStep(uint16_t vInCode, uint16_t iInCode){
+	uint32_t period = ivTracePeriod;
+
+	if(ivTraceDuty < DUTY_MAX)																							// approach, nothing summed
+	{
+		ivTraceDuty = (ivTraceDuty + IVTRACE_APPROACH_STEP < DUTY_MAX) ? (uint16_t)(ivTraceDuty + IVTRACE_APPROACH_STEP) : DUTY_MAX;
+		return ivTraceDuty;
+	}
+	ivTracePeriod = (uint16_t)(period + 1);
+	if(period != 0)
+	{
+		ivTracePoint_t* pPoint = &ivTraceBuf[(period - 1) >> IVTRACE_AVERAGE_LOG2];
+		pPoint->vInSum += vInCode;
+		pPoint->iInSum += iInCode;
+		if(((period & ((1U << IVTRACE_AVERAGE_LOG2) - 1)) == 0) && (pPoint->iInSum <= IVTRACE_OPEN_SUM))
+		{
+			ivTraceState = IVTRACE_DONE;																					// open circuit, the last point
+			return (uint16_t)(DUTY_MAX - ((IVTRACE_DUTY_SPAN * (period - 1)) >> (IVTRACE_POINTS_LOG2 + IVTRACE_AVERAGE_LOG2)));
+		}
+	}
+	if(period >= IVTRACE_PERIODS)
+	{
+		ivTraceState = IVTRACE_DONE;
+		return DUTY_MIN;
+	}
+
+	return (uint16_t)(DUTY_MAX - ((IVTRACE_DUTY_SPAN * period) >> (IVTRACE_POINTS_LOG2 + IVTRACE_AVERAGE_LOG2)));
+}
+
+void ivTraceStop(ivTraceState_ent state){
+	ivTraceState = state;
+}
+
+/******************************************************************************************
+*  Points with all their samples, the whole curve once the trace is over
+*******************************************************************************************/
+uint16_t ivTraceGetPointsNum(void){
+	uint16_t period = ivTracePeriod;
+
+	if(ivTraceState == IVTRACE_IDLE) { return 0; }
+	return (period != 0) ? (uint16_t)((period - 1) >> IVTRACE_AVERAGE_LOG2) : 0;
+}
+
+int ivTraceGetPoint(uint16_t n, float* pVin, float* pIin){
+	int32_t iDelta;
+
+	if(n >= ivTraceGetPointsNum()) { return -1; }
+
+	iDelta = (int32_t)ivTraceBuf[n].iInSum - (int32_t)(ZERO_CURR_CODE << IVTRACE_AVERAGE_LOG2);
+	*pVin = (float)ivTraceBuf[n].vInSum * (float)ivTraceVinScale * IVTRACE_SUM_SCALE;
+	*pIin = (iDelta > 0) ? (float)iDelta * (float)ivTraceIinScale * IVTRACE_SUM_SCALE : 0.0f;	//only positive value
+	return 0;
+}
@@ -0,0 +1,71 @@
+/*
+ * pcmc.c
+ *
+ *  Created on: 17 OCT. 2026
+ *  Peak current mode: current reference with slope compensation on DAC2
+ *
+ *  The regulator output is the peak inductor current as a ratio of the cycle-by-cycle
+ *  limit. COMP2 compares the current sensor with DAC2 and ends the pulse through EEV1,
+ *  CMP1 only caps the duty at DUTY_MAX. The F334 DAC has no sawtooth generator, so the
+ *  compensation ramp is a staircase: HRTIM Timer E steps every PCMC_RAMP_STEP counts
+ *  from the end of the blanking and its DMA request moves the next code of a table to
+ *  DAC2. The table of the next period is built while the current one is played, the
+ *  reference has the same one period delay as CMP1 in voltage mode.
+ *
+ *  Subharmonic stability: with the up slope m1 = (Vin - Vout) / L, the down slope
+ *  m2 = Vout / L and the ramp ma the loop is stable for ma > (m2 - m1) / 2, i.e.
+ *  ma > Vin * (2D - 1) / 2L; ma = m2 / 2 covers any duty up to DUTY_MAX.
+ */
+
+#include "pcmc.h"
+#include "comp.h"
+#include "adc.h"
+
+static uint16_t pcmcRamp[2][PCMC_RAMP_STEPS];															// DAC codes of one period
+static uint8_t pcmcNext;																										// table for the next period
+static uint16_t pcmcLimitCode;																							// reference 1.0
+static uint16_t pcmcSlopeCodes;																						// ramp per step
+
+/******************************************************************************************
+*  Both tables start at zero current, the first pulses end after the blanking
+*******************************************************************************************/
+void pcmcInit(uint16_t limitCode){
+	uint16_t k;
+
+	pcmcLimitCode = limitCode;
+	pcmcSlopeCodes = 0;
+	pcmcNext = 0;
+	for(k = 0; k < PCMC_RAMP_STEPS; k++){
+		pcmcRamp[0][k] = ZERO_CURR_CODE;
+		pcmcRamp[1][k] = ZERO_CURR_CODE;
+	}
+	initSlopeCompensation();
+}
+
+/******************************************************************************************
+*  Is called once per work cycle, the Vref correction moves the codes
+*******************************************************************************************/
+void pcmcSetScale(uint16_t limitCode, uint16_t slopeCodes){
+	pcmcLimitCode = limitCode;
+	pcmcSlopeCodes = slopeCodes;
+}
+
+/******************************************************************************************
+*  PWM interrupt: play the table built in the last period, build the next one
+*******************************************************************************************/
+void pcmcPeriod(int32_t refQ31){
+	uint16_t* pRamp;
+	int32_t code;
+	uint16_t k;
+
+	slopeRampStart(pcmcRamp[pcmcNext], PCMC_RAMP_STEPS);
+	pcmcNext ^= 1;
+	pRamp = pcmcRamp[pcmcNext];
+
+	if(refQ31 < 0) { refQ31 = 0; }
+	code = ZERO_CURR_CODE + (int32_t)(((int64_t)refQ31 * (pcmcLimitCode - ZERO_CURR_CODE)) >> 31);
+	for(k = 0; k < PCMC_RAMP_STEPS; k++){
+		pRamp[k] = (code > 0) ? (uint16_t)code : 0;
+		code -= pcmcSlopeCodes;
+	}
+}
@@ -0,0 +1,72 @@
+/*
+ * phase.c
+ *
+ *  Created on: 17 OCT. 2026
+ *  Duty trim and current balancing of the interleaved buck phases
+ *
+ *  Every phase gets the common duty of the regulator plus hrtimPhaseTrim. The trim is
+ *  the manual offset of the phase plus an integral term that moves duty from the
+ *  phases above the mean current to the ones below it. The integral terms sum to zero,
+ *  so the mean duty and the gain of the regulator loops don't change.
+ *  phaseBalance is called once per work cycle by the code that samples the phase
+ *  currents; the ADC sequence of this board has no per-phase channels.
+ */
+
+#include "phase.h"
+
+#define PHASE_INTEGRAL_MAX		((int32_t)PHASE_TRIM_MAX << 16)
+
+static int16_t phaseManual[HRTIM_PHASES];
+static int32_t phaseIntegral[HRTIM_PHASES];																	// Q16 counts
+
+/******************************************************************************************
+*  Sum of the manual and balancing trims, limited to PHASE_TRIM_MAX
+*******************************************************************************************/
+static void phaseApply(void){
+	uint16_t k;
+
+	for(k = 0; k < HRTIM_PHASES; k++){
+		int32_t trim = phaseManual[k] + (phaseIntegral[k] >> 16);
+		if(trim > PHASE_TRIM_MAX) { trim = PHASE_TRIM_MAX; }
+			else if(trim < -PHASE_TRIM_MAX) { trim = -PHASE_TRIM_MAX; }
+		hrtimPhaseTrim[k] = (int16_t)trim;																			// one halfword, the PWM interrupt reads it at once
+	}
+}
+
+void phaseInit(void){
+	uint16_t k;
+
+	for(k = 0; k < HRTIM_PHASES; k++){
+		phaseManual[k] = 0;
+		phaseIntegral[k] = 0;
+	}
+	phaseApply();
+}
+
+int phaseSetTrim(uint8_t phase, int16_t counts){
+	if((phase >= HRTIM_PHASES) || (counts > PHASE_TRIM_MAX) || (counts < -PHASE_TRIM_MAX)) { return -1; }
+	phaseManual[phase] = counts;
+	phaseApply();
+	return 0;
+}
+
+/******************************************************************************************
+*  Integral balancing: duty is moved towards the phases below the mean current
+*******************************************************************************************/
+void phaseBalance(const int32_t* pCurr){
+	int32_t mean = 0;
+	uint16_t k;
+
+	for(k = 0; k < HRTIM_PHASES; k++){
+		mean += pCurr[k] / HRTIM_PHASES;
+	}
+	if(mean < PHASE_BALANCE_MIN_Q) { return; }																// sensor offsets dominate
+
+	for(k = 0; k < HRTIM_PHASES; k++){
+		int32_t integral = phaseIntegral[k] + (mean - pCurr[k]) * PHASE_BALANCE_KI;
+		if(integral > PHASE_INTEGRAL_MAX) { integral = PHASE_INTEGRAL_MAX; }
+			else if(integral < -PHASE_INTEGRAL_MAX) { integral = -PHASE_INTEGRAL_MAX; }
+		phaseIntegral[k] = integral;
+	}
+	phaseApply();
+}
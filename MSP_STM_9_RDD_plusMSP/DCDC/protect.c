@@ -0,0 +1,47 @@
+/*
+ * protect.c
+ *
+ *  Created on: 17 OCT. 2026
+ *  Window limits of the ADC analog watchdogs AWD2 / AWD3
+ *
+ *  AWD2 and AWD3 compare the 8 MSBs of a result, one step is 16 codes. The high
+ *  threshold is rounded down and the low one up, so a window is never narrower than
+ *  the limits: a watchdog trips at most 16 codes beyond its limit (about 1.6 V of Vin,
+ *  1 A of current) and never inside it. Currents are offset by ZERO_CURR_CODE.
+ */
+
+#include "protect.h"
+
+#define AWD8_MAX							255U
+#define ADC_CODE_MAX					4095.0f
+
+/******************************************************************************************
+*  8-bit thresholds of one code: hi trips up to 16 codes above it, lo up to 16 below
+*******************************************************************************************/
+static uint8_t awdHigh(float code){
+	if(code >= ADC_CODE_MAX) { return AWD8_MAX; }																// never trips
+	if(code <= 0.0f) { return 0; }
+	return (uint8_t)((uint16_t)code >> 4);
+}
+
+static uint8_t awdLow(float code){
+	if(code <= 0.0f) { return 0; }																							// never trips
+	if(code >= ADC_CODE_MAX) { return AWD8_MAX; }
+	return (uint8_t)((uint16_t)code >> 4);
+}
+
+/******************************************************************************************
+*  Thresholds of the four windows, volts and amperes per ADC code from the slow path
+*******************************************************************************************/
+void protectThresholds(const protectLimits_t* pLim, float vInPerCode, float vOutPerCode, float ampsPerCode,
+											 adcWatchdogs_t* pWd){
+
+	pWd->vIn.hi = awdHigh(pLim->vInMax / vInPerCode);
+	pWd->vIn.lo = 0;
+	pWd->vOut.hi = awdHigh(pLim->vOutMax / vOutPerCode);
+	pWd->vOut.lo = 0;
+	pWd->iIn.hi = awdHigh(ZERO_CURR_CODE + pLim->iInMax / ampsPerCode);
+	pWd->iIn.lo = awdLow(ZERO_CURR_CODE + pLim->iInMin / ampsPerCode);
+	pWd->iOut.hi = awdHigh(ZERO_CURR_CODE + pLim->iOutMax / ampsPerCode);
+	pWd->iOut.lo = 0;
+}
@@ -0,0 +1,22 @@
+/*
+ * recip.c
+ *
+ *  Created on: 17 OCT. 2026
+ *  Table reciprocal for divisions in the PWM interrupt
+ *
+ *  The table is built by the compiler: 257 points of 1/x on 1.0 <= x <= 2.0 in Q31,
+ *  the last point closes the interpolation of the top interval.
+ */
+
+#include "recip.h"
+
+#define RECIP(n)							((uint32_t)(2147483648.0 * 256.0 / (256 + (n)) + 0.5))
+
+#define RECIP_4(n)						RECIP(n), RECIP(n + 1), RECIP(n + 2), RECIP(n + 3)
+#define RECIP_16(n)						RECIP_4(n), RECIP_4(n + 4), RECIP_4(n + 8), RECIP_4(n + 12)
+#define RECIP_64(n)						RECIP_16(n), RECIP_16(n + 16), RECIP_16(n + 32), RECIP_16(n + 48)
+#define RECIP_256							RECIP_64(0), RECIP_64(64), RECIP_64(128), RECIP_64(192)
+
+typedef char recipTableCheck_t[(RECIP_TABLE_BITS == 8) ? 1 : -1];						// RECIP_256 must match the table
+
+const uint32_t recipTable[RECIP_TABLE_SIZE] = { RECIP_256, RECIP(256) };
@@ -0,0 +1,113 @@
+/*
+ * spread.c
+ *
+ *  Created on: 17 OCT. 2026
+ *  Spread spectrum of the buck PWM period
+ *
+ *  The period walks a fixed grid BUCK_PERIOD_MIN..BUCK_PERIOD_MAX with PERIOD_STEP.
+ *  Both tables are built by the compiler. The regulator keeps its duty in counts of
+ *  the nominal BUCK_PERIOD and spreadScaleDuty() maps it to the current period with
+ *  one multiply-shift, so the duty ratio is the same for every period of the sweep
+ *  and no rounding error is carried from one period to the next.
+ */
+
+#include "spread.h"
+
+#define SPREAD_PERIOD(n)			((uint16_t)(BUCK_PERIOD_MIN + (n) * PERIOD_STEP))
+#define SPREAD_SCALE(n)				((uint32_t)((BUCK_PERIOD_MIN + (n) * PERIOD_STEP) * 65536.0 / BUCK_PERIOD + 0.5))
+
+#define SPREAD_4(f, n)				f(n), f(n + 1), f(n + 2), f(n + 3)
+#define SPREAD_20(f, n)				SPREAD_4(f, n), SPREAD_4(f, n + 4), SPREAD_4(f, n + 8), SPREAD_4(f, n + 12), SPREAD_4(f, n + 16)
+#define SPREAD_60(f)					SPREAD_20(f, 0), SPREAD_20(f, 20), SPREAD_20(f, 40)
+
+typedef char spreadTableCheck_t[(SPREAD_STEPS_NUM == 60) ? 1 : -1];			// SPREAD_60 must match the grid
+
+static const uint16_t spreadPeriod[SPREAD_STEPS_NUM] = { SPREAD_60(SPREAD_PERIOD) };
+static const uint32_t spreadScale[SPREAD_STEPS_NUM] = { SPREAD_60(SPREAD_SCALE) };		// Q16 period / BUCK_PERIOD
+
+static struct {
+	volatile spreadProfile_ent profile;																					// guard of the custom table, set last
+	uint16_t index;																															// index of the current period
+	int16_t step;																																// +1 / -1 for the triangle
+	uint16_t lfsr;
+	const uint8_t* pCustom;
+	uint16_t customLength;
+	uint16_t customPos;
+} spread;
+
+/******************************************************************************************
+*
+*
+*******************************************************************************************/
+void spreadInit(void){
+	spread.profile = SPREAD_PROFILE;
+	spread.index = SPREAD_STEPS_NUM - 1;																			// BUCK_PERIOD_MAX
+	spread.step = -1;
+	spread.lfsr = 0xACE1U;
+	spread.pCustom = 0;
+	spread.customLength = 0;
+	spread.customPos = 0;
+}
+
+/******************************************************************************************
+*  pIndex/length are used by SPREAD_CUSTOM only, indexes >= SPREAD_STEPS_NUM are rejected
+*  Is called from the main loop, the new profile starts with the next PWM period
+*******************************************************************************************/
+int spreadSetProfile(spreadProfile_ent profile, const uint8_t* pIndex, uint16_t length){
+
+	if(profile == SPREAD_CUSTOM){
+		uint16_t i = 0;
+		if((pIndex == 0) || (length == 0)) { return -1; }
+		while(i < length){
+			if(pIndex[i] >= SPREAD_STEPS_NUM) { return -1; }
+			i++;
+		}
+		spread.profile = SPREAD_OFF;																				// the interrupt never sees a half-set table
+		__DMB();
+		spread.pCustom = pIndex;
+		spread.customLength = length;
+		spread.customPos = 0;
+		__DMB();
+	}
+	spread.profile = profile;
+	return 0;
+}
+
+/******************************************************************************************
+*  Next period for the timer
+*  Is called from HRTIM interrupt
+*******************************************************************************************/
+uint16_t spreadNextPeriod(void){
+
+	switch(spread.profile)
+	{
+		case SPREAD_TRIANGLE:
+			if((spread.index == 0) && (spread.step < 0)) { spread.step = 1; }
+				else if((spread.index == SPREAD_STEPS_NUM - 1) && (spread.step > 0)) { spread.step = -1; }
+			spread.index += spread.step;
+			break;
+
+		case SPREAD_LFSR:
+			spread.lfsr = (spread.lfsr >> 1) ^ ((spread.lfsr & 1U) ? SPREAD_LFSR_TAPS : 0);
+			spread.index = (uint16_t)(((uint32_t)spread.lfsr * SPREAD_STEPS_NUM) >> 16);
+			break;
+
+		case SPREAD_CUSTOM:
+			spread.index = spread.pCustom[spread.customPos];
+			if(++spread.customPos >= spread.customLength) { spread.customPos = 0; }
+			break;
+
+		default:
+			spread.index = SPREAD_INDEX_NOMINAL;
+			break;
+	}
+	return spreadPeriod[spread.index];
+}
+
+/******************************************************************************************
+*  Duty in counts of BUCK_PERIOD -> counts of the current period
+*  Is called from HRTIM interrupt
+*******************************************************************************************/
+uint16_t spreadScaleDuty(uint16_t dutyRef){
+	return (uint16_t)((dutyRef * spreadScale[spread.index] + 0x8000U) >> 16);
+}
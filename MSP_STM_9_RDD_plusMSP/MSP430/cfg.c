@@ -57,6 +57,10 @@ LocalCfg CFG_localCfg =
 #define TMP_CMP_DFT			0.0
 #define OUT_VOLT_CUTOFF_OFFSET_DFT	5.0
 #define OUT_VOLT_CUTOFF_SCALE_DFT	0.185
+#define MPPT_SCAN_INTERVAL_DFT	600.0
+#define MPPT_SCAN_DURATION_DFT	2000.0
+#define VIN_LOOP_KP_DFT			0.05
+#define VIN_LOOP_KI_DFT			0.002
 
 RemoteCfg CFG_remoteCfg = 
 {
@@ -88,7 +92,11 @@ RemoteCfg CFG_remoteCfg =
 	BULK_VOLT_DFT,
 	BULK_TIME_DFT,
 	BULK_RESET_VOLT,
-	TMP_CMP_DFT
+	TMP_CMP_DFT,
+	MPPT_SCAN_INTERVAL_DFT,
+	MPPT_SCAN_DURATION_DFT,
+	VIN_LOOP_KP_DFT,
+	VIN_LOOP_KI_DFT
 };
 
 // Structure to hold information that cannot be overwritten
@@ -209,6 +217,22 @@ int CFG_checkRanges()
 	else if ( CFG_remoteCfg.tmpCmp < -200.0 ) { CFG_remoteCfg.tmpCmp = -200.0; rangesOk = 0; }
 	else if ( CFG_remoteCfg.tmpCmp > 0 ) { CFG_remoteCfg.tmpCmp = 0; rangesOk = 0; }
 
+	if ( CFG_remoteCfg.mpptScanInterval != CFG_remoteCfg.mpptScanInterval ) { CFG_remoteCfg.mpptScanInterval = MPPT_SCAN_INTERVAL_DFT; rangesOk = 0; }	// This should check for NaN
+	else if ( CFG_remoteCfg.mpptScanInterval < 0.0 ) { CFG_remoteCfg.mpptScanInterval = 0.0; rangesOk = 0; }
+	else if ( CFG_remoteCfg.mpptScanInterval > 86400.0 ) { CFG_remoteCfg.mpptScanInterval = 86400.0; rangesOk = 0; }
+
+	if ( CFG_remoteCfg.mpptScanDuration != CFG_remoteCfg.mpptScanDuration ) { CFG_remoteCfg.mpptScanDuration = MPPT_SCAN_DURATION_DFT; rangesOk = 0; }	// This should check for NaN
+	else if ( CFG_remoteCfg.mpptScanDuration < 200.0 ) { CFG_remoteCfg.mpptScanDuration = 200.0; rangesOk = 0; }
+	else if ( CFG_remoteCfg.mpptScanDuration > 10000.0 ) { CFG_remoteCfg.mpptScanDuration = 10000.0; rangesOk = 0; }
+
+	if ( CFG_remoteCfg.vinLoopKp != CFG_remoteCfg.vinLoopKp ) { CFG_remoteCfg.vinLoopKp = VIN_LOOP_KP_DFT; rangesOk = 0; }	// This should check for NaN
+	else if ( CFG_remoteCfg.vinLoopKp < 0.0 ) { CFG_remoteCfg.vinLoopKp = 0.0; rangesOk = 0; }
+	else if ( CFG_remoteCfg.vinLoopKp > 1.0 ) { CFG_remoteCfg.vinLoopKp = 1.0; rangesOk = 0; }
+
+	if ( CFG_remoteCfg.vinLoopKi != CFG_remoteCfg.vinLoopKi ) { CFG_remoteCfg.vinLoopKi = VIN_LOOP_KI_DFT; rangesOk = 0; }	// This should check for NaN
+	else if ( CFG_remoteCfg.vinLoopKi < 0.0 ) { CFG_remoteCfg.vinLoopKi = 0.0; rangesOk = 0; }
+	else if ( CFG_remoteCfg.vinLoopKi > 1.0 ) { CFG_remoteCfg.vinLoopKi = 1.0; rangesOk = 0; }
+
 	if ( CFG_outVoltCutoffOffset != CFG_outVoltCutoffOffset ) { CFG_outVoltCutoffOffset = OUT_VOLT_CUTOFF_OFFSET_DFT; rangesOk = 0; }	// This should check for NaN
 	else if ( CFG_outVoltCutoffOffset < -50.0 ) { CFG_outVoltCutoffOffset = -50.0; rangesOk = 0; }
 	else if ( CFG_outVoltCutoffOffset > 50.0 ) { CFG_outVoltCutoffOffset = 50.0; rangesOk = 0; }
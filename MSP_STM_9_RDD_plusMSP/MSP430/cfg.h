@@ -156,6 +156,10 @@ typedef struct RemoteCfg_
 	float bulkTime;
 	float bulkResetVolt;
 	float tmpCmp;			// Units?  mV / C for whole pack, NOT per cell
+	float mpptScanInterval;	// s, 0 - no global maximum scan
+	float mpptScanDuration;	// ms
+	float vinLoopKp;		// per unit, pv voltage loop PI
+	float vinLoopKi;
 } RemoteCfg;
 
 extern LocalCfg		CFG_localCfg;
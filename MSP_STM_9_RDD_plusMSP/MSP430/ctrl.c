@@ -25,11 +25,13 @@
 #include "safety.h"
 #include "debug.h"
 #include "usci.h"
+#include "mppt.h"
 
 extern unsigned int IO_pwmEnabled;
 extern int update_persistent;
 
-// At the moment this implements the periodic Voc sampling from the original AERL trackers
+// Periodic Voc sampling from the original AERL trackers (MPPT_MODE_FOCV), or one Voc sample
+// after the output is enabled and then the tracker of mppt.c
 
 #define CTRL_SAMPLE_PERIOD_TICKS		(unsigned long)( 10.0 * 1000000.0 / (float)PWM_PERIOD_US )        //  58593
 #define CTRL_OPEN_CIRCUIT_TIME_TICKS	(unsigned long)( 0.10 * 1000000.0 / (float)PWM_PERIOD_US )     //  195
@@ -78,6 +80,7 @@ Iq CTRL_MpptSamplePtTarget;
 //////////////////////////////////////////////////////
    // DM: Current Limitation Section
 #define APPLY_CURRENT_LIMITATION   
+#define CURR_LIMIT_IN_DCDC		// Limit is regulated by the DCDC PWM loop, the MPPT setpoint is not nudged
    
 #ifdef APPLY_CURRENT_LIMITATION
 #if MODEL_ID_HV  == 1
@@ -191,6 +194,7 @@ void CTRL_init()
 	ctrl.outVoltSetpointValid = 0;
 
 	CTRL_calcOutVoltSetpoints();
+	MPPT_init();
 	
    // 2018-10-17 Added 
 #ifdef APPLY_CURRENT_LIMITATION
@@ -199,6 +203,9 @@ void CTRL_init()
 
    unCurrLimitHysterisis=0;   // Reset the hysterisis count
    bCurrentLimiting=false;
+#ifdef CURR_LIMIT_IN_DCDC
+   PWM_setOutCurrLim( unCntrlOutCurrLimit );
+#endif
 #endif    // APPLY_CURRENT_LIMITATION
 
 	// Set some dummy outputs -- these shouldn't matter until the output is actually switched on, 
@@ -573,6 +580,9 @@ void CTRL_tick()
 		unCntrlOutCurrLimit=IQ_cnst( CNTRL_OUTCURR_LIMIT / MEAS_OUTCURR_BASE ); 
 		unCntrlOutCurrSwOffPoint=IQ_cnst( (CNTRL_OUTCURR_LIMIT*CNTRL_OUTCURR_HYST_PERCENT/100.) / MEAS_OUTCURR_BASE ); 
 	}
+#ifdef CURR_LIMIT_IN_DCDC
+	PWM_setOutCurrLim( unCntrlOutCurrLimit );	// derated limit to the fast loop
+#endif
 	
    // Section to check the current limitation
 #ifdef APPLY_CURRENT_LIMITATION   
@@ -587,6 +597,7 @@ void CTRL_tick()
       
       // Only apply after the hysterisis count has expired.
       // This is to account for the system delays
+#ifndef CURR_LIMIT_IN_DCDC
       if(unCurrLimitHysterisis>CURR_LIMIT_HYST_COUNT) {
       
          // Increment the MPPT voltage by 200mV
@@ -600,6 +611,9 @@ void CTRL_tick()
             
          unCurrLimitHysterisis=0;
       }
+#else
+      if(unCurrLimitHysterisis>CURR_LIMIT_HYST_COUNT) unCurrLimitHysterisis=0;
+#endif
    }
    else if(bCurrentLimiting==true) {
 	   
@@ -609,11 +623,15 @@ void CTRL_tick()
       
       // Only apply after the hysterisis count has expired.
       // This is to account for the system delays
+#ifndef CURR_LIMIT_IN_DCDC
       if(unCurrLimitHysterisis>CURR_LIMIT_HYST_COUNT) {
 		 CTRL_MpptSamplePtNow -= IQ_cnst( 0.1 / MEAS_PVVOLT_BASE );
 		 PWM_setMpptSamplePt( CTRL_MpptSamplePtNow );
 		 unCurrLimitHysterisis=0;
 	  }
+#else
+      if(unCurrLimitHysterisis>CURR_LIMIT_HYST_COUNT) unCurrLimitHysterisis=0;
+#endif
 	   
 	   // Check if we need to switch off the current limitation
        if(meas.outCurr.val < unCntrlOutCurrSwOffPoint) {
@@ -677,12 +695,19 @@ void CTRL_tick()
 	{
 		// in case the mppt sample point didn't reach the target
 		PWM_setMpptSamplePt( CTRL_MpptSamplePtTarget );
+		CTRL_MpptSamplePtNow = CTRL_MpptSamplePtTarget;
+		MPPT_start( CTRL_MpptSamplePtTarget );
 		// Go back to updating measurements as normal
 		MEAS_setDoUpdate( 1 );
 	}
 	else if ( ctrl.tickCount > CTRL_NO_MEAS_TIME_TICKS )
 	{
 		PWM_setVinLim( IQ_mpy( IQ_cnst( 1.1 ), meas.pvOcVolt.val ));
+		if ( MPPT_isTracking() )
+		{
+			CTRL_MpptSamplePtNow = MPPT_tick();
+			PWM_setMpptSamplePt( CTRL_MpptSamplePtNow );
+		}
 	}
 #else
 #ifdef APPLY_CURRENT_LIMITATION         
@@ -812,7 +837,9 @@ void CTRL_tick()
 
 	if ( ctrl.tickCount == CTRL_SAMPLE_PERIOD_TICKS ) // RDD  58593
 	{
-		ctrl.tickCount = 0;
+		// The tracker runs on without the periodic open circuit sample
+		if ( MPPT_isTracking() ) ctrl.tickCount = CTRL_NO_MEAS_TIME_TICKS + 1;
+		else ctrl.tickCount = 0;
 	}
 
 
@@ -861,6 +888,7 @@ void CTRL_checkBulkFloat()
 
 	if ( ctrl.setpointIsBulk )	outVoltSetpointIq = ctrl.bulkVolt;
 	else outVoltSetpointIq = ctrl.floatVolt;
+	PWM_setOutVoltLim( outVoltSetpointIq );	// CV limit of the DCDC PWM loop
 
 //	COMMS_sendDebugPacket( meas.outVolt.val, outVoltSetpointIq, ctrl.bulkTime, ctrl.timeAtSetpoint );
 
@@ -28,6 +28,7 @@
 #include "stats.h"
 #include "ctrl.h"
 #include "adc.h"
+#include "pwm.h"
 
 #define SEGMENT_A_ADDRESS 0x10C0
 #define SEGMENT_A_LENGTH 64
@@ -290,6 +291,8 @@ void lcd_update_local_config(void)
 	CFG_localCfg.thermBeta = factoryConfig_R.thermBeta;
 	CFG_localCfg.isSlave = (float) userConfig_R.commsConfig.isSlave;
 	CFG_localCfg.overCurrSpSw = factoryConfig_R.overCurrentSetPoint;
+	PWM_setCycleCurrLim( CFG_localCfg.overCurrSpSw );
+	PWM_setPlantModel( factoryConfig_R.buckInductance, factoryConfig_R.outputCapacitance );
 }
 
 
@@ -363,6 +366,10 @@ void lcd_update_remote_config(void)
 	CFG_remoteCfg.bulkTime = userConfig_R.setPointsConfig.bulkTime;
 	CFG_remoteCfg.bulkResetVolt = userConfig_R.setPointsConfig.bulkResetVolt;
 	CFG_remoteCfg.tmpCmp = userConfig_R.setPointsConfig.tempCompensation;
+	CFG_remoteCfg.mpptScanInterval = userConfig_R.setPointsConfig.mpptScanInterval;
+	CFG_remoteCfg.mpptScanDuration = userConfig_R.setPointsConfig.mpptScanDuration;
+	CFG_remoteCfg.vinLoopKp = userConfig_R.setPointsConfig.vinLoopKp;
+	CFG_remoteCfg.vinLoopKi = userConfig_R.setPointsConfig.vinLoopKi;
 }
 
 void lcd_update(void)
@@ -525,6 +532,8 @@ void lcd_loadFactoryDefaults()
 	factoryConfig_R.thermRinf = 0.0f;
 	factoryConfig_R.thermBeta = 0.0f;
 	factoryConfig_R.overCurrentSetPoint = 50.0f;
+	factoryConfig_R.buckInductance = 15.0f;
+	factoryConfig_R.outputCapacitance = 1000.0f;
 }
 
 void lcd_loadUserDefaults()
@@ -546,6 +555,10 @@ void lcd_loadUserDefaults()
 	userConfig_R.setPointsConfig.bulkResetVolt = 50.4f;
 	userConfig_R.setPointsConfig.tempCompensation = 0.0f;
 	userConfig_R.setPointsConfig.nominalVolt = 48.0f;
+	userConfig_R.setPointsConfig.mpptScanInterval = 600l;
+	userConfig_R.setPointsConfig.mpptScanDuration = 2000l;
+	userConfig_R.setPointsConfig.vinLoopKp = 0.05f;
+	userConfig_R.setPointsConfig.vinLoopKi = 0.002f;
 }
 
 void lcd_loadEventsDefaults()
@@ -674,6 +687,23 @@ void lcd_checkPersistentUpdate(void)
 	}
 }
 
+// Gains of a finished autotune go to the user config, the DCDC runs with them already
+void lcd_checkAutoTuneUpdate(void)
+{
+	float kp;
+	float ki;
+
+	if (lcd_writeNext < 0 && PWM_getAutoTuneGains( &kp, &ki ))
+	{
+		memcpy(userConfig_W.bytes, userConfig_R.bytes, sizeof(userConfig_t));
+		userConfig_W.setPointsConfig.vinLoopKp = kp;
+		userConfig_W.setPointsConfig.vinLoopKi = ki;
+		CFG_remoteCfg.vinLoopKp = kp;
+		CFG_remoteCfg.vinLoopKi = ki;
+		lcd_queueWrite(TYPE_USER);
+	}
+}
+
 int lcd_startWrite()
 {
 	int ret;
@@ -54,5 +54,6 @@ void lcd_loadTelemetry(void);
 int lcd_queueWrite(int type);
 int lcd_startWrite(void);
 void lcd_checkPersistentUpdate(void);
+void lcd_checkAutoTuneUpdate(void);
 
 #endif // __LCD_H__
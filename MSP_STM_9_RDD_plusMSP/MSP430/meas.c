@@ -32,6 +32,7 @@ int measDoUpdate;
 extern floatValue_t calculatedValue;
 extern floatValue_t averageValue;
 extern floatValue_t momentValue;
+extern slowAdcValue_t slowValue;
 
 void MEAS_init()
 {
@@ -155,9 +156,7 @@ void MEAS_update()
 	
 	meas.flSetSense.val = 0;	//?????
 	
-	meas.caseTmp.val = 0;	//?????
-	
-	meas.tmpCmpSense.val = 0;	//?????
+	// caseTmp, tmpCmpSense: MEAS_updateTempr
 
 	meas.pvOcVolt.valReal = 0; //?????
 	
@@ -220,6 +219,12 @@ void MEAS_updateTempr()
 
 	int ind1, ind2;
 
+	// slow channels, average codes of the DC/DC slow decimator, no second filter
+	meas.caseTmp.valPreFilter = IQ_mpy( slowValue.tmpCase + meas.caseTmp.offset, meas.caseTmp.scale );
+	meas.caseTmp.val = meas.caseTmp.valPreFilter;
+	meas.tmpCmpSense.valPreFilter = IQ_mpy( slowValue.tmpCmp + meas.tmpCmpSense.offset, meas.tmpCmpSense.scale );
+	meas.tmpCmpSense.val = meas.tmpCmpSense.valPreFilter;
+
 #ifdef DIGITAL_TEMP
 	unsigned int kelvin = TEMP_getValue();
 	if (kelvin == UINT_MAX)
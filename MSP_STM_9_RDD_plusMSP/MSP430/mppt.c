@@ -0,0 +1,253 @@
+//-------------------------------------------------------------------
+// File: mppt.c
+// Project: CY CoolMax MPPT
+// Device: STM32F334
+// Description: Perturb & observe / incremental conductance tracker
+// History:
+//   2026-10-17: original
+//-------------------------------------------------------------------
+
+#include <stdint.h>
+#include <math.h>
+
+#include "mppt.h"
+#include "meas.h"
+#include "pwm.h"
+#include "cfg.h"
+
+// Called from CTRL_tick, the tracker updates the setpoint once per period so the
+// filtered measurements settle after a step
+#define MPPT_PERIOD_TICKS		(unsigned long)( 0.10 * 1000000.0 / (float)PWM_PERIOD_US )		// 195
+
+#define MPPT_STEP_MIN			0.2		// V
+#define MPPT_STEP_MAX			4.0		// V
+#define MPPT_STEP_GAIN			0.05	// V per W/V of |dP/dV|
+#define MPPT_DV_MIN				0.1		// V, smaller dV is taken as no voltage change
+#define MPPT_DI_MIN				0.05	// A, with no voltage change
+#define MPPT_VIN_MARGIN			1.05	// lowest setpoint above outVolt / PWM_getDutyMax()
+
+// Global maximum scan: the setpoint walks MPPT_SCAN_POINTS steps from MPPT_vinMin()
+// up to Voc, the mean power of the second half of each step is kept
+#define MPPT_SCAN_POINTS		64
+#define MPPT_TICKS_PER_MS		( 1000.0 / (float)PWM_PERIOD_US )
+
+typedef struct Mppt_
+{
+	int mode;
+	unsigned int tickCount;
+	int valid;				// previous point is usable
+	int dir;				// +1 / -1
+	float vRef;				// setpoint, V
+	float step;				// last step, V
+	float vPrev;
+	float iPrev;
+	float pPrev;
+	float pMid;				// power half way through the period, no step since
+	unsigned long scanTickCount;	// ticks since the last scan
+	int scanPoint;					// -1 while tracking
+	unsigned int scanDwellTicks;
+	unsigned int scanDwellCount;
+	long scanPowerSum;
+	float scanVStart;
+	float scanVStep;
+	float scanVBefore;				// setpoint to go back to if the scan is aborted
+} Mppt;
+
+static Mppt mppt;
+static uint16_t scanPower[MPPT_SCAN_POINTS];	// pv power base
+
+void MPPT_init()
+{
+	mppt.mode = MPPT_MODE_DEFAULT;
+	MPPT_start( meas.pvVolt.val );
+}
+
+void MPPT_setMode( int mode )
+{
+	if ( mode < MPPT_MODE_FOCV || mode > MPPT_MODE_INC_COND ) return;
+	mppt.mode = mode;
+	mppt.valid = 0;
+}
+
+int MPPT_getMode()
+{
+	return mppt.mode;
+}
+
+// Set if the tracker replaces the periodic Voc sample
+int MPPT_isTracking()
+{
+	return mppt.mode != MPPT_MODE_FOCV;
+}
+
+// Start from pvVoltStart (pv volt base), e.g. the fractional Voc point after the first open circuit sample
+void MPPT_start( Iq pvVoltStart )
+{
+	mppt.vRef = pvVoltStart * meas.pvVolt.base;
+	mppt.step = MPPT_STEP_MAX;
+	mppt.dir = -1;			// starting points are on the Voc side
+	mppt.valid = 0;
+	mppt.tickCount = 0;
+	mppt.scanTickCount = 0;
+	mppt.scanPoint = -1;
+}
+
+// Set while the global maximum scan moves the setpoint
+int MPPT_isScanning()
+{
+	return mppt.scanPoint >= 0;
+}
+
+// Lowest setpoint the pv voltage loop can hold: below it the duty is at its limit, the
+// loop loses the selection and the tracker would hold there
+static float MPPT_vinMin()
+{
+	return meas.outVolt.val * meas.outVolt.base / PWM_getDutyMax() * MPPT_VIN_MARGIN;
+}
+
+static void MPPT_scanStart()
+{
+	float vStart = MPPT_vinMin();
+	float vEnd = meas.pvOcVolt.val * meas.pvOcVolt.base;
+
+	mppt.scanTickCount = 0;
+	if ( vEnd <= vStart ) return;
+
+	mppt.scanVStart = vStart;
+	mppt.scanVStep = ( vEnd - vStart ) / ( MPPT_SCAN_POINTS - 1 );
+	mppt.scanVBefore = mppt.vRef;
+	mppt.scanDwellTicks = (unsigned int)( CFG_remoteCfg.mpptScanDuration * MPPT_TICKS_PER_MS / MPPT_SCAN_POINTS );
+	if ( mppt.scanDwellTicks < 2 ) mppt.scanDwellTicks = 2;
+	mppt.scanDwellCount = 0;
+	mppt.scanPowerSum = 0;
+	mppt.scanPoint = 0;
+	mppt.vRef = vStart;
+}
+
+static void MPPT_scanTick()
+{
+	int k, kMax;
+
+	mppt.scanDwellCount++;
+	if ( mppt.scanDwellCount > mppt.scanDwellTicks / 2 )
+	{
+		// Settled: an output limit holding the converter now makes the curve wrong. The
+		// step to the point may hand the selection over for a few periods, that is no reason
+		if ( !PWM_isVinRegulated() )
+		{
+			mppt.vRef = mppt.scanVBefore;
+			mppt.scanPoint = -1;
+			mppt.valid = 0;
+			return;
+		}
+		// Average the power
+		mppt.scanPowerSum += IQ_mpy( meas.pvVolt.valPreFilter, meas.pvCurr.valPreFilter );
+	}
+	if ( mppt.scanDwellCount < mppt.scanDwellTicks ) return;
+
+	mppt.scanPowerSum /= (long)( mppt.scanDwellTicks - mppt.scanDwellTicks / 2 );
+	scanPower[mppt.scanPoint] = ( mppt.scanPowerSum > 0 ) ? (uint16_t)mppt.scanPowerSum : 0;
+	mppt.scanDwellCount = 0;
+	mppt.scanPowerSum = 0;
+
+	if ( ++mppt.scanPoint < MPPT_SCAN_POINTS )
+	{
+		mppt.vRef = mppt.scanVStart + mppt.scanPoint * mppt.scanVStep;
+		return;
+	}
+
+	// Jump to the global peak, the tracker restarts there with the smallest step
+	kMax = 0;
+	for ( k = 1; k < MPPT_SCAN_POINTS; k++ )
+	{
+		if ( scanPower[k] > scanPower[kMax] ) kMax = k;
+	}
+	mppt.vRef = mppt.scanVStart + kMax * mppt.scanVStep;
+	mppt.step = MPPT_STEP_MIN;
+	mppt.valid = 0;
+	mppt.tickCount = 0;
+	mppt.scanPoint = -1;
+}
+
+// Returns the pv voltage setpoint (pv volt base)
+Iq MPPT_tick()
+{
+	float v, i, p, slope, vMin, vMax;
+
+	if ( mppt.scanPoint >= 0 )
+	{
+		MPPT_scanTick();
+		return (Iq)( mppt.vRef / meas.pvVolt.base );
+	}
+
+	if ( CFG_remoteCfg.mpptScanInterval > 0 )
+	{
+		if ( ++mppt.scanTickCount >= (unsigned long)( CFG_remoteCfg.mpptScanInterval * 1000.0 * MPPT_TICKS_PER_MS ) )
+		{
+			// Under an output limit try again next tick
+			if ( PWM_isVinRegulated() ) MPPT_scanStart();
+			if ( mppt.scanPoint >= 0 ) return (Iq)( mppt.vRef / meas.pvVolt.base );
+		}
+	}
+
+	if ( ++mppt.tickCount == MPPT_PERIOD_TICKS / 2 ) mppt.pMid = meas.pvPower.val * meas.pvPower.base;
+	if ( mppt.tickCount >= MPPT_PERIOD_TICKS )
+	{
+		mppt.tickCount = 0;
+
+		v = meas.pvVolt.val * meas.pvVolt.base;
+		i = meas.pvCurr.val * meas.pvCurr.base;
+		p = meas.pvPower.val * meas.pvPower.base;
+
+		if ( mppt.valid && PWM_isVinRegulated() )
+		{
+			float dv = v - mppt.vPrev;
+			float di = i - mppt.iPrev;
+
+			if ( mppt.mode == MPPT_MODE_INC_COND )
+			{
+				if ( fabsf( dv ) > MPPT_DV_MIN )
+				{
+					// dP/dV = I + V * dI/dV, zero at the maximum
+					slope = i + v * di / dv;
+					mppt.dir = ( slope > 0 ) ? 1 : -1;
+					slope = fabsf( slope );
+				}
+				else
+				{
+					// Same voltage, irradiance changed
+					if ( di > MPPT_DI_MIN ) mppt.dir = 1;
+					else if ( di < -MPPT_DI_MIN ) mppt.dir = -1;
+					slope = 0;
+				}
+			}
+			else
+			{
+				// dP-P&O: the second half of the period has no step, its change is the
+				// irradiance alone. Taken off twice from the whole change, what is left is
+				// the step. Reverse if the step lost power, the slope is taken over the step
+				float dp = ( p - mppt.pPrev ) - 2.0f * ( p - mppt.pMid );
+				if ( dp < 0 ) mppt.dir = -mppt.dir;
+				slope = fabsf( dp ) / mppt.step;
+			}
+
+			mppt.step = MPPT_STEP_GAIN * slope;
+			if ( mppt.step < MPPT_STEP_MIN ) mppt.step = MPPT_STEP_MIN;
+			if ( mppt.step > MPPT_STEP_MAX ) mppt.step = MPPT_STEP_MAX;
+
+			mppt.vRef += mppt.dir * mppt.step;
+		}
+		mppt.valid = PWM_isVinRegulated();
+
+		vMin = MPPT_vinMin();
+		vMax = meas.pvOcVolt.val * meas.pvOcVolt.base;
+		if ( mppt.vRef > vMax ) mppt.vRef = vMax;
+		if ( mppt.vRef < vMin ) mppt.vRef = vMin;
+
+		mppt.vPrev = v;
+		mppt.iPrev = i;
+		mppt.pPrev = p;
+	}
+
+	return (Iq)( mppt.vRef / meas.pvVolt.base );
+}
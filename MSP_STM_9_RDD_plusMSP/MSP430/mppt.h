@@ -0,0 +1,31 @@
+//-------------------------------------------------------------------
+// File: mppt.h
+// Project: CY CoolMax MPPT
+// Device: STM32F334
+// Description: Perturb & observe / incremental conductance tracker
+// History:
+//   2026-10-17: original
+//-------------------------------------------------------------------
+
+#ifndef MPPT_H
+#define MPPT_H
+
+#include "iqmath.h"
+
+#define MPPT_MODE_FOCV			0		// fractional Voc of the original AERL trackers, periodic open circuit sample
+#define MPPT_MODE_PO			1		// adaptive step perturb & observe
+#define MPPT_MODE_INC_COND		2		// incremental conductance
+
+#define MPPT_MODE_DEFAULT		MPPT_MODE_PO
+
+void MPPT_init();
+
+void MPPT_setMode( int mode );
+int MPPT_getMode();
+int MPPT_isTracking();
+int MPPT_isScanning();
+
+void MPPT_start( Iq pvVoltStart );
+Iq MPPT_tick();
+
+#endif // MPPT_H
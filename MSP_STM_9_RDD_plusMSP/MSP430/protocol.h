@@ -108,6 +108,8 @@ typedef union {
 		float thermRinf;
 		float thermBeta;
 		float overCurrentSetPoint;
+		float buckInductance;	// uH, plant model of the deadbeat current control
+		float outputCapacitance;	// uF
 	};
 	unsigned char bytes[1];
 } factoryConfig_t;
@@ -157,6 +159,10 @@ typedef struct {
 	float bulkResetVolt;
 	float tempCompensation;
 	float nominalVolt;
+	uint32_t mpptScanInterval; // s, 0 - no global maximum scan
+	uint32_t mpptScanDuration; // ms
+	float vinLoopKp; // per unit, pv voltage loop PI, written by COMMAND_AUTOTUNE
+	float vinLoopKi; // per unit per PWM period
 } setPointsConfig_t;
 
 typedef union {
@@ -238,15 +244,62 @@ typedef union  {
 	unsigned char bytes[1];
 } miscState_t;
 
+typedef union {
+	struct {
+		uint16_t handler;	// 0 HRTIM1_TIMA, 1 DMA1_Channel1, 2 ADC1_2, 3 USART1, 4 TIM3, 5 SysTick, 6 trigger to duty
+		uint16_t : 16;	// aligned to 32bit boundary
+		uint32_t count;
+		uint32_t min;	// CPU cycles
+		uint32_t max;
+		uint32_t mean;
+		uint16_t bins[16];	// bin n counts 2^n..2^(n+1)-1 cycles, the last bin is open
+	};
+	unsigned char bytes[1];
+} isrProfile_t;
+
+#define IV_CURVE_PAGE_POINTS 12	// the packet fits PACKET_LENGTH with every byte DLE stuffed
+
+typedef union {
+	struct {
+		uint16_t page;	// points page*IV_CURVE_PAGE_POINTS.., IV_CURVE_PAGE_POINTS per page
+		uint16_t points;	// points of the curve, duty DUTY_MAX down to the open circuit, 256 at most
+		uint16_t state;	// 0 no curve, 1 running, 2 done, 3 stopped at the output limit, 4 aborted
+		uint16_t : 16;	// aligned to 32bit boundary
+		float vIn[IV_CURVE_PAGE_POINTS];	// V, 0 past the last point
+		float iIn[IV_CURVE_PAGE_POINTS];	// A
+	};
+	unsigned char bytes[1];
+} ivCurve_t;
+
+#define FRA_PAGE_POINTS 5	// the packet fits PACKET_LENGTH with every byte DLE stuffed
+
+typedef union {
+	struct {
+		uint16_t page;	// points page*FRA_PAGE_POINTS.., FRA_PAGE_POINTS per page
+		uint16_t points;	// points measured, 24 for a full sweep
+		uint16_t state;	// 0 no response, 1 running, 2 done, 3 stopped by a limit loop, 4 aborted
+		uint16_t : 16;	// aligned to 32bit boundary
+		float freq[FRA_PAGE_POINTS];	// Hz, 0 past the last point
+		float plantGain[FRA_PAGE_POINTS];	// dB of V per unit duty, pv voltage response to the duty
+		float plantPhase[FRA_PAGE_POINTS];	// deg
+		float loopGain[FRA_PAGE_POINTS];	// dB, pv voltage loop, crossover at 0 dB
+		float loopPhase[FRA_PAGE_POINTS];	// deg, phase margin = 180 + phase at the crossover
+	};
+	unsigned char bytes[1];
+} fraCurve_t;
+
 #define VERSION_TELEMETRY 1
-#define VERSION_FACTORY 1
-#define VERSION_USER 1
+#define VERSION_FACTORY 2
+#define VERSION_USER 3
 #define VERSION_EVENTS 1
 #define VERSION_SYS_INFO 1
 #define VERSION_COMMAND 1
 #define VERSION_PASSWORD 1
 #define VERSION_SET_TIME 1
 #define VERSION_MISC_STATE 1
+#define VERSION_ISR_PROFILE 1
+#define VERSION_IV_CURVE 2
+#define VERSION_FRA 2
 
 typedef enum packet_Type_
 {
@@ -258,7 +311,10 @@ typedef enum packet_Type_
 	TYPE_COMMAND = 0x05,
 	TYPE_PASSWORD = 0x06,
 	TYPE_SET_TIME = 0x07,
-	TYPE_MISC_STATE = 0x08
+	TYPE_MISC_STATE = 0x08,
+	TYPE_ISR_PROFILE = 0x09,	// request only, each request returns the next handler
+	TYPE_IV_CURVE = 0x0A,	// request only, each request returns the next page, page 0 after COMMAND_IV_TRACE
+	TYPE_FRA = 0x0B	// request only, each request returns the next page, page 0 after COMMAND_FRA
 } packet_Type;
 
 typedef enum command_Code_
@@ -266,6 +322,9 @@ typedef enum command_Code_
 	// Command codes used by command_t
 	COMMAND_RESET = 0x0000,
 	COMMAND_ENABLE_OUTPUT = 0x0001,
+	COMMAND_IV_TRACE = 0x0002,	// response arg 1 - started, 0 - output is off or a trace runs
+	COMMAND_AUTOTUNE = 0x0003,	// response arg 1 - started, 0 - output is off, an output limit is active or a trace runs; the gains come as TYPE_USER once written
+	COMMAND_FRA = 0x0004,	// arg 0 - sweep, else one point at arg Hz; response arg 1 - started, 0 - output is off, an output limit is active, a trace runs or arg is out of range
 
 	// Response codes used by command_t
 	RESPONSE_STARTUP = 0xFF00,
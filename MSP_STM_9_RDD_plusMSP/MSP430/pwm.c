@@ -70,6 +70,8 @@ void PWM_init( void )
 	flTrimCal.offset = CFG_localCfg.flTrimDacCal.offset;
 	flTrimCal.scale = CFG_localCfg.flTrimDacCal.scale;
 
+	PWM_setVinLoopGains( CFG_remoteCfg.vinLoopKp, CFG_remoteCfg.vinLoopKi );
+
 	// Init timer A
 //	TACTL = TASSEL_2 | ID_0 | TACLR | TAIE;			// SMCLK/1, clear TAR, enable overflow interrupt
 
@@ -131,6 +133,62 @@ void PWM_setFlTrim( Iq val )
 //	flTrimShadow = CONT_TIMER_LOAD_VAL + IQ_TO_PWM( (unsigned int)tmp );
 }
 
+// Output voltage limit of the DCDC min-select regulator, val in MEAS_OUTVOLT_BASE units
+void PWM_setOutVoltLim( Iq val )
+{
+	DCDC_setVoutLimit( (float)val * (float)MEAS_OUTVOLT_IQBASE );
+}
+
+// Output current limit of the DCDC min-select regulator, val in MEAS_OUTCURR_BASE units
+void PWM_setOutCurrLim( Iq val )
+{
+	DCDC_setIoutLimit( (float)val * (float)MEAS_OUTCURR_IQBASE );
+}
+
+// Cycle-by-cycle output current limit of the DCDC comparator, A, 0 keeps the default
+void PWM_setCycleCurrLim( float curr )
+{
+	if ( curr > 0 ) DCDC_setCycleCurrLimit( curr );
+}
+
+// Analog watchdog windows of the DCDC, the fault stops the PWM without the control interrupt
+void PWM_setHwLimits( Iq pvVoltMax, Iq outVoltMax, Iq pvCurrMin, Iq pvCurrMax, Iq outCurrMax )
+{
+	DCDC_setProtectLimits( (float)pvVoltMax * (float)MEAS_PVVOLT_IQBASE, (float)outVoltMax * (float)MEAS_OUTVOLT_IQBASE,
+						   (float)pvCurrMin * (float)MEAS_PVCURR_IQBASE, (float)pvCurrMax * (float)MEAS_PVCURR_IQBASE,
+						   (float)outCurrMax * (float)MEAS_OUTCURR_IQBASE );
+}
+
+// Set while the pv voltage loop sets the duty, i.e. no output limit is active
+int PWM_isVinRegulated( void )
+{
+	return DCDC_getActiveLoop() == DCDC_LOOP_VIN;
+}
+
+// Highest duty ratio of the buck stage, the pv voltage can't be held below outVolt / this
+float PWM_getDutyMax( void )
+{
+	return (float)DUTY_MAX / (float)BUCK_PERIOD;
+}
+
+// uH, uF of the buck stage for the deadbeat current control, the DCDC keeps its default on a bad value
+void PWM_setPlantModel( float inductance, float capacitance )
+{
+	if ( ( inductance > 0 ) && ( capacitance > 0 ) ) DCDC_setPlantModel( inductance * 1e-6f, capacitance * 1e-6f );
+}
+
+// Per unit PI gains of the pv voltage loop, from the user config or an autotune
+void PWM_setVinLoopGains( float kp, float ki )
+{
+	DCDC_setPidGains( DCDC_LOOP_VIN, kp, ki, 0.0f );
+}
+
+// 1 once per finished autotune, the gains are in use already
+int PWM_getAutoTuneGains( float* pKp, float* pKi )
+{
+	return DCDC_getAutoTuneGains( pKp, pKi ) == 0;
+}
+
 void PWM_isr(void)
 {
 //	if ( TAIV == TAIV_OVERFLOW )
@@ -31,6 +31,15 @@ extern void PWM_isr(void);
 void PWM_setMpptSamplePt( Iq val );
 void PWM_setVinLim( Iq val );
 void PWM_setFlTrim( Iq val );
+void PWM_setOutVoltLim( Iq val );
+void PWM_setOutCurrLim( Iq val );
+void PWM_setCycleCurrLim( float curr );
+void PWM_setPlantModel( float inductance, float capacitance );
+void PWM_setHwLimits( Iq pvVoltMax, Iq outVoltMax, Iq pvCurrMin, Iq pvCurrMax, Iq outCurrMax );
+int PWM_isVinRegulated( void );
+float PWM_getDutyMax( void );
+void PWM_setVinLoopGains( float kp, float ki );
+int PWM_getAutoTuneGains( float* pKp, float* pKi );
 
 #endif // PWM_H
 
@@ -14,7 +14,7 @@
 #include "safety.h"
 #include "meas.h"
 #include "io.h"
-///#include "pwm.h"
+#include "pwm.h"
 #include "cfg.h"
 ///#include "flag.h"
 ///#include "comms.h"
@@ -30,6 +30,7 @@
 
 #define SAFETY_IO_VOLTAGE_THRESHOLD		2 // Required PV Volts above the Battery Voltage
 #define SAFETY_OUTCURRCRIT_LIMIT		90 // Immediate Output Overcurrent Shutdown - (Should help protect against a system short)
+#define SAFETY_PVCURR_NEG_LIMIT			IQ_cnst(-2.0/MEAS_PVCURR_BASE) // PV Negative Current Shutdown
 
 #define SAFETY_PVVOLT_LIMIT_HV			290.0 // PV Voltage Maximum Shutdown
 #define SAFETY_OUTCURR_LIMIT_HV			65 // // Allow for 1.4x PV Overclock
@@ -79,6 +80,8 @@ void SAFETY_init()
 	safety.PVVoltLowRstDelayTickCnt = 0;
 	safety.lowPVShutdownInt = 0;
 	VAR_SAFETY_setLimits();
+	// Same limits in the DCDC analog watchdogs, immediate and with no delay ticks
+	PWM_setHwLimits( SAFETY_PVVoltLimit, SAFETY_OutVoltLimit, SAFETY_PVCURR_NEG_LIMIT, SAFETY_PulseCurrLimit, SAFETY_OutCurrCrit );
 }
 
 void SAFETY_setLimitsMV()	//needs to happen after MEAS_setOutVoltBase()
@@ -106,7 +109,7 @@ void SAFETY_setLimitsHV()	//needs to happen after MEAS_setOutVoltBase()
 void SAFETY_tick()
 {
 
-	if ( meas.pvCurr.valPreFilter < IQ_cnst(-2.0/MEAS_PVCURR_BASE) ) // PV Negative Current Shutdown
+	if ( meas.pvCurr.valPreFilter < SAFETY_PVCURR_NEG_LIMIT ) // PV Negative Current Shutdown
 	{
 		safety.pvCurrNegTickCnt++;
 		if ( safety.pvCurrNegTickCnt >= PVCURR_NEG_MIN_TICKS )
@@ -14,7 +14,7 @@
 
 // Include files
 ///#include <msp430x24x.h>
-#include "Stm32f3xx.h"
+#include "stm32f3xx.h"
 #include "usci.h"
 #include <signal.h>
 ///#include "io.h"
@@ -23,6 +23,9 @@
 #include "time.h"
 #include "crc16.h"
 #include "ctrl.h"
+#include "isrprof.h"
+#include "ivtrace.h"
+#include "dcdc.h"
 
 /*
  * Initialise SPI port
@@ -48,6 +51,10 @@ typedef enum uart_State_
 } uart_State;
 
 #define FOOTER_LENGTH 6
+#define PACKET_DATA_MAX ((PACKET_LENGTH - FOOTER_LENGTH - 6) / 2)	// struct bytes of a packet with every byte and the id DLE stuffed
+
+typedef char ivCurveSizeCheck_t[(sizeof(ivCurve_t) <= PACKET_DATA_MAX) ? 1 : -1];
+typedef char fraCurveSizeCheck_t[(sizeof(fraCurve_t) <= PACKET_DATA_MAX) ? 1 : -1];
 
 // Global variables
 unsigned char tx_buffer[PACKET_LENGTH];
@@ -69,6 +76,9 @@ sysInfo_t sysInfo_R;
 command_t command_R;
 password_t password_R;
 miscState_t miscState_R;
+isrProfile_t isrProfile_R;
+ivCurve_t ivCurve_R;
+fraCurve_t fraCurve_R;
 
 factoryConfig_t factoryConfig_W;
 userConfig_t userConfig_W;
@@ -185,6 +195,96 @@ void loadPassword()
 	}
 }
 
+/*
+ * Load the profile of the next interrupt handler, one handler per request.
+ */
+void loadIsrProfile(void)
+{
+	static uint16_t handler = 0;
+	isrProfStat_t stat;
+	int i;
+
+	isrProfGet((isrProf_ent)handler, &stat);
+	isrProfile_R.handler = handler;
+	isrProfile_R.count = stat.count;
+	isrProfile_R.min = stat.count ? stat.min : 0;
+	isrProfile_R.max = stat.max;
+	isrProfile_R.mean = stat.count ? (uint32_t)(stat.sum / stat.count) : 0;
+	for(i=0; i<ISR_PROF_BINS; i++)
+	{
+		isrProfile_R.bins[i] = stat.bins[i];
+	}
+
+	if(++handler >= ISR_PROF_NUM)
+	{
+		handler = 0;
+	}
+}
+
+static uint16_t ivCurvePage = 0;
+
+/*
+ * Load the next page of the I-V curve, IV_CURVE_PAGE_POINTS per request.
+ */
+void loadIvCurve(void)
+{
+	uint16_t pages;
+	int i;
+
+	ivCurve_R.state = ivTraceState;
+	ivCurve_R.points = ivTraceGetPointsNum();
+	pages = (ivCurve_R.points + IV_CURVE_PAGE_POINTS - 1) / IV_CURVE_PAGE_POINTS;
+	if(ivCurvePage >= pages)
+	{
+		ivCurvePage = 0;
+	}
+	ivCurve_R.page = ivCurvePage;
+	for(i=0; i<IV_CURVE_PAGE_POINTS; i++)
+	{
+		if(ivTraceGetPoint(ivCurvePage * IV_CURVE_PAGE_POINTS + i, &ivCurve_R.vIn[i], &ivCurve_R.iIn[i]))
+		{
+			ivCurve_R.vIn[i] = 0.0f;
+			ivCurve_R.iIn[i] = 0.0f;
+		}
+	}
+
+	ivCurvePage++;
+}
+
+static uint16_t fraCurvePage = 0;
+
+/*
+ * Load the next page of the frequency response, FRA_PAGE_POINTS per request.
+ */
+void loadFraCurve(void)
+{
+	uint16_t pages;
+	int i;
+
+	fraCurve_R.state = DCDC_getFraState();
+	fraCurve_R.points = DCDC_getFraPointsNum();
+	pages = (fraCurve_R.points + FRA_PAGE_POINTS - 1) / FRA_PAGE_POINTS;
+	if(fraCurvePage >= pages)
+	{
+		fraCurvePage = 0;
+	}
+	fraCurve_R.page = fraCurvePage;
+	for(i=0; i<FRA_PAGE_POINTS; i++)
+	{
+		if(DCDC_getFraPoint(fraCurvePage * FRA_PAGE_POINTS + i, &fraCurve_R.freq[i], &fraCurve_R.plantGain[i], &fraCurve_R.plantPhase[i],
+												&fraCurve_R.loopGain[i], &fraCurve_R.loopPhase[i]))
+		{
+			fraCurve_R.freq[i] = 0.0f;
+			fraCurve_R.plantGain[i] = 0.0f;
+			fraCurve_R.plantPhase[i] = 0.0f;
+			fraCurve_R.loopGain[i] = 0.0f;
+			fraCurve_R.loopPhase[i] = 0.0f;
+		}
+	}
+
+	fraCurvePage++;
+}
+
 /*
  * Process the recevied data.
  * If the received data is a request then send the requested packet otherwise write the data to flash then
@@ -269,6 +369,10 @@ void uart_receive(void)
 				structSize = sizeof(miscState_t);
 				version = VERSION_MISC_STATE;
 				break;
+			case TYPE_ISR_PROFILE:
+			case TYPE_IV_CURVE:
+			case TYPE_FRA:
+				break;
 			default:
 				// Unknown packet type
 				uart_send_error(ERROR_PACKET_TYPE);
@@ -287,6 +391,18 @@ void uart_receive(void)
 				{
 					loadPassword();
 				}
+				else if (packetID.type == TYPE_ISR_PROFILE)
+				{
+					loadIsrProfile();
+				}
+				else if (packetID.type == TYPE_IV_CURVE)
+				{
+					loadIvCurve();
+				}
+				else if (packetID.type == TYPE_FRA)
+				{
+					loadFraCurve();
+				}
 				if (packetID.type != TYPE_COMMAND && packetID.type != TYPE_SET_TIME)
 				{
 					uart_send(packetID.type);
@@ -340,6 +456,31 @@ void uart_receive(void)
 							uart_send_response(COMMAND_ENABLE_OUTPUT, command_W.arg ? 1 : 0);
 							return;
 						}
+						else if (command_W.commandCode == COMMAND_IV_TRACE)
+						{
+							int started = (DCDC_startIvTrace() == 0);
+							if(started)
+							{
+								ivCurvePage = 0;
+							}
+							uart_send_response(COMMAND_IV_TRACE, started ? 1 : 0);
+							return;
+						}
+						else if (command_W.commandCode == COMMAND_AUTOTUNE)
+						{
+							uart_send_response(COMMAND_AUTOTUNE, (DCDC_startAutoTune() == 0) ? 1 : 0);
+							return;
+						}
+						else if (command_W.commandCode == COMMAND_FRA)
+						{
+							int started = (DCDC_startFra(command_W.arg) == 0);
+							if(started)
+							{
+								fraCurvePage = 0;
+							}
+							uart_send_response(COMMAND_FRA, started ? 1 : 0);
+							return;
+						}
 					}
 					else if(packetID.type == TYPE_SET_TIME)
 					{
@@ -363,6 +504,7 @@ void uart_receive(void)
 		if (uart_state == UART_STATE_IDLE)
 		{
 			lcd_checkPersistentUpdate();
+			lcd_checkAutoTuneUpdate();
 		}
 	}
 }
@@ -422,6 +564,21 @@ int uart_send(int type)
 		structSize = sizeof(miscState_t);
 		version = VERSION_MISC_STATE;
 		break;
+	case TYPE_ISR_PROFILE:
+		bytes = isrProfile_R.bytes;
+		structSize = sizeof(isrProfile_t);
+		version = VERSION_ISR_PROFILE;
+		break;
+	case TYPE_IV_CURVE:
+		bytes = ivCurve_R.bytes;
+		structSize = sizeof(ivCurve_t);
+		version = VERSION_IV_CURVE;
+		break;
+	case TYPE_FRA:
+		bytes = fraCurve_R.bytes;
+		structSize = sizeof(fraCurve_t);
+		version = VERSION_FRA;
+		break;
 	default:
 		uart_state = UART_STATE_IDLE;
 		return 0;
@@ -451,6 +608,7 @@ int uart_send(int type)
 			if(k >= PACKET_LENGTH - FOOTER_LENGTH)
 			{
 				// Error: Too much data
+				uart_state = UART_STATE_IDLE;
 				return 0;
 			}
 			tx_buffer[k++] = DLE;
@@ -458,6 +616,7 @@ int uart_send(int type)
 		if(k >= PACKET_LENGTH - FOOTER_LENGTH)
 		{
 			// Error: Too much data
+			uart_state = UART_STATE_IDLE;
 			return 0;
 		}
 		tx_buffer[k++] = bytes[i];
@@ -534,6 +693,7 @@ void USART1_IRQHandler(void)
 {
 	unsigned char rx;
 	Time time;
+	ISR_PROF_ENTER();
 	
 	//IRQ transmit complete
 	if(USART1->ISR & USART_ISR_TC){
@@ -629,4 +789,5 @@ void USART1_IRQHandler(void)
 	/// remove old hardware IE2 |= UCA0RXIE;
 	USART1->CR1 |= USART_CR1_RXNEIE;
 	}
+	ISR_PROF_EXIT(ISR_PROF_USART1);
 }
@@ -25,6 +25,9 @@ extern eventConfig_t eventConfig_R;
 extern sysInfo_t sysInfo_R;
 extern command_t command_R;
 extern miscState_t miscState_R;
+extern isrProfile_t isrProfile_R;
+extern ivCurve_t ivCurve_R;
+extern fraCurve_t fraCurve_R;
 
 extern factoryConfig_t factoryConfig_W;
 extern userConfig_t userConfig_W;
@@ -0,0 +1,210 @@
+/*
+ * core_cm4.h
+ *
+ *  Created on: 17 OCT. 2026
+ *  Host stand-in of the CMSIS Cortex-M4 core header for the simulation
+ *
+ *  stm32f334x8.h and arm_math.h include "core_cm4.h", Sim/inc is searched first.
+ *  Qualifiers, the DSP intrinsics in plain C, NVIC calls into the sim, DWT with the
+ *  counter of the sim. Only what the firmware of the sim build uses.
+ */
+
+#ifndef SIM_INC_CORE_CM4_H_
+#define SIM_INC_CORE_CM4_H_
+
+#include <stdint.h>
+
+#define __I										volatile const
+#define __O										volatile
+#define __IO									volatile
+#define __IM									volatile const
+#define __OM									volatile
+#define __IOM									volatile
+
+#define __ASM									__asm__
+#define __INLINE							inline
+#define __STATIC_INLINE				static inline
+#define __packed																										// armcc keyword, the sim types are naturally aligned
+#define __FPU_USED						1U
+
+/****************************************************************************************
+*  DWT cycle counter and debug unit, DWT reads go through the sim (simdev.c)
+*****************************************************************************************/
+typedef
+	struct{
+		__IOM uint32_t CTRL;
+		__IOM uint32_t CYCCNT;
+} DWT_Type;
+
+typedef
+	struct{
+		__IOM uint32_t DHCSR;
+		__OM  uint32_t DCRSR;
+		__IOM uint32_t DCRDR;
+		__IOM uint32_t DEMCR;
+} CoreDebug_Type;
+
+#define DWT_CTRL_CYCCNTENA_Msk				(1UL << 0)
+#define CoreDebug_DEMCR_TRCENA_Msk		(1UL << 24)
+
+extern DWT_Type* simDwtAccess(void);
+extern CoreDebug_Type simCoreDebug;
+
+#define DWT										(simDwtAccess())
+#define CoreDebug							(&simCoreDebug)
+
+/****************************************************************************************
+*  NVIC: the sim keeps the enable bits, a handler runs only while its line is enabled
+*  int32_t for IRQn_Type, arm_math.h includes this header without the device header
+*****************************************************************************************/
+extern void NVIC_SetPriority(int32_t IRQn, uint32_t priority);
+extern void NVIC_EnableIRQ(int32_t IRQn);
+extern void NVIC_DisableIRQ(int32_t IRQn);
+
+/****************************************************************************************
+*  The sim calls the handlers from its own loop, nothing preempts the firmware
+*****************************************************************************************/
+__STATIC_INLINE void __disable_irq(void) {}
+__STATIC_INLINE void __enable_irq(void) {}
+__STATIC_INLINE void __NOP(void) {}
+__STATIC_INLINE void __DMB(void) { __atomic_thread_fence(__ATOMIC_SEQ_CST); }
+__STATIC_INLINE void __DSB(void) { __atomic_thread_fence(__ATOMIC_SEQ_CST); }
+__STATIC_INLINE void __ISB(void) { __atomic_thread_fence(__ATOMIC_SEQ_CST); }
+
+/****************************************************************************************
+*  Cortex-M4 DSP instructions
+*****************************************************************************************/
+__STATIC_INLINE int32_t simSat(int64_t x, uint32_t bits)
+{
+	int64_t max = ((int64_t)1 << (bits - 1)) - 1;
+
+	if(x > max) { return (int32_t)max; }
+	if(x < -max - 1) { return (int32_t)(-max - 1); }
+	return (int32_t)x;
+}
+
+__STATIC_INLINE int32_t simLane(uint32_t x, uint32_t lane)
+{
+	return (int16_t)(x >> (16 * lane));
+}
+
+__STATIC_INLINE uint32_t simPack(int32_t lo, int32_t hi)
+{
+	return ((uint32_t)lo & 0xFFFFU) | ((uint32_t)hi << 16);
+}
+
+__STATIC_INLINE uint8_t __CLZ(uint32_t x) { return (x == 0) ? 32 : (uint8_t)__builtin_clz(x); }
+__STATIC_INLINE int32_t __SSAT(int32_t x, uint32_t bits) { return simSat(x, bits); }
+__STATIC_INLINE uint32_t __USAT(int32_t x, uint32_t bits)
+{
+	if(x < 0) { return 0; }
+	return ((uint32_t)x > (1UL << bits) - 1) ? (1UL << bits) - 1 : (uint32_t)x;
+}
+__STATIC_INLINE int32_t __QADD(int32_t a, int32_t b) { return simSat((int64_t)a + b, 32); }
+__STATIC_INLINE int32_t __QSUB(int32_t a, int32_t b) { return simSat((int64_t)a - b, 32); }
+
+__STATIC_INLINE uint32_t __UADD16(uint32_t a, uint32_t b)
+{
+	return ((a + b) & 0xFFFFU) | (((a >> 16) + (b >> 16)) << 16);
+}
+__STATIC_INLINE uint32_t __QADD16(uint32_t a, uint32_t b)
+{
+	return simPack(simSat(simLane(a, 0) + simLane(b, 0), 16), simSat(simLane(a, 1) + simLane(b, 1), 16));
+}
+__STATIC_INLINE uint32_t __QSUB16(uint32_t a, uint32_t b)
+{
+	return simPack(simSat(simLane(a, 0) - simLane(b, 0), 16), simSat(simLane(a, 1) - simLane(b, 1), 16));
+}
+__STATIC_INLINE uint32_t __SHADD16(uint32_t a, uint32_t b)
+{
+	return simPack((simLane(a, 0) + simLane(b, 0)) >> 1, (simLane(a, 1) + simLane(b, 1)) >> 1);
+}
+__STATIC_INLINE uint32_t __SHSUB16(uint32_t a, uint32_t b)
+{
+	return simPack((simLane(a, 0) - simLane(b, 0)) >> 1, (simLane(a, 1) - simLane(b, 1)) >> 1);
+}
+__STATIC_INLINE uint32_t __QASX(uint32_t a, uint32_t b)
+{
+	return simPack(simSat(simLane(a, 0) - simLane(b, 1), 16), simSat(simLane(a, 1) + simLane(b, 0), 16));
+}
+__STATIC_INLINE uint32_t __QSAX(uint32_t a, uint32_t b)
+{
+	return simPack(simSat(simLane(a, 0) + simLane(b, 1), 16), simSat(simLane(a, 1) - simLane(b, 0), 16));
+}
+__STATIC_INLINE uint32_t __SHASX(uint32_t a, uint32_t b)
+{
+	return simPack((simLane(a, 0) - simLane(b, 1)) >> 1, (simLane(a, 1) + simLane(b, 0)) >> 1);
+}
+__STATIC_INLINE uint32_t __SHSAX(uint32_t a, uint32_t b)
+{
+	return simPack((simLane(a, 0) + simLane(b, 1)) >> 1, (simLane(a, 1) - simLane(b, 0)) >> 1);
+}
+__STATIC_INLINE uint32_t __QADD8(uint32_t a, uint32_t b)
+{
+	uint32_t r = 0;
+	uint32_t k;
+
+	for(k = 0; k < 4; k++){
+		r |= ((uint32_t)simSat((int8_t)(a >> (8 * k)) + (int8_t)(b >> (8 * k)), 8) & 0xFFU) << (8 * k);
+	}
+	return r;
+}
+__STATIC_INLINE uint32_t __QSUB8(uint32_t a, uint32_t b)
+{
+	uint32_t r = 0;
+	uint32_t k;
+
+	for(k = 0; k < 4; k++){
+		r |= ((uint32_t)simSat((int8_t)(a >> (8 * k)) - (int8_t)(b >> (8 * k)), 8) & 0xFFU) << (8 * k);
+	}
+	return r;
+}
+#define __PKHBT(a, b, s)			((((uint32_t)(a)) & 0x0000FFFFU) | ((((uint32_t)(b)) << (s)) & 0xFFFF0000U))
+#define __PKHTB(a, b, s)			((((uint32_t)(a)) & 0xFFFF0000U) | ((((uint32_t)(b)) >> (s)) & 0x0000FFFFU))
+
+__STATIC_INLINE uint32_t __SXTB16(uint32_t x)
+{
+	return simPack((int8_t)x, (int8_t)(x >> 16));
+}
+__STATIC_INLINE uint32_t __SMUAD(uint32_t a, uint32_t b)
+{
+	return (uint32_t)(simLane(a, 0) * simLane(b, 0) + simLane(a, 1) * simLane(b, 1));
+}
+__STATIC_INLINE uint32_t __SMUADX(uint32_t a, uint32_t b)
+{
+	return (uint32_t)(simLane(a, 0) * simLane(b, 1) + simLane(a, 1) * simLane(b, 0));
+}
+__STATIC_INLINE uint32_t __SMUSD(uint32_t a, uint32_t b)
+{
+	return (uint32_t)(simLane(a, 0) * simLane(b, 0) - simLane(a, 1) * simLane(b, 1));
+}
+__STATIC_INLINE uint32_t __SMUSDX(uint32_t a, uint32_t b)
+{
+	return (uint32_t)(simLane(a, 0) * simLane(b, 1) - simLane(a, 1) * simLane(b, 0));
+}
+__STATIC_INLINE uint32_t __SMLAD(uint32_t a, uint32_t b, uint32_t acc)
+{
+	return __SMUAD(a, b) + acc;
+}
+__STATIC_INLINE uint32_t __SMLADX(uint32_t a, uint32_t b, uint32_t acc)
+{
+	return __SMUADX(a, b) + acc;
+}
+__STATIC_INLINE uint32_t __SMLSDX(uint32_t a, uint32_t b, uint32_t acc)
+{
+	return (uint32_t)(simLane(a, 0) * simLane(b, 1) - simLane(a, 1) * simLane(b, 0)) + acc;
+}
+__STATIC_INLINE uint64_t __SMLALD(uint32_t a, uint32_t b, uint64_t acc)
+{
+	return (uint64_t)((int64_t)acc + (int64_t)simLane(a, 0) * simLane(b, 0) + (int64_t)simLane(a, 1) * simLane(b, 1));
+}
+__STATIC_INLINE uint64_t __SMLALDX(uint32_t a, uint32_t b, uint64_t acc)
+{
+	return (uint64_t)((int64_t)acc + (int64_t)simLane(a, 0) * simLane(b, 1) + (int64_t)simLane(a, 1) * simLane(b, 0));
+}
+__STATIC_INLINE int32_t __SMMLA(int32_t a, int32_t b, int32_t acc)
+{
+	return (int32_t)((((int64_t)acc << 32) + (int64_t)a * b) >> 32);
+}
+
+#endif /* SIM_INC_CORE_CM4_H_ */
@@ -0,0 +1,37 @@
+/*
+ * ivcsv.h
+ *
+ *  Created on: 17 OCT. 2026
+ *  The pages of TYPE_IV_CURVE back to the I-V curve, written as CSV
+ *
+ *  Each reply of the board is one page of IV_CURVE_PAGE_POINTS points (loadIvCurve), the
+ *  next request the next page, page 0 after the last one. ivCsvAddPage puts the points of
+ *  a page at their place in the curve; the curve is complete once every page up to the
+ *  points of the last reply came.
+ */
+
+#ifndef SIM_INC_IVCSV_H_
+#define SIM_INC_IVCSV_H_
+
+#include <stdio.h>
+#include <stdint.h>
+#include "protocol.h"
+#include "ivtrace.h"
+
+#define IVCSV_PAGES						((IVTRACE_POINTS + IV_CURVE_PAGE_POINTS - 1) / IV_CURVE_PAGE_POINTS)
+
+typedef
+	struct{
+		uint16_t points;																									// of the last page
+		uint16_t state;																										// ivTraceState_ent of the last page
+		uint8_t pageSeen[IVCSV_PAGES];
+		float vIn[IVTRACE_POINTS];																				// V
+		float iIn[IVTRACE_POINTS];																				// A
+} ivCsv_t;
+
+extern void ivCsvInit(ivCsv_t* pCurve);
+extern int ivCsvAddPage(ivCsv_t* pCurve, const ivCurve_t* pPage);							// -1 - page or points out of range
+extern int ivCsvComplete(const ivCsv_t* pCurve);
+extern int ivCsvWrite(const ivCsv_t* pCurve, FILE* pFile);										// point, duty, Vin, Iin, Pin; -1 - not complete
+
+#endif /* SIM_INC_IVCSV_H_ */
@@ -0,0 +1,37 @@
+/*
+ * msp.h
+ *
+ *  Created on: 17 OCT. 2026
+ *  The tracker of the MSP430 code against the sim
+ *
+ *  MSP430/mppt.c, meas.c and pwm.c of the board, the config, temperature and IO they use
+ *  stubbed. MEAS_update runs once per PWM period after the handlers, as DCDC_Loop does in
+ *  the sim, mspTick every PWM_PERIOD_US as CTRL_tick from TIM3. mspTick is the Voc sample
+ *  and tracker part of CTRL_tick: the open circuit sample every 10 s with MPPT_MODE_FOCV,
+ *  one sample and MPPT_tick after it with the tracking modes.
+ */
+
+#ifndef SIM_INC_MSP_H_
+#define SIM_INC_MSP_H_
+
+#include <stdint.h>
+
+typedef
+	struct{
+		double ePv;																												// J, out of the string
+		double eMpp;																											// J, at the maximum of the present curve
+		float pMpp;																												// W, maximum of the present curve
+		float vMpp;
+		uint32_t ticks;																										// mspTick calls
+		uint32_t samples;																									// open circuit samples
+} msp_t;
+
+extern msp_t msp;
+
+extern void mspInit(int mode, float scanInterval, float scanDuration);					// after simInit, the string at open circuit
+extern void mspIrradiance(uint8_t group, float gain);													// plantSetIrradiance and the new maximum
+extern void mspRun(double seconds);
+extern void mspTick(void);
+extern float mspEfficiency(void);																				// ePv / eMpp since mspInit
+
+#endif /* SIM_INC_MSP_H_ */
@@ -0,0 +1,76 @@
+/*
+ * plant.h
+ *
+ *  Created on: 17 OCT. 2026
+ *  Averaged model of the buck stage for the host simulation
+ *
+ *  PV string (single diode, bypass diode groups), input capacitor, one inductor per
+ *  phase, output capacitor, battery and resistive load. One plantStep per PWM period,
+ *  PLANT_SUBSTEPS Euler steps of the period averages inside.
+ */
+
+#ifndef SIM_INC_PLANT_H_
+#define SIM_INC_PLANT_H_
+
+#include <stdint.h>
+
+#define PLANT_SUBSTEPS				4
+#define PLANT_PHASES_MAX			4
+#define PLANT_PV_GROUPS_MAX		8																	// bypass diode groups of the string
+#define PLANT_PV_TABLE				1024															// I(V) points of a string with several groups
+#define PLANT_TDTG						6.944e-9f													// s, dead time count of the HRTIM
+
+typedef
+	struct{
+		float pvIsc;																											// A, string at full irradiance
+		float pvVoc;																											// V
+		float pvVt;																												// V, n * k * T / q of the cells in series
+		uint8_t pvGroups;																									// 1 - one curve, else bypass diodes split the string
+		float pvVbypass;																									// V, forward drop of a bypass diode
+		float cIn;																												// F
+		uint8_t phases;
+		float l;																													// H, each phase
+		float rL[PLANT_PHASES_MAX];																				// Ohm, each phase, unbalance between them
+		float vDiode;																											// V, body diode in the dead time
+		float eSw;																												// J per pulse and phase
+		float cOut;																												// F
+		float vBat;																												// V, open circuit
+		float rBat;																												// Ohm, 0 - no battery
+		float rLoad;																											// Ohm, 0 - no load
+		float dtLossK;																										// synthetic dead time loss per count^2, ratio of Pout
+		float dtRiseOpt;																									// counts, best rising dead time
+		float dtFallOpt;																									// counts, best falling dead time at 0 A
+		float dtFallSlope;																								// counts per A of the output current
+} plantParam_t;
+
+typedef
+	struct{
+		plantParam_t p;
+		float pvGain[PLANT_PV_GROUPS_MAX];																// irradiance of each group, 1.0 full
+		float pvI0;																												// A, diode saturation current of the string
+		float pvTable[PLANT_PV_TABLE];																		// A at k * pvTableStep, pvGroups > 1
+		float pvTableStep;																								// V
+		float vIn;																												// V, input capacitor
+		float vOut;																												// V, output capacitor
+		float iL[PLANT_PHASES_MAX];																				// A
+		/* averages of the last period */
+		float avgVin;
+		float avgIin;																											// A, PV current, the input sensor is on the string side
+		float avgVout;
+		float avgIout;																										// A, sum of the phases
+		float avgIL[PLANT_PHASES_MAX];
+		float pIn;																												// W, into the converter
+		float pOut;																												// W, out of the inductors
+		/* energy since plantInit */
+		double ePv;																												// J
+		double eOut;
+} plant_t;
+
+extern void plantDefault(plantParam_t* pParam);
+extern void plantInit(plant_t* pPlant, const plantParam_t* pParam);
+extern void plantSetIrradiance(plant_t* pPlant, uint8_t group, float gain);		// group >= pvGroups - every group
+extern float plantPvCurrent(const plant_t* pPlant, float vIn);
+extern float plantPvMpp(const plant_t* pPlant, float* pVmp);									// W, maximum of the present curve
+extern void plantStep(plant_t* pPlant, float period, const float* pDuty, uint32_t pulses, float dtRise, float dtFall);
+
+#endif /* SIM_INC_PLANT_H_ */
@@ -0,0 +1,81 @@
+/*
+ * sim.h
+ *
+ *  Created on: 17 OCT. 2026
+ *  Host simulation of the DC/DC firmware: peripherals in RAM and the plant model
+ *
+ *  simPeriod() is one PWM period of the board: the plant runs with the duty, dead times and
+ *  outputs latched at the period start, the ADC converts at the trigger and the handlers of
+ *  the firmware are called in the order of their interrupts. The thread (DCDC_Loop) runs
+ *  once per period unless sim.thread is 0.
+ */
+
+#ifndef SIM_INC_SIM_H_
+#define SIM_INC_SIM_H_
+
+#include <stdint.h>
+#include "stm32f3xx.h"
+#include "plant.h"
+
+#define SIM_HRTIM_HZ					1.152e9f														// HRTIM counts per second, 16 per CPU cycle
+#define SIM_JEOS_COUNTS				1280U																// trigger to JEOS: two conversions of 20 ADC clocks at 36 MHz
+#define SIM_IRQ_NUM						96
+
+typedef enum{
+	SIM_ISR_ADC = 0,																										// ADC1_2_IRQHandler
+	SIM_ISR_DMA,																												// DMA1_Channel1_IRQHandler
+	SIM_ISR_HRTIM,																											// HRTIM1_TIMA_IRQHandler
+	SIM_ISR_EXTI0,																											// EXTI0_IRQHandler
+	SIM_ISR_NUM
+} simIsr_ent;
+
+typedef
+	struct{
+		plant_t plant;
+		uint64_t periods;																									// PWM periods since simInit
+		double time;																											// s
+		uint16_t noise;																										// codes, +/- uniform noise of every conversion
+		uint32_t noiseSeed;
+		uint8_t thread;																										// 1 - DCDC_Loop(0) after every period
+		uint32_t ctrlCounts;																							// HRTIM counts added to the JEOS latency
+		uint32_t outputs;																									// OENR / ODISR state, Tx1 Tx2 bits
+		uint32_t burstCount;																							// burst mode counter, BMCLK Timer A period
+		uint32_t dmaReload;																								// CNDTR of the DMA at its enable
+		uint32_t adcIrqs;																									// ADC1_2_IRQHandler calls
+		uint32_t dmaIrqs;																									// DMA1_Channel1_IRQHandler calls
+		uint32_t dmaWords;																								// words written by the DMA
+		float duty[PLANT_PHASES_MAX];																			// ratio of the last period
+		uint32_t pulses;																									// phases that switched in the last period
+		void (*pHook)(void);																							// called after the handlers of every period
+		void (*pStep)(float period);																			// replaces plantStep, e.g. a replay of recorded averages
+		uint8_t isrTiming;																								// 1 - host time of every handler call in isrNs
+		double isrNs[SIM_ISR_NUM];
+		double isrLastNs[SIM_ISR_NUM];																		// the last timed call
+		uint32_t isrCalls[SIM_ISR_NUM];																		// timed calls
+} sim_t;
+
+extern sim_t sim;
+extern uint8_t simNvicEnabled[SIM_IRQ_NUM];
+extern uint32_t simDwtStep;																						// CYCCNT advance per DWT access
+
+/* firmware handlers called by the sim */
+extern void ADC1_2_IRQHandler(void);
+extern void DMA1_Channel1_IRQHandler(void);
+extern void HRTIM1_TIMA_IRQHandler(void);
+extern void EXTI0_IRQHandler(void);
+
+/* simdev.c */
+extern void simDevReset(void);
+extern void simAdcCommit(uint8_t adc);
+extern void simAdcSetFlags(uint8_t adc, uint32_t flags);
+extern uint32_t simAdcFlags(uint8_t adc);
+extern ADC_TypeDef* simAdcRegs(uint8_t adc);															// no commit, for the conversions of the sim
+
+/* sim.c */
+extern void simInit(const plantParam_t* pParam);
+extern void simPeriod(void);
+extern void simRun(uint32_t periods);
+extern void simStart(float vIn, float vOutLimit, float iOutLimit);							// limits, Vin target and DCDC_Start_Stop(1)
+extern uint16_t simCode(uint8_t adc, uint8_t channel);
+
+#endif /* SIM_INC_SIM_H_ */
@@ -0,0 +1,69 @@
+/*
+ * stm32f3xx.h
+ *
+ *  Created on: 17 OCT. 2026
+ *  Host stand-in of the device header for the simulation
+ *
+ *  The register layout and the bits are the ones of stm32f334x8.h, the peripherals
+ *  are instances in host RAM (simdev.c). ADC1 and ADC2 are reached through an access
+ *  function: their ISR flags are cleared by writing 1 and ADCAL, ADSTP, JADSTP are
+ *  cleared by the hardware, the sim applies that before every access. The other
+ *  peripherals are plain RAM, the sim takes their writes after each handler.
+ */
+
+#ifndef SIM_INC_STM32F3XX_H_
+#define SIM_INC_STM32F3XX_H_
+
+#include "stm32f334x8.h"
+
+#undef HRTIM1
+#undef ADC1
+#undef ADC2
+#undef ADC12_COMMON
+#undef DMA1
+#undef DMA1_Channel1
+#undef DMA1_Channel7
+#undef RCC
+#undef FLASH
+#undef GPIOA
+#undef GPIOB
+#undef GPIOC
+#undef GPIOD
+#undef EXTI
+#undef COMP2
+#undef DAC2
+#undef USART1
+
+extern HRTIM_TypeDef simHrtim1;
+extern ADC_Common_TypeDef simAdc12Common;
+extern DMA_TypeDef simDma1;
+extern DMA_Channel_TypeDef simDma1Channel[7];
+extern RCC_TypeDef simRcc;
+extern FLASH_TypeDef simFlash;
+extern GPIO_TypeDef simGpio[4];
+extern EXTI_TypeDef simExti;
+extern COMP_TypeDef simComp2;
+extern DAC_TypeDef simDac2;
+extern USART_TypeDef simUsart1;
+
+extern ADC_TypeDef* simAdcAccess(uint8_t adc);															// 0 - ADC1, 1 - ADC2
+
+#define HRTIM1								(&simHrtim1)
+#define ADC1									(simAdcAccess(0))
+#define ADC2									(simAdcAccess(1))
+#define ADC12_COMMON					(&simAdc12Common)
+#define DMA1									(&simDma1)
+#define DMA1_Channel1					(&simDma1Channel[0])
+#define DMA1_Channel7					(&simDma1Channel[6])
+#define RCC										(&simRcc)
+#define FLASH									(&simFlash)
+#define GPIOA									(&simGpio[0])
+#define GPIOB									(&simGpio[1])
+#define GPIOC									(&simGpio[2])
+#define GPIOD									(&simGpio[3])
+#define EXTI									(&simExti)
+#define COMP2									(&simComp2)
+#define DAC2									(&simDac2)
+#define USART1								(&simUsart1)
+
+#endif /* SIM_INC_STM32F3XX_H_ */
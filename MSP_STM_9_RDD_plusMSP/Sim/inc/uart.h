@@ -0,0 +1,25 @@
+/*
+ * uart.h
+ *
+ *  Created on: 17 OCT. 2026
+ *  The USART1 protocol of the MSP430 code against the sim
+ *
+ *  MSP430/usci.c and crc16.c of the board, the flash, LCD and clock parts they call
+ *  stubbed. The host end of the link: a packet is framed as uart_send does it (DLE STX,
+ *  length, DLE stuffed identifier and data, CRC16, DLE ETX), fed byte by byte through the
+ *  receive interrupt of USART1_IRQHandler and handled by uart_receive as the main loop of
+ *  the board does; the reply is clocked out through the transmit interrupt and decoded.
+ */
+
+#ifndef SIM_INC_UART_H_
+#define SIM_INC_UART_H_
+
+#include <stdint.h>
+#include "protocol.h"
+
+extern void uartInit(void);																								// uart_init, the startup response read and dropped
+extern int uartCommand(uint16_t code, uint16_t arg, command_t* pResponse);			// 0 - a TYPE_COMMAND response came
+extern int uartRequest(uint8_t type, uint8_t version, void* pData, uint16_t size);	// 0 - a reply of type, version and size came
+extern int uartDecode(const uint8_t* pPacket, uint16_t len, packetIdentifier_t* pId, void* pData, uint16_t size);	// 0 - framing and CRC good
+
+#endif /* SIM_INC_UART_H_ */
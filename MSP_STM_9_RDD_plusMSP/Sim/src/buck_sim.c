@@ -0,0 +1,59 @@
+/*
+ * buck_sim.c
+ *
+ *  Created on: 17 OCT. 2026
+ *  Closed loop run of the firmware on the plant model and the speed of the simulation
+ *
+ *  Starts the DC/DC at a Vin setpoint below the MPP, steps the setpoint, checks that the
+ *  Vin loop holds both, then times a long run. Fails below SIM_PERIODS_PER_S_MIN.
+ */
+
+#include <stdio.h>
+#include <math.h>
+#include <time.h>
+#include "sim.h"
+#include "dcdc.h"
+
+#define SIM_PERIODS_PER_S_MIN	1.0e6
+#define SIM_SPEED_PERIODS			2000000U
+#define SIM_VIN_TOL						2.0f																// V, work cycle average against the setpoint
+
+static int checkVin(float target){
+	float vIn = calculatedValue.vInSensor;
+
+	printf("Vin %.1f V (target %.1f), Vout %.1f V, Iout %.1f A, Pin %.0f W, loop %u, fault %u\n",
+				 vIn, target, calculatedValue.vOutSensor, calculatedValue.iOutSensor, sim.plant.pIn,
+				 DCDC_getActiveLoop(), DCDC_getFault());
+	return (fabsf(vIn - target) <= SIM_VIN_TOL) && (DCDC_getFault() == DCDC_FAULT_NONE);
+}
+
+int main(void){
+	plantParam_t param;
+	struct timespec t0, t1;
+	double seconds, rate;
+	int ok = 1;
+
+	plantDefault(&param);
+	simInit(&param);
+	simRun(2000);																															// first work cycles, the code scales
+
+	simStart(240.0f, 150.0f, 80.0f);
+	simRun(20000);																														// 1 s
+	ok &= checkVin(240.0f);
+
+	setVin(225.0f);
+	simRun(20000);
+	ok &= checkVin(225.0f);
+
+	clock_gettime(CLOCK_MONOTONIC, &t0);
+	simRun(SIM_SPEED_PERIODS);
+	clock_gettime(CLOCK_MONOTONIC, &t1);
+	seconds = (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) * 1e-9;
+	rate = SIM_SPEED_PERIODS / seconds;
+	printf("%u periods in %.3f s: %.2f M periods/s\n", SIM_SPEED_PERIODS, seconds, rate * 1e-6);
+	ok &= checkVin(225.0f);
+	ok &= (rate >= SIM_PERIODS_PER_S_MIN);
+
+	printf("%s\n", ok ? "PASS" : "FAIL");
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,156 @@
+/*
+ * burst_sweep.c
+ *
+ *  Created on: 17 OCT. 2026
+ *  Hysteresis of the light load burst mode and its loss against continuous switching
+ *
+ *  Sweep: the irradiance ramps the output current down through the enter threshold and back
+ *  up through the exit threshold, for several pairs of DCDC_setBurstThresholds. Burst mode
+ *  must start once on the way down, below the enter current, and end once on the way up,
+ *  above the exit current (BURST_I_TOL, the work cycle average against the plant average).
+ *  Loss: fixed light loads with burst mode and with it kept off (enter threshold 0). The
+ *  estimate counts eSw per pulse, the burst idle periods have none, and rL * iL^2 of the
+ *  period average inductor current, higher in the pulses of the burst; efficiency is the PV
+ *  energy less both over the PV energy. The plant energies are not used: the Euler steps of
+ *  the averaged inductor are not exact for the pulses of a burst that start from 0 A.
+ */
+
+#include <stdio.h>
+#include <math.h>
+#include "sim.h"
+#include "dcdc.h"
+
+#define BURST_VIN							200.0f															// V, below Voc of the low end
+#define BURST_VBAT						100.0f															// V, Vout / DUTY_MAX below BURST_VIN
+#define BURST_G_LOW						0.003f															// of 1000 W/m^2, ends of the sweep
+#define BURST_G_HIGH					0.1f
+#define BURST_SWEEP_PERIODS		200000U															// each way, 10 s
+#define BURST_I_FILTER				0.002f															// per period, about 25 ms
+#define BURST_I_TOL						0.2f																// A
+#define BURST_LOSS_PERIODS		40000U															// 2 s
+#define BURST_SETTLE_PERIODS	20000U
+
+typedef
+	struct{
+		float iEnter;
+		float iExit;
+} thresholds_t;
+
+static const thresholds_t thresholds[] = {
+	{ DCDC_BURST_ENTER_IOUT, DCDC_BURST_EXIT_IOUT },
+	{ 0.5f, 1.0f },
+	{ 1.5f, 3.0f },
+};
+
+static const float lossGains[] = { 0.01f, 0.015f, 0.02f };										// light load points of the loss estimate
+
+static float iOutFilt;
+static double ePv, eLoss;																							// J, PV energy and the estimated loss
+
+static void periodHook(void){
+	static double last;
+	double dt = sim.time - last;
+	uint8_t k;
+
+	last = sim.time;
+	iOutFilt += BURST_I_FILTER * (sim.plant.avgIout - iOutFilt);
+	if(dt <= 0.0 || dt > 1.0e-3) { return; }																						// the first period of a run
+	ePv += sim.plant.avgVin * sim.plant.avgIin * dt;
+	for(k = 0; k < sim.plant.p.phases; k++){
+		float iL = sim.plant.avgIL[k];
+		if(sim.pulses & (1UL << k)) { eLoss += sim.plant.p.eSw; }
+		eLoss += sim.plant.p.rL[k] * iL * iL * dt;
+	}
+}
+
+static void startLightLoad(float gain){
+	plantParam_t param;
+
+	plantDefault(&param);
+	param.vBat = BURST_VBAT;
+	simInit(&param);
+	sim.pHook = periodHook;
+	plantSetIrradiance(&sim.plant, PLANT_PV_GROUPS_MAX, BURST_G_HIGH);
+	simRun(2000);
+	simStart(BURST_VIN, 150.0f, 80.0f);
+	simRun(BURST_SETTLE_PERIODS);
+	plantSetIrradiance(&sim.plant, PLANT_PV_GROUPS_MAX, gain);
+}
+
+/******************************************************************************************
+*  One ramp of the irradiance, the filtered output current at every change of burst mode
+*******************************************************************************************/
+static uint32_t ramp(float from, float to, float* pIAt, uint8_t* pBurst){
+	uint32_t changes = 0;
+	uint8_t burst = DCDC_isBurstMode();
+	uint32_t n;
+
+	for(n = 1; n <= BURST_SWEEP_PERIODS; n++){
+		plantSetIrradiance(&sim.plant, PLANT_PV_GROUPS_MAX, from + (to - from) * n / BURST_SWEEP_PERIODS);
+		simPeriod();
+		if(DCDC_isBurstMode() != burst)
+		{
+			burst = DCDC_isBurstMode();
+			*pIAt = iOutFilt;
+			changes++;
+		}
+	}
+	*pBurst = burst;
+	return changes;
+}
+
+static int testSweep(const thresholds_t* pT){
+	float iEnter = 0.0f, iExit = 0.0f;
+	uint32_t downChanges, upChanges;
+	uint8_t downBurst, upBurst;
+	int ok;
+
+	startLightLoad(BURST_G_HIGH);
+	if(DCDC_setBurstThresholds(pT->iEnter, pT->iExit) != 0) { return 0; }
+	downChanges = ramp(BURST_G_HIGH, BURST_G_LOW, &iEnter, &downBurst);
+	upChanges = ramp(BURST_G_LOW, BURST_G_HIGH, &iExit, &upBurst);
+
+	ok = (downChanges == 1) && downBurst && (iEnter < pT->iEnter + BURST_I_TOL);
+	ok &= (upChanges == 1) && !upBurst && (iExit > pT->iExit - BURST_I_TOL);
+	ok &= (DCDC_getFault() == DCDC_FAULT_NONE);
+	printf("thresholds %.1f / %.1f A: burst from %.2f A (%u changes), every period from %.2f A (%u changes) %s\n",
+				 pT->iEnter, pT->iExit, iEnter, downChanges, iExit, upChanges, ok ? "" : "FAIL");
+	return ok;
+}
+
+/******************************************************************************************
+*  Estimated efficiency at one light load, burst mode allowed or not
+*******************************************************************************************/
+static float lightLoadEfficiency(float gain, uint8_t burst, float* pIout){
+	startLightLoad(gain);
+	DCDC_setBurstThresholds(burst ? DCDC_BURST_ENTER_IOUT : 0.0f, DCDC_BURST_EXIT_IOUT);				// iOut < 0 never
+	simRun(BURST_SETTLE_PERIODS);
+	ePv = 0.0;
+	eLoss = 0.0;
+	simRun(BURST_LOSS_PERIODS);
+	*pIout = iOutFilt;
+	if((DCDC_isBurstMode() != burst) || (DCDC_getFault() != DCDC_FAULT_NONE) || (ePv <= 0.0)) { return 0.0f; }
+	return (float)((ePv - eLoss) / ePv);
+}
+
+int main(void){
+	uint16_t k;
+	int ok = 1;
+
+	ok &= (DCDC_setBurstThresholds(2.0f, 1.0f) != 0) && (DCDC_setBurstThresholds(-1.0f, 1.0f) != 0);
+	for(k = 0; k < sizeof(thresholds) / sizeof(thresholds[0]); k++){
+		ok &= testSweep(&thresholds[k]);
+	}
+
+	for(k = 0; k < sizeof(lossGains) / sizeof(lossGains[0]); k++){
+		float iCont, iBurst;
+		float effCont = lightLoadEfficiency(lossGains[k], 0, &iCont);
+		float effBurst = lightLoadEfficiency(lossGains[k], 1, &iBurst);
+		printf("%.2f A out: efficiency %.1f%% switching every period, %.1f%% in burst mode\n",
+					 iCont, effCont * 100.0f, effBurst * 100.0f);
+		ok &= (effBurst > effCont) && (effCont > 0.0f);
+	}
+
+	printf("%s\n", ok ? "PASS" : "FAIL");
+	return ok ? 0 : 1;
+}
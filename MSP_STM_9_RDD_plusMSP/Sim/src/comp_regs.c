@@ -0,0 +1,118 @@
+/*
+ * comp_regs.c
+ *
+ *  Created on: 17 OCT. 2026
+ *  Registers of the cycle-by-cycle current limit: COMP2, DAC2 and HRTIM EEV1
+ *
+ *  Built with HRTIM_CURR_LIMIT_EEV 1. After DCDC_Init the register model must hold the
+ *  path comp.c and initHighResolutionTimer describe:
+ *  - COMP2 enabled, inverting input DAC2_CH1, PA7 analog, no inversion, no output select
+ *    and no blanking of its own; DAC2 channel 1 enabled with no trigger and no pin,
+ *    DHR12R1 the ADC code of DCDC_CYCLE_CURR_LIMIT;
+ *  - EECR1: EEV1 from source 2 (COMP2), active high, level sensitive, not fast, so the
+ *    filter of the timers applies;
+ *  - every phase: EEFxR1 blanking from the period start to CMP3, CMP3 past the longest
+ *    rising dead time and before the shortest pulse ends, not latched; Tx1 reset on CMP1
+ *    or EEV1 and never set by EEV1, CPT1 captures EEV1.
+ *  In the closed loop the DAC code must follow the current scale of the slow path and
+ *  DCDC_setCycleCurrLimit, a CPT1 flag must count one limit event and be cleared.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "sim.h"
+#include "dcdc.h"
+#include "adc.h"
+#include "comp.h"
+#include "deadtime.h"
+
+#define COMP_REGS_AMPS_TO_CODE	(4096.0f / (REFERENCE_VOLTAGE * 50 * I_CONVERCE_COEFF))	// the sensor of the sim
+#define COMP_REGS_CODE_TOL		2																		// DAC codes, the Vref correction of the scale
+#define COMP_REGS_LIMIT				40.0f																// A, DCDC_setCycleCurrLimit
+#define COMP_REGS_HRCK_PER_DTG	8U																		// HRTIM counts per Tdtg, DTPRSC 3
+#define COMP2_INSEL_DAC2_CH1	(COMP2_CSR_COMP2INSEL_2 | COMP2_CSR_COMP2INSEL_1 | COMP2_CSR_COMP2INSEL_0)
+#define EEV_SRC2							1U
+#define EEV_FLTR_CMP3					3U																		// blanking from the reset / roll-over to CMP3
+
+typedef char compRegsCheck_t[HRTIM_CURR_LIMIT_EEV ? 1 : -1];
+
+static uint32_t fails;
+
+static void check(int good, const char* pWhat){
+	if(good) { return; }
+	printf("wrong: %s\n", pWhat);
+	fails++;
+}
+
+static int dacMatches(float amps){
+	int code = (int)simDac2.DHR12R1;
+	int want = (int)(ZERO_CURR_CODE + amps * COMP_REGS_AMPS_TO_CODE);
+
+	if(want > (int)COMP_DAC_MAX) { want = COMP_DAC_MAX; }
+	printf("%.0f A: DAC2 code %d, the ADC code of the current %d\n", amps, code, want);
+	return abs(code - want) <= COMP_REGS_CODE_TOL;
+}
+
+int main(void){
+	plantParam_t param;
+	uint32_t eecr1, events;
+	uint8_t k;
+	int ok;
+
+	plantDefault(&param);
+	simInit(&param);
+
+	/* COMP2 and DAC2 */
+	check((simRcc.APB1ENR & RCC_APB1ENR_DAC2EN) && (simRcc.APB2ENR & RCC_APB2ENR_SYSCFGEN), "DAC2 / SYSCFG clock");
+	check(((simGpio[0].MODER & GPIO_MODER_MODER7_Msk) >> GPIO_MODER_MODER7_Pos) == 3U, "PA7 analog");
+	check((simComp2.CSR & COMP2_CSR_COMP2EN) != 0, "COMP2 enabled");
+	check((simComp2.CSR & COMP2_CSR_COMP2INSEL) == COMP2_INSEL_DAC2_CH1, "COMP2 inverting input DAC2_CH1");
+	check((simComp2.CSR & (COMP2_CSR_COMP2POL | COMP2_CSR_COMP2OUTSEL | COMP2_CSR_COMP2BLANKING)) == 0, "COMP2 polarity, output select, blanking");
+	check(simDac2.CR == DAC_CR_EN1, "DAC2 channel 1 alone, no trigger, no pin");
+
+	/* EEV1 */
+	eecr1 = simHrtim1.sCommonRegs.EECR1;
+	check(((eecr1 & HRTIM_EECR1_EE1SRC) >> HRTIM_EECR1_EE1SRC_Pos) == EEV_SRC2, "EEV1 source COMP2");
+	check((eecr1 & HRTIM_EECR1_EE1POL) == 0, "EEV1 active high");
+	check((eecr1 & HRTIM_EECR1_EE1SNS) == 0, "EEV1 level sensitive");
+	check((eecr1 & HRTIM_EECR1_EE1FAST) == 0, "EEV1 not fast, filtered");
+
+	/* routing and blanking of every phase */
+	for(k = 0; k < HRTIM_PHASES; k++){
+		HRTIM_Timerx_TypeDef* pTim = &simHrtim1.sTimerxRegs[TIM_A + k];
+		check(((pTim->EEFxR1 & HRTIM_EEFR1_EE1FLTR) >> HRTIM_EEFR1_EE1FLTR_Pos) == EEV_FLTR_CMP3, "EEFxR1 blanking to CMP3");
+		check((pTim->EEFxR1 & HRTIM_EEFR1_EE1LTCH) == 0, "EEFxR1 not latched");
+		check(pTim->CMP3xR == CURR_LIMIT_BLANK, "CMP3 the end of the blanking");
+		check(pTim->RSTx1R == (HRTIM_RST1R_CMP1 | HRTIM_RST1R_EXTVNT1), "Tx1 reset on CMP1 or EEV1");
+		check((pTim->SETx1R & (HRTIM_SET1R_EXTVNT1 | HRTIM_SET1R_EXTVNT2 | HRTIM_SET1R_EXTVNT3)) == 0, "Tx1 not set by an event");
+		check((pTim->RSTx2R == 0) && (pTim->SETx2R == 0) && (pTim->OUTxR & HRTIM_OUTR_DTEN), "Tx2 from the dead time generator");
+	}
+	check(simHrtim1.sTimerxRegs[TIM_A].CPT1xCR == HRTIM_CPT1CR_EXEV1CPT, "CPT1 on EEV1");
+	check(CURR_LIMIT_BLANK > DT_MAX * COMP_REGS_HRCK_PER_DTG, "blanking past the rising dead time");
+	check(CURR_LIMIT_BLANK < DUTY_MIN, "blanking ends before the shortest pulse");
+	printf("blanking %u counts, %.2f us, DT_MAX %u counts, DUTY_MIN %u counts; %u register fields wrong\n",
+				 CURR_LIMIT_BLANK, CURR_LIMIT_BLANK * 1e6f / SIM_HRTIM_HZ, DT_MAX * COMP_REGS_HRCK_PER_DTG, DUTY_MIN, fails);
+	ok = (fails == 0);
+
+	/* the code in the closed loop */
+	simRun(2000);
+	simStart(240.0f, 150.0f, 80.0f);
+	simRun(20000);
+	ok &= dacMatches(DCDC_CYCLE_CURR_LIMIT);
+	ok &= (DCDC_setCycleCurrLimit(COMP_REGS_LIMIT) == 0) && dacMatches(COMP_REGS_LIMIT);
+	ok &= (DCDC_setCycleCurrLimit(1000.0f) == 0) && (simDac2.DHR12R1 == COMP_DAC_MAX);
+	ok &= (DCDC_setCycleCurrLimit(0.0f) != 0) && (simDac2.DHR12R1 == COMP_DAC_MAX);
+	DCDC_setCycleCurrLimit(DCDC_CYCLE_CURR_LIMIT);
+
+	events = DCDC_getCurrLimitEvents();
+	simHrtim1.sTimerxRegs[TIM_A].TIMxISR |= HRTIM_TIMISR_CPT1;												// EEV1 in this period
+	simPeriod();
+	simPeriod();
+	printf("CPT1 of one period: %u limit events, flag %s\n", DCDC_getCurrLimitEvents() - events,
+				 (simHrtim1.sTimerxRegs[TIM_A].TIMxISR & HRTIM_TIMISR_CPT1) ? "set" : "cleared");
+	ok &= (DCDC_getCurrLimitEvents() - events == 1) && !(simHrtim1.sTimerxRegs[TIM_A].TIMxISR & HRTIM_TIMISR_CPT1);
+	ok &= (DCDC_getFault() == DCDC_FAULT_NONE);
+
+	printf("%s\n", ok ? "PASS" : "FAIL");
+	return ok ? 0 : 1;
+}
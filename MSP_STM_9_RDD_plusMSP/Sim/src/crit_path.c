@@ -0,0 +1,111 @@
+/*
+ * crit_path.c
+ *
+ *  Created on: 17 OCT. 2026
+ *  Worst case of the priority 0 control path against the deferred EXTI0 work
+ *
+ *  ADC1_2_IRQHandler (JEOS) reads the injected pairs and writes CMP1/CMP2, EXTI0 averages,
+ *  scales and starts or stops. Every call is timed on the host through a start, setpoint
+ *  and irradiance steps and a light load phase in burst mode. The periods that end a work
+ *  cycle must not cost the control path more than the other periods that start the slow
+ *  sequence (CRIT_PATH_WC_RATIO_MAX): the work cycle belongs to EXTI0. Prints mean, 99.9% and max of both paths; the host
+ *  times only rank the paths, the cycles of the board come from isrprof.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "sim.h"
+#include "dcdc.h"
+
+#define CRIT_PATH_PERIODS			200000U
+#define CRIT_PATH_WC_RATIO_MAX	1.5																	// mean at a work cycle end / mean of the other slow start periods
+#define CRIT_PATH_PREEMPT_NS	5000.0																// longer calls are preemptions of the host, not in the means
+
+extern volatile uint32_t workCycles;
+
+static double* pCritNs;
+static double* pDeferNs;
+static uint32_t critNum, deferNum;
+static double critSum[2];																							// slow start periods: 0 - other, 1 - work cycle end
+static uint32_t critCnt[2];
+
+static void periodHook(void){
+	static uint32_t critCalls, deferCalls, lastCycles, lastWords;
+	uint8_t wcEnd = (workCycles != lastCycles);
+	uint8_t slowStart = (sim.dmaWords != lastWords);
+
+	lastCycles = workCycles;
+	lastWords = sim.dmaWords;
+	if(!sim.isrTiming) { critCalls = sim.isrCalls[SIM_ISR_ADC]; deferCalls = sim.isrCalls[SIM_ISR_EXTI0]; return; }
+	if((sim.isrCalls[SIM_ISR_ADC] != critCalls) && (critNum < CRIT_PATH_PERIODS))
+	{
+		pCritNs[critNum++] = sim.isrLastNs[SIM_ISR_ADC];
+		if(slowStart && (sim.isrLastNs[SIM_ISR_ADC] < CRIT_PATH_PREEMPT_NS))
+		{
+			critSum[wcEnd] += sim.isrLastNs[SIM_ISR_ADC];
+			critCnt[wcEnd]++;
+		}
+	}
+	if((sim.isrCalls[SIM_ISR_EXTI0] != deferCalls) && (deferNum < CRIT_PATH_PERIODS))
+	{
+		pDeferNs[deferNum++] = sim.isrLastNs[SIM_ISR_EXTI0];
+	}
+	critCalls = sim.isrCalls[SIM_ISR_ADC];
+	deferCalls = sim.isrCalls[SIM_ISR_EXTI0];
+}
+
+static int compareNs(const void* pA, const void* pB){
+	double a = *(const double*)pA, b = *(const double*)pB;
+	return (a > b) - (a < b);
+}
+
+static void report(const char* pName, double* pNs, uint32_t num){
+	double sum = 0.0;
+	uint32_t i;
+
+	if(num == 0) { printf("%-12s no calls\n", pName); return; }
+	for(i = 0; i < num; i++){
+		sum += pNs[i];
+	}
+	qsort(pNs, num, sizeof(double), compareNs);
+	printf("%-12s %7u calls, mean %6.1f ns, 99.9%% %6.1f ns, max %7.1f ns\n", pName, num, sum / num,
+				 pNs[(uint32_t)(num * 0.999)], pNs[num - 1]);
+}
+
+int main(void){
+	plantParam_t param;
+	double mean[2];
+	int ok = 1;
+
+	pCritNs = calloc(CRIT_PATH_PERIODS, sizeof(double));
+	pDeferNs = calloc(CRIT_PATH_PERIODS, sizeof(double));
+	if((pCritNs == 0) || (pDeferNs == 0)) { return 2; }
+
+	plantDefault(&param);
+	simInit(&param);
+	sim.pHook = periodHook;
+	simRun(2000);
+
+	sim.isrTiming = 1;
+	simStart(240.0f, 150.0f, 80.0f);
+	simRun(CRIT_PATH_PERIODS / 4);
+	setVin(225.0f);
+	simRun(CRIT_PATH_PERIODS / 4);
+	plantSetIrradiance(&sim.plant, PLANT_PV_GROUPS_MAX, 0.02f);										// light load, burst mode
+	simRun(CRIT_PATH_PERIODS / 4);
+	plantSetIrradiance(&sim.plant, PLANT_PV_GROUPS_MAX, 1.0f);
+	simRun(CRIT_PATH_PERIODS / 4);
+	sim.isrTiming = 0;
+
+	mean[0] = critSum[0] / (critCnt[0] ? critCnt[0] : 1);
+	mean[1] = critSum[1] / (critCnt[1] ? critCnt[1] : 1);
+	report("ADC1_2 JEOS", pCritNs, critNum);
+	report("EXTI0", pDeferNs, deferNum);
+	printf("control path mean: %.1f ns at a work cycle end (%u), %.1f ns else (%u)\n", mean[1], critCnt[1], mean[0], critCnt[0]);
+
+	ok &= (critCnt[0] != 0) && (critCnt[1] != 0);
+	ok &= (mean[1] <= CRIT_PATH_WC_RATIO_MAX * mean[0]);
+	ok &= (DCDC_getFault() == DCDC_FAULT_NONE);
+	printf("%s\n", ok ? "PASS" : "FAIL");
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,209 @@
+/*
+ * deadbeat_step.c
+ *
+ *  Created on: 17 OCT. 2026
+ *  Current steps with the deadbeat prediction against the PI duty
+ *
+ *  Built twice, deadbeat_step_pi (DCDC_DEADBEAT 0) and deadbeat_step (1).
+ *  The current loop alone, deadbeat only: deadbeatStep drives a plant of its own the way
+ *  the PWM interrupt does, the averages of a period are its sample, the battery current
+ *  its load and the duty goes to the next period. The reference steps DB_REF_LOW ->
+ *  DB_REF_HIGH at one sample, the samples after it are taken as part of the step between
+ *  the levels settled at both: the dead time and the losses are not in the model, the
+ *  current sits an offset below the reference. On a plant of the model (no dead time,
+ *  no losses, Vin and the battery held) the sample two periods after the step must be on
+ *  the new level within DB_STEP_TOL and stay there, on the default plant within
+ *  DB_PLANT_TOL and then within DB_PLANT_DRIFT while the PV sags under the new load.
+ *  The firmware on the sim: the Vin loop holds 240 V at about 48 A, then the output
+ *  current limit steps to DB_I_LIMIT. Settling is the first period after which the
+ *  output current stays within DB_BAND of the limit for DB_HOLD periods.
+ *  "record <file>" (PI) writes the periods and the lowest current, "compare <file>"
+ *  (deadbeat) prints both and must settle at least DB_GAIN_MIN times faster, with no
+ *  current back from the battery.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include "sim.h"
+#include "HiResTim.h"
+#include "dcdc.h"
+#include "deadbeat.h"
+
+#define DB_VIN								240.0f															// V
+#define DB_I_LIMIT						30.0f																// A, from about 48 A
+#define DB_BAND								1.0f																// A
+#define DB_HOLD								500U																// periods
+#define DB_WINDOW							20000U															// periods, 1 s
+#define DB_GAIN_MIN						4.0f
+#define DB_REF_LOW						20.0f																// A
+#define DB_REF_HIGH						35.0f																// A
+#define DB_STEP_TOL						0.01f																// of the step, the plant of the model
+#define DB_PLANT_TOL					0.03f																// of the step, the default plant
+#define DB_PLANT_DRIFT				0.08f																// the later samples, the PV sags under the load
+#define DB_STIFF_C						1.0f																// F, Vin and the battery held over the step
+#define DB_STEP_SETTLE				2000U																// periods to settle at a reference
+#define DB_STEP_AFTER					20U																	// periods checked after the step
+#define DB_STEP_PRINT					6U
+
+#if DCDC_DEADBEAT
+#define DB_NAME								"deadbeat"
+#else
+#define DB_NAME								"PI duty"
+#endif
+
+#if DCDC_DEADBEAT
+static plant_t dbPlant;
+static float dbDeadTime;																								// counts
+static float dbIout;																										// A, the sample of the last period
+
+/******************************************************************************************
+*  One period of the plant, then the sample of it to deadbeatStep; returns the duty of the
+*  next period. The averages of the plant are taken over the ends of its Euler steps, the
+*  current half a step late and the voltages half a step early: the sample is moved to
+*  the average of the straight lines between the steps, what the ADC sees.
+*******************************************************************************************/
+static float dbPeriod(float duty, float ref){
+	deadbeatSample_t now;
+	float vIn = dbPlant.vIn, vOut = dbPlant.vOut, iL = dbPlant.iL[0];
+	float vOutAvg;
+
+	plantStep(&dbPlant, BUCK_PERIOD * (1.0f / SIM_HRTIM_HZ), &duty, 1, dbDeadTime, dbDeadTime);
+	vOutAvg = dbPlant.avgVout + (dbPlant.vOut - vOut) * (0.5f / PLANT_SUBSTEPS);
+	dbIout = dbPlant.avgIout - (dbPlant.iL[0] - iL) * (0.5f / PLANT_SUBSTEPS);
+	now.vIn = (int32_t)((dbPlant.avgVin + (dbPlant.vIn - vIn) * (0.5f / PLANT_SUBSTEPS)) * 65536.0f);
+	now.vOut = (int32_t)(vOutAvg * 65536.0f);
+	now.iL = (int32_t)(dbIout * 65536.0f);
+	now.iLoad = (int32_t)((vOutAvg - dbPlant.p.vBat) / dbPlant.p.rBat * 65536.0f);						// the battery current
+	now.duty = (int32_t)(duty * 2147483648.0f);
+	now.period = BUCK_PERIOD;
+	now.periodNext = BUCK_PERIOD;
+	duty = deadbeatStep((int32_t)(ref / DCDC_CYCLE_CURR_LIMIT * 2147483648.0f), &now) * (1.0f / 2147483648.0f);
+	if(duty < (float)DUTY_MIN / BUCK_PERIOD) { duty = (float)DUTY_MIN / BUCK_PERIOD; }
+	if(duty > (float)DUTY_MAX / BUCK_PERIOD) { duty = (float)DUTY_MAX / BUCK_PERIOD; }
+	return duty;
+}
+
+static float dbSettle(float* pDuty, float ref){
+	uint32_t n;
+
+	for(n = 0; n < DB_STEP_SETTLE; n++){
+		*pDuty = dbPeriod(*pDuty, ref);
+	}
+	return dbIout;
+}
+
+/******************************************************************************************
+*  The reference step on the current loop alone, the samples after it as part of the
+*  step between the settled levels: the one two periods after within tolStep, the later
+*  ones within tolAfter
+*******************************************************************************************/
+static int dbCurrentStep(const char* pName, const plantParam_t* pParam, float deadTime, float tolStep, float tolAfter){
+	float duty = (float)DUTY_MIN / BUCK_PERIOD;
+	float dutyLow, low, high, done;
+	plant_t atLow;
+	uint32_t n;
+	int ok = 1;
+
+	plantInit(&dbPlant, pParam);
+	dbDeadTime = deadTime;
+	deadbeatSetModel(pParam->l, pParam->cOut);
+	deadbeatSetScale(DCDC_CYCLE_CURR_LIMIT);
+	low = dbSettle(&duty, DB_REF_LOW);
+	atLow = dbPlant;
+	dutyLow = duty;
+	high = dbSettle(&duty, DB_REF_HIGH);
+	dbPlant = atLow;
+	duty = dutyLow;
+	printf("%s: %.0f -> %.0f A reference, %.2f -> %.2f A settled, samples after the step:",
+				 pName, DB_REF_LOW, DB_REF_HIGH, low, high);
+	for(n = 1; n <= DB_STEP_AFTER; n++){
+		duty = dbPeriod(duty, DB_REF_HIGH);
+		done = (dbIout - low) / (high - low);
+		if(n <= DB_STEP_PRINT) { printf(" %.3f", done); }
+		if(n == 3) { ok &= (fabsf(done - 1.0f) <= tolStep); }
+		if(n > 3) { ok &= (fabsf(done - 1.0f) <= tolAfter); }
+	}
+	printf(" of the step%s\n", ok ? "" : "  <-");
+	return ok;
+}
+#endif
+
+/******************************************************************************************
+*  Periods from now to the last period out of the band, DB_WINDOW if it doesn't stay in;
+*  pMin - lowest output current
+*******************************************************************************************/
+static uint32_t settlePeriods(float* pMin){
+	uint32_t settled = 0;
+	uint32_t n;
+
+	*pMin = sim.plant.avgIout;
+	for(n = 1; n <= DB_WINDOW; n++){
+		simPeriod();
+		if(sim.plant.avgIout < *pMin) { *pMin = sim.plant.avgIout; }
+		if(fabsf(sim.plant.avgIout - DB_I_LIMIT) > DB_BAND) { settled = n; }
+		if(n - settled >= DB_HOLD) { break; }
+	}
+	return (n > DB_WINDOW) ? DB_WINDOW : settled;
+}
+
+int main(int argc, char** argv){
+	plantParam_t param;
+	uint32_t periods, other;
+	float iMin, otherMin;
+	FILE* pFile;
+	int compare;
+	int ok = 1;
+
+	if((argc != 3) || (strcmp(argv[1], "record") && strcmp(argv[1], "compare")))
+	{
+		fprintf(stderr, "usage: %s record|compare <file>\n", argv[0]);
+		return 2;
+	}
+	compare = (strcmp(argv[1], "compare") == 0);
+
+#if DCDC_DEADBEAT
+	plantDefault(&param);
+	ok &= dbCurrentStep("plant", &param, DEAD_TIME_INIT, DB_PLANT_TOL, DB_PLANT_DRIFT);
+	param.rL[0] = 0.0f;
+	param.vDiode = 0.0f;
+	param.cIn = DB_STIFF_C;
+	param.cOut = DB_STIFF_C;
+	ok &= dbCurrentStep("model", &param, 0.0f, DB_STEP_TOL, DB_STEP_TOL);
+#endif
+
+	plantDefault(&param);
+	simInit(&param);
+	simRun(2000);
+	simStart(DB_VIN, 150.0f, 80.0f);
+	simRun(2 * DB_WINDOW);
+	printf("%s: Vin %.1f V, output %.1f A", DB_NAME, sim.plant.avgVin, sim.plant.avgIout);
+	DCDC_setIoutLimit(DB_I_LIMIT);
+	periods = settlePeriods(&iMin);
+	printf(", limit %.0f A settled in %u periods, %.1f A at the lowest\n", DB_I_LIMIT, periods, iMin);
+	ok &= (periods < DB_WINDOW) && (DCDC_getFault() == DCDC_FAULT_NONE);
+
+	if(compare)
+	{
+		pFile = fopen(argv[2], "r");
+		if((pFile == 0) || (fscanf(pFile, "%u %f", &other, &otherMin) != 2))
+		{
+			fprintf(stderr, "%s: no record of the other variant\n", argv[2]);
+			return 2;
+		}
+		fclose(pFile);
+		printf("%u -> %u periods, %.1f times faster; lowest %.1f -> %.1f A\n", other, periods,
+					 (float)other / (periods ? periods : 1), otherMin, iMin);
+		ok &= (periods * DB_GAIN_MIN <= other) && (iMin > 0.0f);
+	}
+	else
+	{
+		pFile = fopen(argv[2], "w");
+		if(pFile == 0) { return 2; }
+		fprintf(pFile, "%u %.2f\n", periods, iMin);
+		fclose(pFile);
+	}
+
+	printf("%s\n", ok ? "PASS" : "FAIL");
+	return ok ? 0 : 1;
+}
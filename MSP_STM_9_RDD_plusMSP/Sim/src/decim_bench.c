@@ -0,0 +1,145 @@
+/*
+ * decim_bench.c
+ *
+ *  Created on: 17 OCT. 2026
+ *  Packed pre-sum of decimUpdate against a per channel accumulation
+ *
+ *  The reference walks the halfword fields of every set into 32 bit sums one channel at a
+ *  time, as measureExecute did, ahead of the same integrators and combs. Both are fed the
+ *  same random 12 bit sets: the fast outputs must match bit for bit. The time per call of
+ *  each is printed only: the sim defines ARM_MATH_CM4, so DECIM_ADD16 is the C __UADD16 of
+ *  Sim/inc/core_cm4.h, a few host instructions where the M4 spends one cycle, and the
+ *  ratio moves with the host compiler. The loads and adds per set are printed with it,
+ *  the cycles of the board come from isrprof (ISR_PROF_ADC1_2).
+ */
+
+#include <stdio.h>
+#include <time.h>
+#include "decim.h"
+
+#define DECIM_BENCH_SETS			(1UL << 22)
+#define DECIM_BENCH_TABLE			4096U																// random sets, reused
+
+static regAdcValue_t sets[DECIM_BENCH_TABLE];
+
+typedef
+	struct{
+		uint8_t order;
+		uint8_t log2r;
+		uint8_t presum;
+		uint16_t count;
+	} refGroup_t;
+
+static refGroup_t refGroup = { DECIM_FAST_ORDER, DECIM_FAST_LOG2R, DECIM_PRESUM_LOG2, 0 };
+static uint32_t refPresum[DECIM_FAST_CHANNELS];
+static uint32_t refInteg[DECIM_FAST_CHANNELS][DECIM_MAX_ORDER];
+static uint32_t refComb[DECIM_FAST_CHANNELS][DECIM_MAX_ORDER];
+static uint16_t refPresumCount;
+
+/******************************************************************************************
+*  Reference: decimUpdate of the fast group with one load and one add per channel and
+*  sample ahead of the same integrators and combs
+*******************************************************************************************/
+static __attribute__((noinline)) uint8_t refUpdate(const volatile regAdcValue_t* pSample, wordAdcValue_t* pOut){
+	const volatile uint16_t* pField = &pSample->iInSensor;
+	uint32_t* pOutField = &pOut->iInSensor;
+	uint16_t ch;
+
+	for(ch = 0; ch < DECIM_FAST_CHANNELS; ch++){
+		refPresum[ch] += pField[ch];
+	}
+	if(++refPresumCount < (1U << DECIM_PRESUM_LOG2)) { return 0; }
+	refPresumCount = 0;
+
+	for(ch = 0; ch < DECIM_FAST_CHANNELS; ch++){
+		uint32_t x = refPresum[ch];
+		uint16_t k = 0;
+		refPresum[ch] = 0;
+		while(k < refGroup.order){
+			refInteg[ch][k] += x;
+			x = refInteg[ch][k];
+			k++;
+		}
+	}
+	if(++refGroup.count < (1U << (refGroup.log2r - refGroup.presum))) { return 0; }
+	refGroup.count = 0;
+
+	for(ch = 0; ch < DECIM_FAST_CHANNELS; ch++){
+		uint32_t y = refInteg[ch][refGroup.order - 1];
+		uint16_t k = 0;
+		int16_t shift = refGroup.presum + refGroup.order * (refGroup.log2r - refGroup.presum) - DECIM_OUT_FRAC;
+		while(k < refGroup.order){
+			uint32_t x = y;
+			y = x - refComb[ch][k];
+			refComb[ch][k] = x;
+			k++;
+		}
+		pOutField[ch] = (shift >= 0) ? (y >> shift) : (y << -shift);
+	}
+	return DECIM_FAST_READY;
+}
+
+static double secondsSince(const struct timespec* pT0){
+	struct timespec t1;
+	clock_gettime(CLOCK_MONOTONIC, &t1);
+	return (t1.tv_sec - pT0->tv_sec) + (t1.tv_nsec - pT0->tv_nsec) * 1e-9;
+}
+
+int main(void){
+	wordAdcValue_t outPacked, outRef;
+	struct timespec t0;
+	double tPacked, tRef;
+	uint32_t seed = 12345U;
+	uint32_t n, outputs = 0, mismatches = 0;
+	volatile uint32_t sink = 0;
+	int ok = 1;
+
+	for(n = 0; n < DECIM_BENCH_TABLE; n++){
+		uint16_t* pField = &sets[n].iInSensor;
+		uint16_t ch;
+		for(ch = 0; ch < ADC_STRUCT_MEMBERS_NUM; ch++){
+			seed = seed * 1664525U + 1013904223U;
+			pField[ch] = (uint16_t)(seed >> 20);																	// 12 bit
+		}
+	}
+
+	/* bit exactness */
+	decimInit();
+	for(n = 0; n < DECIM_BENCH_SETS; n++){
+		const regAdcValue_t* pSet = &sets[n & (DECIM_BENCH_TABLE - 1)];
+		uint8_t readyPacked = decimUpdate(pSet, &outPacked) & DECIM_FAST_READY;
+		uint8_t readyRef = refUpdate(pSet, &outRef);
+		if(readyPacked != readyRef) { mismatches++; continue; }
+		if(readyRef)
+		{
+			outputs++;
+			if((outPacked.iInSensor != outRef.iInSensor) || (outPacked.vInSensor != outRef.vInSensor) ||
+				 (outPacked.iOutSensor != outRef.iOutSensor) || (outPacked.vOutSensor != outRef.vOutSensor)) { mismatches++; }
+		}
+	}
+	printf("%u fast outputs, %u mismatches\n", outputs, mismatches);
+	ok &= (outputs != 0) && (mismatches == 0);
+
+	/* time per call */
+	decimInit();
+	clock_gettime(CLOCK_MONOTONIC, &t0);
+	for(n = 0; n < DECIM_BENCH_SETS; n++){
+		if(decimUpdate(&sets[n & (DECIM_BENCH_TABLE - 1)], &outPacked)) { sink += outPacked.vInSensor; }
+	}
+	tPacked = secondsSince(&t0);
+
+	clock_gettime(CLOCK_MONOTONIC, &t0);
+	for(n = 0; n < DECIM_BENCH_SETS; n++){
+		if(refUpdate(&sets[n & (DECIM_BENCH_TABLE - 1)], &outRef)) { sink += outRef.vInSensor; }
+	}
+	tRef = secondsSince(&t0);
+
+	printf("pre-sum per set: packed %u loads %u adds, per channel %u loads %u adds\n",
+				 ADC_FAST_PAIRS, ADC_FAST_PAIRS, DECIM_FAST_CHANNELS, DECIM_FAST_CHANNELS);
+	printf("host: packed %.2f ns/call, per channel %.2f ns/call, ratio %.2f\n",
+				 tPacked * 1e9 / DECIM_BENCH_SETS, tRef * 1e9 / DECIM_BENCH_SETS, tPacked / tRef);
+	(void)sink;
+
+	printf("%s\n", ok ? "PASS" : "FAIL");
+	return ok ? 0 : 1;
+}
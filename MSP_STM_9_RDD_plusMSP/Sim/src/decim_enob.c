@@ -0,0 +1,128 @@
+/*
+ * decim_enob.c
+ *
+ *  Created on: 17 OCT. 2026
+ *  Effective number of bits of the decimator on a noisy sine
+ *
+ *  A sine of DECIM_ENOB_AMPL codes around mid scale with uniform noise of +/- DECIM_ENOB_NOISE
+ *  codes is rounded to 12 bit codes, one per PWM period, on Vin (fast group) and on vrefCpu
+ *  (slow group, one code per rotation of the slow pairs through decimSlowUpdate with
+ *  ADC_SLOW_ROUND_ROBIN). A sine of the known frequency is fitted by least squares to the
+ *  input codes and to the outputs of each group; ENOB = (SINAD - 1.76 dB) / 6.02 dB with the
+ *  residual as noise and distortion, the first outputs before the combs are filled left out.
+ *  Each group must gain DECIM_ENOB_GAIN_MIN bits over its input: an order 2 CIC of ratio R
+ *  passes 2 / (3 R) of the white noise power, 2.29 bits at R 16.
+ */
+
+#include <stdio.h>
+#include <math.h>
+#include "decim.h"
+
+#define DECIM_ENOB_INPUTS			(1UL << 18)														// PWM periods, 13 s
+#define DECIM_ENOB_AMPL				1800.0															// codes
+#define DECIM_ENOB_NOISE			8																		// codes, +/- uniform
+#define DECIM_ENOB_FAST_HZ		31.7																// well below the fast output rate
+#define DECIM_ENOB_SLOW_HZ		3.17
+#define DECIM_ENOB_GAIN_MIN		2.0																	// bits over the input, each group
+#define DECIM_ENOB_PWM_HZ			20000.0
+#define DECIM_ENOB_SKIP				4																		// outputs before the combs are filled
+
+static double inFast[DECIM_ENOB_INPUTS];
+static double outFast[DECIM_ENOB_INPUTS >> DECIM_FAST_LOG2R];
+static double inSlow[DECIM_ENOB_INPUTS >> ADC_SLOW_ROUND_LOG2];
+static double outSlow[DECIM_ENOB_INPUTS >> DECIM_SLOW_LOG2R];
+static uint32_t seed = 12345U;
+
+static uint16_t noisyCode(double hz, uint32_t n){
+	double x = 2048.0 + DECIM_ENOB_AMPL * sin(2.0 * M_PI * hz * n / DECIM_ENOB_PWM_HZ);
+	seed = seed * 1664525U + 1013904223U;
+	x += (int32_t)((seed >> 16) % (2U * DECIM_ENOB_NOISE + 1U)) - DECIM_ENOB_NOISE;
+	return (uint16_t)floor(x + 0.5);
+}
+
+/******************************************************************************************
+*  Least squares fit of c + a sin + b cos at w rad per sample, ENOB of the residual
+*******************************************************************************************/
+static double enob(const double* pX, uint32_t n, double w){
+	double s[3][4] = { { 0.0 } };
+	double signal, noise = 0.0;
+	uint32_t i;
+	uint8_t r, c, k;
+
+	for(i = 0; i < n; i++){
+		double f[3] = { 1.0, sin(w * i), cos(w * i) };
+		for(r = 0; r < 3; r++){
+			for(c = 0; c < 3; c++){
+				s[r][c] += f[r] * f[c];
+			}
+			s[r][3] += f[r] * pX[i];
+		}
+	}
+	for(k = 0; k < 3; k++){																											// Gauss-Jordan, the matrix is well conditioned
+		for(r = 0; r < 3; r++){
+			double m;
+			if(r == k) { continue; }
+			m = s[r][k] / s[k][k];
+			for(c = k; c < 4; c++){
+				s[r][c] -= m * s[k][c];
+			}
+		}
+	}
+	for(i = 0; i < n; i++){
+		double e = pX[i] - (s[0][3] / s[0][0] + s[1][3] / s[1][1] * sin(w * i) + s[2][3] / s[2][2] * cos(w * i));
+		noise += e * e;
+	}
+	signal = 0.5 * ((s[1][3] / s[1][1]) * (s[1][3] / s[1][1]) + (s[2][3] / s[2][2]) * (s[2][3] / s[2][2]));
+	return (10.0 * log10(signal / (noise / n)) - 1.76) / 6.02;
+}
+
+int main(void){
+	regAdcValue_t set = { { 0 } };
+	wordAdcValue_t out;
+	uint32_t slowPairs[ADC_SLOW_PAIRS];
+	uint32_t n, nFast = 0, nSlowIn = 0, nSlowOut = 0;
+	double eInFast, eOutFast, eInSlow, eOutSlow;
+	uint8_t p;
+	int ok = 1;
+
+	for(p = 0; p < ADC_SLOW_PAIRS; p++){
+		slowPairs[p] = 2048U | (2048U << 16);
+	}
+	set.pair[0] = 2048U | (2048U << 16);
+	set.pair[1] = 2048U | (2048U << 16);
+
+	decimInit();
+	for(n = 0; n < DECIM_ENOB_INPUTS; n++){
+		uint16_t code = noisyCode(DECIM_ENOB_FAST_HZ, n);
+		inFast[n] = code;
+		set.vInSensor = code;
+		if(decimUpdate(&set, &out) & DECIM_FAST_READY) { outFast[nFast++] = out.vInSensor * (1.0 / (1UL << DECIM_OUT_FRAC)); }
+#if ADC_SLOW_ROUND_ROBIN
+		if((n & ((1U << ADC_SLOW_ROUND_LOG2) - 1)) == 0)
+		{
+			code = noisyCode(DECIM_ENOB_SLOW_HZ, n);
+			inSlow[nSlowIn++] = code;
+			slowPairs[0] = code | (2048U << 16);																				// vrefCpu, v12Sensor
+			if(decimSlowUpdate(slowPairs, &out)) { outSlow[nSlowOut++] = out.vrefCpu * (1.0 / (1UL << DECIM_OUT_FRAC)); }
+		}
+#endif
+	}
+
+	eInFast = enob(inFast, DECIM_ENOB_INPUTS, 2.0 * M_PI * DECIM_ENOB_FAST_HZ / DECIM_ENOB_PWM_HZ);
+	eOutFast = enob(&outFast[DECIM_ENOB_SKIP], nFast - DECIM_ENOB_SKIP, 2.0 * M_PI * DECIM_ENOB_FAST_HZ * (1U << DECIM_FAST_LOG2R) / DECIM_ENOB_PWM_HZ);
+	printf("fast: order %u, ratio %u: input %.2f bits, %u outputs %.2f bits, gain %.2f\n",
+				 DECIM_FAST_ORDER, 1U << DECIM_FAST_LOG2R, eInFast, nFast, eOutFast, eOutFast - eInFast);
+	ok &= (nFast == DECIM_ENOB_INPUTS >> DECIM_FAST_LOG2R) && (eOutFast - eInFast >= DECIM_ENOB_GAIN_MIN);
+#if ADC_SLOW_ROUND_ROBIN
+	eInSlow = enob(inSlow, nSlowIn, 2.0 * M_PI * DECIM_ENOB_SLOW_HZ * (1U << ADC_SLOW_ROUND_LOG2) / DECIM_ENOB_PWM_HZ);
+	eOutSlow = enob(&outSlow[DECIM_ENOB_SKIP], nSlowOut - DECIM_ENOB_SKIP, 2.0 * M_PI * DECIM_ENOB_SLOW_HZ * (1U << DECIM_SLOW_LOG2R) / DECIM_ENOB_PWM_HZ);
+	printf("slow: order %u, ratio %u rotations: input %.2f bits, %u outputs %.2f bits, gain %.2f\n",
+				 DECIM_SLOW_ORDER, 1U << (DECIM_SLOW_LOG2R - ADC_SLOW_ROUND_LOG2), eInSlow, nSlowOut, eOutSlow, eOutSlow - eInSlow);
+	ok &= (nSlowOut == DECIM_ENOB_INPUTS >> DECIM_SLOW_LOG2R) && (eOutSlow - eInSlow >= DECIM_ENOB_GAIN_MIN);
+#else
+	(void)inSlow; (void)outSlow; (void)nSlowIn; (void)nSlowOut; (void)eInSlow; (void)eOutSlow;
+#endif
+
+	printf("%s\n", ok ? "PASS" : "FAIL");
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,125 @@
+/*
+ * dma_race.c
+ *
+ *  Created on: 17 OCT. 2026
+ *  Ping-pong DMA of the ADC results against a reader preempted at random offsets
+ *
+ *  A POSIX timer signal stands for the DMA: it preempts the test thread where it is, like
+ *  DMA1_Channel1 preempts EXTI0, writes a random burst of words into adcDmaBuf and runs
+ *  DMA1_Channel1_IRQHandler with the HT / TC flags and CNDTR the burst left. A burst is up
+ *  to a set and a word, so HT and TC may come together and the DMA may already write the
+ *  half of the last sequence number; a third half before the interrupt would be one count
+ *  short, as on the board. Every word of set c is (c << 16) | c, c 12 bit, so a
+ *  torn copy shows up as unequal words.
+ *  The thread calls measureExecute in a loop: every new momentValue must have equal words,
+ *  and its set must be the sequence number, the sets seen + adcLost. The same loop takes a
+ *  copy of the last complete half without the sequence lock: its torn copies show that the
+ *  signals hit the copy.
+ */
+
+#include <stdio.h>
+#include <signal.h>
+#include <time.h>
+#include "sim.h"
+#include "BoardInit.h"
+#include "dcdc.h"
+
+#define DMA_RACE_SIGNALS			100000U
+#define DMA_RACE_BURST_MAX		(ADC_PAIRS_NUM + 1U)												// words of one signal, HT and TC at most
+#define DMA_RACE_DELAY_NS			20000U															// up to, between the signals
+
+extern volatile regAdcValue_t adcDmaBuf[2];
+extern volatile uint32_t adcSeq;
+extern uint32_t adcLost;
+
+static timer_t timer;
+static volatile uint32_t signals;
+static uint32_t dmaPos;																								// word of adcDmaBuf the DMA writes next
+static uint32_t dmaSet = 1;																						// set of that word
+static uint32_t seed = 12345U;
+
+static uint32_t random32(void){
+	seed = seed * 1664525U + 1013904223U;
+	return seed;
+}
+
+static void timerArm(void){
+	struct itimerspec t = { { 0, 0 }, { 0, 1000 + (long)((random32() >> 8) % DMA_RACE_DELAY_NS) } };
+	timer_settime(timer, 0, &t, 0);
+}
+
+/******************************************************************************************
+*  The DMA: a burst of words, then the interrupt of the halves it completed
+*******************************************************************************************/
+static void dmaSignal(int sig){
+	volatile uint32_t* pWord = &adcDmaBuf[0].pair[0];
+	uint32_t words = 1 + (random32() >> 8) % DMA_RACE_BURST_MAX;
+
+	(void)sig;
+	while(words--){
+		uint32_t code = dmaSet & 0xFFF;
+		pWord[dmaPos] = code | (code << 16);
+		if(++dmaPos == ADC_PAIRS_NUM) { simDma1.ISR |= DMA_ISR_HTIF1 | DMA_ISR_GIF1; dmaSet++; }
+		if(dmaPos == 2 * ADC_PAIRS_NUM) { simDma1.ISR |= DMA_ISR_TCIF1 | DMA_ISR_GIF1; dmaSet++; dmaPos = 0; }
+	}
+	simDma1Channel[0].CNDTR = 2 * ADC_PAIRS_NUM - dmaPos;
+	if(simDma1.ISR & DMA_ISR_GIF1)
+	{
+		DMA1_Channel1_IRQHandler();
+		simDma1.ISR = 0;
+	}
+	if(++signals < DMA_RACE_SIGNALS) { timerArm(); }
+}
+
+static uint8_t torn(const volatile uint32_t* pPair){
+	uint16_t i;
+
+	for(i = 1; i < ADC_PAIRS_NUM; i++){
+		if(pPair[i] != pPair[0]) { return 1; }
+	}
+	return 0;
+}
+
+int main(void){
+	plantParam_t param;
+	struct sigevent ev = { 0 };
+	uint32_t lastWord = 0;
+	uint32_t seen = 0, tornLocked = 0, seqWrong = 0, tornPlain = 0;
+	uint32_t i;
+	int ok = 1;
+
+	plantDefault(&param);
+	simInit(&param);																											// no simRun: the signal is the only DMA
+
+	signal(SIGALRM, dmaSignal);
+	ev.sigev_notify = SIGEV_SIGNAL;
+	ev.sigev_signo = SIGALRM;
+	if(timer_create(CLOCK_MONOTONIC, &ev, &timer) != 0) { return 2; }
+	timerArm();
+
+	while(signals < DMA_RACE_SIGNALS){
+		regAdcValue_t plain;
+		const volatile regAdcValue_t* pHalf = &adcDmaBuf[adcSeq & 1];
+		for(i = 0; i < ADC_PAIRS_NUM; i++){
+			plain.pair[i] = pHalf->pair[i];
+		}
+		tornPlain += torn(plain.pair);
+
+		measureExecute();
+		if(momentValue.pair[0] != lastWord)
+		{
+			lastWord = momentValue.pair[0];
+			seen++;
+			tornLocked += torn(momentValue.pair);
+			if((lastWord & 0xFFF) != ((seen + adcLost) & 0xFFF)) { seqWrong++; }
+		}
+	}
+	timer_delete(timer);
+
+	printf("%u signals, %u sets: %u taken, %u lost\n", signals, dmaSet - 1, seen, adcLost);
+	printf("sequence lock: %u torn, %u off their sequence number; plain copy: %u torn\n", tornLocked, seqWrong, tornPlain);
+	ok &= (seen != 0) && (tornLocked == 0) && (seqWrong == 0);
+	ok &= (tornPlain != 0);																								// the signals reached the copy
+	printf("%s\n", ok ? "PASS" : "FAIL");
+	return ok ? 0 : 1;
+}
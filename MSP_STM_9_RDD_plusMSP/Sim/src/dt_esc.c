@@ -0,0 +1,148 @@
+/*
+ * dt_esc.c
+ *
+ *  Created on: 17 OCT. 2026
+ *  Extremum seeking of the dead time on a loss model with a load dependent optimum
+ *
+ *  The plant draws dtLossK * (dr^2 + df^2) of the output power more from the input, dr and
+ *  df the distances of the rising and falling dead time from their best values; the best
+ *  falling dead time moves with the output current by dtFallSlope. At two loads in
+ *  different bins the centres learned by deadtime.c must end within DT_ESC_TOL counts of
+ *  the optimum of the load, and the efficiency estimate must gain on the starting dead
+ *  time. The second load sits on the edge of two bins, where the ripple of the output
+ *  current must not restart the dither (DT_BIN_HYST). Back at the first load its bin must
+ *  start from its learned centre. Then the best rising dead time moves below DT_MIN: the
+ *  centre must stop at DT_MIN + DT_DITHER. DTxR is checked every period of the run, the
+ *  dither must never apply a dead time outside DT_MIN..DT_MAX.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "sim.h"
+#include "dcdc.h"
+#include "deadtime.h"
+
+#define DT_ESC_LOSS_K					3.0e-5f															// per count^2, 1.9% at 25 counts off
+#define DT_ESC_RISE_OPT				52.0f																// counts
+#define DT_ESC_FALL_OPT				84.0f																// counts at 0 A
+#define DT_ESC_FALL_SLOPE			(-0.6f)															// counts per A
+#define DT_ESC_PERIODS				400000U															// 20 s, about 20 steps of each axis
+#define DT_ESC_TOL						(DT_STEP + DT_DITHER / 2)										// counts
+#define DT_ESC_RISE_LOW				20.0f																// counts, below DT_MIN
+
+typedef
+	struct{
+		float gain;																												// irradiance
+		float iOut;																												// A, measured
+		uint8_t bin;
+		uint16_t rise, fall;																							// learned centre
+		float eff0, eff;																									// efficiency estimate, start and end
+} load_t;
+
+static uint16_t dtrMin = 0xFFFF, dtrMax;
+
+/******************************************************************************************
+*  Per period: the applied dead times, both edges
+*******************************************************************************************/
+static void periodHook(void){
+	uint32_t dtr = simHrtim1.sTimerxRegs[TIM_A].DTxR;
+	uint16_t rise = (uint16_t)((dtr & HRTIM_DTR_DTR) >> HRTIM_DTR_DTR_Pos);
+	uint16_t fall = (uint16_t)((dtr & HRTIM_DTR_DTF) >> HRTIM_DTR_DTF_Pos);
+
+	if(rise < dtrMin) { dtrMin = rise; }
+	if(fall < dtrMin) { dtrMin = fall; }
+	if(rise > dtrMax) { dtrMax = rise; }
+	if(fall > dtrMax) { dtrMax = fall; }
+}
+
+/******************************************************************************************
+*  The bin in use: of the bins within DT_BIN_HYST of the load, the one whose centre is
+*  nearest the dead time in DTxR
+*******************************************************************************************/
+static uint8_t liveBin(float iOut){
+	uint32_t dtr = simHrtim1.sTimerxRegs[TIM_A].DTxR;
+	int rise = (int)((dtr & HRTIM_DTR_DTR) >> HRTIM_DTR_DTR_Pos);
+	int fall = (int)((dtr & HRTIM_DTR_DTF) >> HRTIM_DTR_DTF_Pos);
+	int lo = (int)((iOut - DT_BIN_HYST) / DT_BIN_WIDTH), hi = (int)((iOut + DT_BIN_HYST) / DT_BIN_WIDTH);
+	int bin, best = 0, distMin = 0x7FFF;
+
+	if(lo < 0) { lo = 0; }
+	if(hi >= DT_BINS) { hi = DT_BINS - 1; }
+	for(bin = lo; bin <= hi; bin++){
+		uint16_t r, f;
+		int dist;
+		deadTimeGet((uint8_t)bin, &r, &f);
+		dist = abs(rise - (int)r) + abs(fall - (int)f);
+		if(dist < distMin)
+		{
+			distMin = dist;
+			best = bin;
+		}
+	}
+	return (uint8_t)best;
+}
+
+static int seekLoad(load_t* pLoad){
+	float fallOpt;
+	int ok;
+
+	plantSetIrradiance(&sim.plant, PLANT_PV_GROUPS_MAX, pLoad->gain);
+	simRun(DT_ESC_PERIODS / 20);
+	pLoad->eff0 = DCDC_getEfficiency();
+	simRun(DT_ESC_PERIODS);
+	pLoad->eff = DCDC_getEfficiency();
+	pLoad->iOut = sim.plant.avgIout;
+	pLoad->bin = liveBin(pLoad->iOut);
+	deadTimeGet(pLoad->bin, &pLoad->rise, &pLoad->fall);
+
+	fallOpt = DT_ESC_FALL_OPT + DT_ESC_FALL_SLOPE * pLoad->iOut;
+	ok = (abs((int)pLoad->rise - (int)(DT_ESC_RISE_OPT + 0.5f)) <= DT_ESC_TOL);
+	ok &= (abs((int)pLoad->fall - (int)(fallOpt + 0.5f)) <= DT_ESC_TOL);
+	ok &= (pLoad->eff > pLoad->eff0);
+	printf("%.1f A, bin %u: rise %u (best %.0f), fall %u (best %.1f), efficiency %.2f%% -> %.2f%% %s\n",
+				 pLoad->iOut, pLoad->bin, pLoad->rise, DT_ESC_RISE_OPT, pLoad->fall, fallOpt,
+				 pLoad->eff0 * 100.0f, pLoad->eff * 100.0f, ok ? "" : "FAIL");
+	return ok;
+}
+
+int main(void){
+	plantParam_t param;
+	load_t loads[2] = { { .gain = 0.35f }, { .gain = 0.8f } };								// 16 A, 40 A
+	uint32_t dtr;
+	uint16_t rise, fall;
+	int ok = 1;
+
+	plantDefault(&param);
+	param.dtLossK = DT_ESC_LOSS_K;
+	param.dtRiseOpt = DT_ESC_RISE_OPT;
+	param.dtFallOpt = DT_ESC_FALL_OPT;
+	param.dtFallSlope = DT_ESC_FALL_SLOPE;
+	simInit(&param);
+	simRun(2000);
+	simStart(240.0f, 150.0f, 80.0f);
+	sim.pHook = periodHook;
+
+	ok &= seekLoad(&loads[0]);
+	ok &= seekLoad(&loads[1]);
+	ok &= (loads[0].bin != loads[1].bin) && (loads[1].fall < loads[0].fall);
+
+	/* the first load again: its bin starts from the learned centre */
+	plantSetIrradiance(&sim.plant, PLANT_PV_GROUPS_MAX, loads[0].gain);
+	simRun(DT_ESC_PERIODS / 20);
+	deadTimeGet(loads[0].bin, &rise, &fall);
+	dtr = simHrtim1.sTimerxRegs[TIM_A].DTxR;
+	printf("back at %.1f A: bin centre %u / %u, DTxR %lu / %lu\n", sim.plant.avgIout, rise, fall,
+				 (unsigned long)((dtr & HRTIM_DTR_DTR) >> HRTIM_DTR_DTR_Pos), (unsigned long)((dtr & HRTIM_DTR_DTF) >> HRTIM_DTR_DTF_Pos));
+	ok &= (abs((int)rise - (int)loads[0].rise) <= DT_STEP) && (abs((int)fall - (int)loads[0].fall) <= DT_STEP);
+
+	/* the best rising dead time out of the range: the centre stops at its edge */
+	sim.plant.p.dtRiseOpt = DT_ESC_RISE_LOW;
+	simRun(DT_ESC_PERIODS);
+	deadTimeGet(liveBin(sim.plant.avgIout), &rise, &fall);
+	printf("best rise %.0f: centre %u, DTxR %u..%u over the run, range %u..%u\n", DT_ESC_RISE_LOW, rise, dtrMin, dtrMax, DT_MIN, DT_MAX);
+	ok &= (rise == DT_MIN + DT_DITHER) && (dtrMin >= DT_MIN) && (dtrMax <= DT_MAX);
+
+	ok &= (DCDC_getFault() == DCDC_FAULT_NONE);
+	printf("%s\n", ok ? "PASS" : "FAIL");
+	return ok ? 0 : 1;
+}
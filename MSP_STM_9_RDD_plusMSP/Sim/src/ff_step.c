@@ -0,0 +1,136 @@
+/*
+ * ff_step.c
+ *
+ *  Created on: 17 OCT. 2026
+ *  Start-up and step recovery with and without the Vout/Vin feed-forward
+ *
+ *  Built twice, ff_step_on (DCDC_FEED_FORWARD 1) and ff_step_off (0). Settling is the first
+ *  period after which the plant Vin stays within FF_BAND of the setpoint for FF_HOLD
+ *  periods, as in pid_step. Three cases: the start from DCDC_Start_Stop(1), a step of the
+ *  battery voltage (a bus transient, Vout jumps and the duty must follow it) and a cloud
+ *  edge of the irradiance. "record <file>" (off) writes its periods, "compare <file>" (on)
+ *  prints both and must settle the start and the battery step at least FF_GAIN_MIN times
+ *  faster. Without the feed-forward the start from DUTY_MIN pulls current back from the
+ *  battery and boosts Vin far above Voc before the loop gets there.
+ *  The cloud edge is slower with it: the feed-forward takes the measured Vin, the
+ *  regulated one, so a dip of Vin raises the duty for a few periods. It must stay within
+ *  FF_CLOUD_SLOWER of the loop alone. The Vin setpoint instead of the measured Vin was
+ *  tried: from Voc at the start it asks for more than the zero current duty and trips
+ *  the current limit.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include "sim.h"
+#include "dcdc.h"
+
+#define FF_BAND								1.5f																// V
+#define FF_HOLD								500U																// periods
+#define FF_WINDOW							40000U															// periods, 2 s
+#define FF_VIN								240.0f															// V
+#define FF_VBAT_STEP					10.0f																// V, 120 -> 130 V
+#define FF_CLOUD_GAIN					0.5f
+#define FF_GAIN_MIN						1.5f
+#define FF_CLOUD_SLOWER				2.0f
+
+#if DCDC_FEED_FORWARD
+#define FF_NAME								"feed-forward"
+#else
+#define FF_NAME								"no feed-forward"
+#endif
+
+typedef
+	enum{
+		FF_CASE_START = 0,
+		FF_CASE_VBAT,
+		FF_CASE_CLOUD,
+		FF_CASES
+	} ffCase_ent;
+
+static const char* const caseNames[FF_CASES] = { "start", "battery step", "cloud edge" };
+
+/******************************************************************************************
+*  Periods from now to the last period out of the band, FF_WINDOW if it doesn't stay in;
+*  pDev - largest distance from the setpoint
+*******************************************************************************************/
+static uint32_t settlePeriods(float* pDev){
+	uint32_t settled = 0;
+	uint32_t n;
+
+	*pDev = 0.0f;
+	for(n = 1; n <= FF_WINDOW; n++){
+		float dev;
+		simPeriod();
+		dev = fabsf(sim.plant.avgVin - FF_VIN);
+		if(dev > *pDev) { *pDev = dev; }
+		if(dev > FF_BAND) { settled = n; }
+		if(n - settled >= FF_HOLD) { break; }
+	}
+	return (n > FF_WINDOW) ? FF_WINDOW : settled;
+}
+
+int main(int argc, char** argv){
+	plantParam_t param;
+	uint32_t periods[FF_CASES], other[FF_CASES];
+	float dev[FF_CASES];
+	FILE* pFile;
+	int compare;
+	int ok = 1;
+	uint8_t k;
+
+	if((argc != 3) || (strcmp(argv[1], "record") && strcmp(argv[1], "compare")))
+	{
+		fprintf(stderr, "usage: %s record|compare <file>\n", argv[0]);
+		return 2;
+	}
+	compare = (strcmp(argv[1], "compare") == 0);
+
+	plantDefault(&param);
+	simInit(&param);
+	simRun(2000);
+	simStart(FF_VIN, 150.0f, 80.0f);
+	periods[FF_CASE_START] = settlePeriods(&dev[FF_CASE_START]);
+	simRun(FF_WINDOW);
+
+	sim.plant.p.vBat += FF_VBAT_STEP;
+	periods[FF_CASE_VBAT] = settlePeriods(&dev[FF_CASE_VBAT]);
+	simRun(FF_WINDOW);
+
+	plantSetIrradiance(&sim.plant, PLANT_PV_GROUPS_MAX, FF_CLOUD_GAIN);
+	periods[FF_CASE_CLOUD] = settlePeriods(&dev[FF_CASE_CLOUD]);
+
+	for(k = 0; k < FF_CASES; k++){
+		printf("%s, %-12s settled in %5u periods, Vin %.1f V off at most\n", FF_NAME, caseNames[k], periods[k], dev[k]);
+		ok &= (periods[k] < FF_WINDOW);
+	}
+	ok &= (DCDC_getFault() == DCDC_FAULT_NONE);
+
+	if(compare)
+	{
+		pFile = fopen(argv[2], "r");
+		if((pFile == 0) || (fscanf(pFile, "%u %u %u", &other[0], &other[1], &other[2]) != FF_CASES))
+		{
+			fprintf(stderr, "%s: no record of the other variant\n", argv[2]);
+			return 2;
+		}
+		fclose(pFile);
+		for(k = 0; k < FF_CASES; k++){
+			printf("%-12s %5u -> %5u periods, %.1f times faster\n", caseNames[k], other[k], periods[k],
+						 (float)other[k] / (periods[k] ? periods[k] : 1));
+		}
+		ok &= (periods[FF_CASE_START] * FF_GAIN_MIN <= other[FF_CASE_START]);
+		ok &= (periods[FF_CASE_VBAT] * FF_GAIN_MIN <= other[FF_CASE_VBAT]);
+		ok &= (periods[FF_CASE_CLOUD] <= other[FF_CASE_CLOUD] * FF_CLOUD_SLOWER);
+	}
+	else
+	{
+		pFile = fopen(argv[2], "w");
+		if(pFile == 0) { return 2; }
+		fprintf(pFile, "%u %u %u\n", periods[0], periods[1], periods[2]);
+		fclose(pFile);
+	}
+
+	printf("%s\n", ok ? "PASS" : "FAIL");
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,188 @@
+/*
+ * fixed_bench.c
+ *
+ *  Created on: 17 OCT. 2026
+ *  DCDC_FIXED_POINT 1 against 0: host time per interrupt and the duty of every period
+ *
+ *  Built twice, fixed_bench_q16 and fixed_bench_float. "record <file>" runs the closed loop
+ *  (start, Vin steps, an irradiance step) and writes the plant averages and CMP1 of every
+ *  period. "replay <file>" feeds the same averages to the other variant, so both see the
+ *  same codes, and compares CMP1 period by period.
+ *
+ *  The PWM interrupt is integer in both variants and both take the Q32 code scales from
+ *  codeScalesUpdate, so the duty of every period is the same bit for bit: the variants
+ *  differ only in the work cycle averages of the thread (MEAS_update, the dead time ESC).
+ *  Before the shared scales the float path rounded adcMultipler * COEFF * 2^32, off by a
+ *  few parts in 2^32 from the Q16 scales, and the duty differed by one count where
+ *  out * buckPeriod >> 31 (or spreadScaleDuty with DCDC_REG_STEP) sits on a count boundary.
+ *  Fails if a period differs by more than FIXED_BENCH_DUTY_TOL.
+ *  The host times only compare the variants, the cycles of the board come from isrprof.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "sim.h"
+#include "HiResTim.h"
+#include "dcdc.h"
+
+#define FIXED_BENCH_PERIODS		200000U															// 10 s of the board
+#define FIXED_BENCH_DUTY_TOL	0																		// counts of buckPeriod
+
+#if DCDC_FIXED_POINT
+#define FIXED_BENCH_NAME			"Q16"
+#else
+#define FIXED_BENCH_NAME			"float"
+#endif
+
+typedef
+	struct{
+		float vIn, iIn, vOut, iOut;																				// plant averages of the period
+		uint16_t cmp1;																										// CMP1 of Timer A after the handlers
+} benchRecord_t;
+
+static benchRecord_t* pTrace;
+static uint32_t traceLen;
+static uint32_t tracePos;
+
+static uint32_t dutyDiffs;
+static uint32_t dutyDiffMax;
+
+/******************************************************************************************
+*  Per period hooks: the replay puts the recorded averages in the plant
+*******************************************************************************************/
+static void replayStep(float period){
+	const benchRecord_t* pRec = &pTrace[(tracePos < traceLen) ? tracePos : traceLen - 1];
+
+	(void)period;
+	sim.plant.avgVin = pRec->vIn;
+	sim.plant.avgIin = pRec->iIn;
+	sim.plant.avgVout = pRec->vOut;
+	sim.plant.avgIout = pRec->iOut;
+}
+
+static void recordHook(void){
+	if(tracePos >= traceLen) { return; }
+	pTrace[tracePos].vIn = sim.plant.avgVin;
+	pTrace[tracePos].iIn = sim.plant.avgIin;
+	pTrace[tracePos].vOut = sim.plant.avgVout;
+	pTrace[tracePos].iOut = sim.plant.avgIout;
+	pTrace[tracePos].cmp1 = (uint16_t)simHrtim1.sTimerxRegs[TIM_A].CMP1xR;
+	tracePos++;
+}
+
+static void replayHook(void){
+	uint16_t cmp1 = (uint16_t)simHrtim1.sTimerxRegs[TIM_A].CMP1xR;
+
+	if(tracePos >= traceLen) { return; }
+	if(cmp1 != pTrace[tracePos].cmp1)
+	{
+		uint32_t diff = (cmp1 > pTrace[tracePos].cmp1) ? cmp1 - pTrace[tracePos].cmp1 : pTrace[tracePos].cmp1 - cmp1;
+		dutyDiffs++;
+		if(diff > dutyDiffMax) { dutyDiffMax = diff; }
+	}
+	tracePos++;
+}
+
+/******************************************************************************************
+*  The same run for both variants, the handlers are timed after the start
+*******************************************************************************************/
+static void benchRun(int replay){
+	plantParam_t param;
+
+	plantDefault(&param);
+	simInit(&param);
+	sim.pStep = replay ? replayStep : 0;
+	sim.pHook = replay ? replayHook : recordHook;
+	simRun(2000);
+	simStart(240.0f, 150.0f, 80.0f);
+	simRun(20000);
+
+	sim.isrTiming = 1;
+	simRun(FIXED_BENCH_PERIODS / 4);
+	setVin(225.0f);
+	simRun(FIXED_BENCH_PERIODS / 4);
+	plantSetIrradiance(&sim.plant, PLANT_PV_GROUPS_MAX, 0.6f);
+	simRun(FIXED_BENCH_PERIODS / 4);
+	plantSetIrradiance(&sim.plant, PLANT_PV_GROUPS_MAX, 1.0f);
+	setVin(235.0f);
+	simRun(FIXED_BENCH_PERIODS / 4);
+	sim.isrTiming = 0;
+}
+
+/******************************************************************************************
+*  ns per call of every handler, less the cost of the clock reads around it
+*******************************************************************************************/
+static void benchReport(void){
+	static const char* const names[SIM_ISR_NUM] = { "ADC1_2", "DMA1_Channel1", "HRTIM1_TIMA", "EXTI0" };
+	struct timespec t0, t1;
+	double clockNs = 0.0;
+	double totalNs = 0.0;
+	uint8_t n;
+	uint16_t i;
+
+	for(i = 0; i < 1000; i++){
+		clock_gettime(CLOCK_MONOTONIC, &t0);
+		clock_gettime(CLOCK_MONOTONIC, &t1);
+		clockNs += (t1.tv_sec - t0.tv_sec) * 1e9 + (t1.tv_nsec - t0.tv_nsec);
+	}
+	clockNs *= 1.0 / 1000.0;
+
+	for(n = 0; n < SIM_ISR_NUM; n++){
+		double ns;
+		if(sim.isrCalls[n] == 0) { continue; }
+		ns = sim.isrNs[n] / sim.isrCalls[n] - clockNs;
+		if(ns < 0.0) { ns = 0.0; }
+		totalNs += ns * sim.isrCalls[n];
+		printf("%s %-14s %8u calls %7.1f ns/call\n", FIXED_BENCH_NAME, names[n], sim.isrCalls[n], ns);
+	}
+	printf("%s all handlers %7.1f ns per PWM period (clock read %.1f ns subtracted)\n",
+				 FIXED_BENCH_NAME, totalNs / FIXED_BENCH_PERIODS, clockNs);
+}
+
+int main(int argc, char** argv){
+	FILE* pFile;
+	int replay;
+	int ok = 1;
+
+	if((argc != 3) || (strcmp(argv[1], "record") && strcmp(argv[1], "replay")))
+	{
+		fprintf(stderr, "usage: %s record|replay <file>\n", argv[0]);
+		return 2;
+	}
+	replay = (strcmp(argv[1], "replay") == 0);
+	traceLen = FIXED_BENCH_PERIODS + 22000U;
+	pTrace = calloc(traceLen, sizeof(benchRecord_t));
+	if(pTrace == 0) { return 2; }
+
+	if(replay)
+	{
+		pFile = fopen(argv[2], "rb");
+		if((pFile == 0) || (fread(pTrace, sizeof(benchRecord_t), traceLen, pFile) != traceLen))
+		{
+			fprintf(stderr, "%s: no trace of %u periods\n", argv[2], traceLen);
+			return 2;
+		}
+		fclose(pFile);
+	}
+
+	benchRun(replay);
+	benchReport();
+
+	if(replay)
+	{
+		printf("duty against the recorded variant: %u of %u periods differ, max %u counts\n",
+					 dutyDiffs, traceLen, dutyDiffMax);
+		ok = (dutyDiffMax <= FIXED_BENCH_DUTY_TOL);
+	}
+	else
+	{
+		pFile = fopen(argv[2], "wb");
+		if((pFile == 0) || (fwrite(pTrace, sizeof(benchRecord_t), traceLen, pFile) != traceLen)) { return 2; }
+		fclose(pFile);
+	}
+
+	printf("%s\n", ok ? "PASS" : "FAIL");
+	return ok ? 0 : 1;
+}
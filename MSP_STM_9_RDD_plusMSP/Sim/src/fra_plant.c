@@ -0,0 +1,216 @@
+/*
+ * fra_plant.c
+ *
+ *  Created on: 17 OCT. 2026
+ *  fraStart / fraStep on the plant: the measured response against the linearised model
+ *
+ *  The Vin loop holds the string at FRA_PLANT_VIN, spread spectrum off so every period is
+ *  BUCK_PERIOD. One plantStep around the operating point is linearised by central
+ *  differences: s' = A s + B x, the period averages y = C s + E x, state Vin, Vout, iL,
+ *  x the duty ratio. The sample of a period sets the duty of the next one, so the plant
+ *  the FRA sees is
+ *    G(z) = z^-1 * (Cvin (zI - A)^-1 B + Evin)      z = e^(jwT)
+ *  and the loop closes over the PI of the Vin loop on the error / 2^DCDC_PID_VIN_SHIFT
+ *  and the feed-forward duty Vout / Vin:
+ *    T(z) = -((Kp + Ki - Kp z^-1) / (1 - z^-1) / 2^shift - Vout / Vin^2) * G - Gvout / Vin
+ *  Every point must match G and T within FRA_PLANT_DB and FRA_PLANT_DEG. The bin of the
+ *  injection is in X = U + D: without D = -j * A * N / 2 the loop would read T = -1,
+ *  0 dB at 180 deg, at every frequency.
+ *  The limits are set past the clamp of their errors (PID_ERROR_LIMIT), a limit loop then
+ *  proposes the output plus Ki * 0.5 pu and the Vin loop keeps the selection while its
+ *  step per period stays below. Around the peak of the closed loop, 300 Hz to 1.2 kHz,
+ *  |1 + T| is small and DCDC_FRA_AMPLITUDE would step the output past that: the band is
+ *  measured with FRA_PLANT_HIGH_DIV less. Above it the response of the smaller injection
+ *  is below an LSB of the Vin sample, the sim has no noise to dither it.
+ */
+
+#include <stdio.h>
+#include <math.h>
+#include <complex.h>
+#include "sim.h"
+#include "dcdc.h"
+#include "fra.h"
+#include "spread.h"
+#include "HiResTim.h"
+
+#define FRA_PLANT_VIN					240.0f															// V
+#define FRA_PLANT_DB					0.5f																// dB
+#define FRA_PLANT_DEG					3.0f																// deg
+#define FRA_PLANT_V_OUT_MAX		170.0f															// V, battery about 125 V
+#define FRA_PLANT_I_OUT_MAX		90.0f																// A, about 48 A
+#define FRA_PLANT_HIGH_DIV		5																		// of DCDC_FRA_AMPLITUDE, the band of the peak
+#define FRA_PLANT_PERIODS			200000U															// the points end before
+#define FRA_PLANT_STATES			3
+
+static plant_t fraBase, fraProbe;
+static double fraA[FRA_PLANT_STATES][FRA_PLANT_STATES], fraB[FRA_PLANT_STATES];
+static double fraC[2][FRA_PLANT_STATES], fraE[2];												// Vin, Vout averages
+static double fraDuty, fraPeriod, fraDtRise, fraDtFall;
+
+/******************************************************************************************
+*  One period of the plant from the base point, state k moved by ds, the duty by dx
+*******************************************************************************************/
+static void fraProbeStep(int8_t k, double ds, double dx, double* pState, double* pAvg){
+	float duty = (float)(fraDuty + dx);
+
+	fraProbe = fraBase;
+	if(k == 0) { fraProbe.vIn += (float)ds; }
+	if(k == 1) { fraProbe.vOut += (float)ds; }
+	if(k == 2) { fraProbe.iL[0] += (float)ds; }
+	plantStep(&fraProbe, (float)fraPeriod, &duty, 1, (float)fraDtRise, (float)fraDtFall);
+	pState[0] = fraProbe.vIn;
+	pState[1] = fraProbe.vOut;
+	pState[2] = fraProbe.iL[0];
+	pAvg[0] = fraProbe.avgVin;
+	pAvg[1] = fraProbe.avgVout;
+}
+
+static void fraLinearise(void){
+	static const double step[FRA_PLANT_STATES + 1] = { 0.05, 0.05, 0.5, 0.002 };	// V, V, A, duty
+	uint32_t dtr = simHrtim1.sTimerxRegs[TIM_A].DTxR;
+	double tdtg = (double)(1U << ((dtr & HRTIM_DTR_DTPRSC) >> HRTIM_DTR_DTPRSC_Pos)) * (1.0 / 8.0);
+	uint8_t k, i;
+
+	fraBase = sim.plant;
+	fraDuty = sim.duty[0];
+	fraPeriod = BUCK_PERIOD * (1.0 / SIM_HRTIM_HZ);
+	fraDtRise = ((dtr & HRTIM_DTR_DTR) >> HRTIM_DTR_DTR_Pos) * tdtg;
+	fraDtFall = ((dtr & HRTIM_DTR_DTF) >> HRTIM_DTR_DTF_Pos) * tdtg;
+	for(k = 0; k <= FRA_PLANT_STATES; k++){
+		double sHi[FRA_PLANT_STATES], sLo[FRA_PLANT_STATES], yHi[2], yLo[2];
+		double h = step[k];
+
+		if(k < FRA_PLANT_STATES)
+		{
+			fraProbeStep(k, h, 0.0, sHi, yHi);
+			fraProbeStep(k, -h, 0.0, sLo, yLo);
+		}
+		else
+		{
+			fraProbeStep(-1, 0.0, h, sHi, yHi);
+			fraProbeStep(-1, 0.0, -h, sLo, yLo);
+		}
+		for(i = 0; i < FRA_PLANT_STATES; i++){
+			double d = (sHi[i] - sLo[i]) / (2.0 * h);
+			if(k < FRA_PLANT_STATES) { fraA[i][k] = d; } else { fraB[i] = d; }
+		}
+		for(i = 0; i < 2; i++){
+			double d = (yHi[i] - yLo[i]) / (2.0 * h);
+			if(k < FRA_PLANT_STATES) { fraC[i][k] = d; } else { fraE[i] = d; }
+		}
+	}
+}
+
+/******************************************************************************************
+*  G of the Vin and of the Vout average at f: (zI - A) w = B by elimination, z^-1 delay
+*******************************************************************************************/
+static void fraModel(double f, double complex* pGvin, double complex* pGvout){
+	double complex z = cexp(I * 2.0 * M_PI * f * fraPeriod);
+	double complex m[FRA_PLANT_STATES][FRA_PLANT_STATES + 1];
+	double complex w[FRA_PLANT_STATES];
+	uint8_t r, c, k;
+
+	for(r = 0; r < FRA_PLANT_STATES; r++){
+		for(c = 0; c < FRA_PLANT_STATES; c++){
+			m[r][c] = ((r == c) ? z : 0.0) - fraA[r][c];
+		}
+		m[r][FRA_PLANT_STATES] = fraB[r];
+	}
+	for(k = 0; k < FRA_PLANT_STATES; k++){
+		for(r = k + 1; r < FRA_PLANT_STATES; r++){
+			double complex q = m[r][k] / m[k][k];
+			for(c = k; c <= FRA_PLANT_STATES; c++){
+				m[r][c] -= q * m[k][c];
+			}
+		}
+	}
+	for(k = FRA_PLANT_STATES; k-- > 0;){
+		double complex s = m[k][FRA_PLANT_STATES];
+		for(c = k + 1; c < FRA_PLANT_STATES; c++){
+			s -= m[k][c] * w[c];
+		}
+		w[k] = s / m[k][k];
+	}
+	*pGvin = fraE[0];
+	*pGvout = fraE[1];
+	for(k = 0; k < FRA_PLANT_STATES; k++){
+		*pGvin += fraC[0][k] * w[k];
+		*pGvout += fraC[1][k] * w[k];
+	}
+	*pGvin /= z;
+	*pGvout /= z;
+}
+
+static double complex fraLoopModel(double f, double complex g, double complex gVout){
+	double complex zInv = cexp(-I * 2.0 * M_PI * f * fraPeriod);
+	double complex pi = (DCDC_PID_KP + DCDC_PID_KI - DCDC_PID_KP * zInv) / (1.0 - zInv) / (double)(1U << DCDC_PID_VIN_SHIFT);
+	double vIn = fraBase.avgVin, vOut = fraBase.avgVout;
+
+	return -(pi - vOut / (vIn * vIn)) * g - gVout / vIn;
+}
+
+static double fraDegDiff(double a, double b){
+	double d = fmod(a - b + 540.0, 360.0) - 180.0;
+	return fabs(d);
+}
+
+/******************************************************************************************
+*  The points of a list measured with amp, each against the model
+*******************************************************************************************/
+static int fraCheck(const uint16_t* pFreq, uint16_t points, float amp){
+	uint32_t periods;
+	uint16_t n;
+	int ok;
+
+	fraStart(pFreq, points, (int32_t)(amp * 2147483648.0f));
+	for(periods = 0; (periods < FRA_PLANT_PERIODS) && (DCDC_getFraState() == FRA_RUNNING); periods++){
+		simPeriod();
+	}
+	printf("amplitude %.4f: state %u after %u periods, %u of %u points\n", amp, DCDC_getFraState(), periods, DCDC_getFraPointsNum(), points);
+	ok = (DCDC_getFraState() == FRA_DONE) && (DCDC_getFraPointsNum() == points);
+
+	printf("    Hz  plant dB   deg  model dB   deg   loop dB   deg  model dB   deg\n");
+	for(n = 0; n < DCDC_getFraPointsNum(); n++){
+		float f, plantDb, plantDeg, loopDb, loopDeg;
+		double complex g, gVout, t;
+		double gDb, gDeg, tDb, tDeg;
+		int good;
+
+		if(DCDC_getFraPoint(n, &f, &plantDb, &plantDeg, &loopDb, &loopDeg) != 0) { ok = 0; continue; }
+		fraModel(f, &g, &gVout);
+		t = fraLoopModel(f, g, gVout);
+		gDb = 20.0 * log10(cabs(g));
+		gDeg = carg(g) * (180.0 / M_PI);
+		tDb = 20.0 * log10(cabs(t));
+		tDeg = carg(t) * (180.0 / M_PI);
+		good = (fabs(plantDb - gDb) <= FRA_PLANT_DB) && (fraDegDiff(plantDeg, gDeg) <= FRA_PLANT_DEG) &&
+					 (fabs(loopDb - tDb) <= FRA_PLANT_DB) && (fraDegDiff(loopDeg, tDeg) <= FRA_PLANT_DEG);
+		printf("%6.0f  %8.2f %5.0f  %8.2f %5.0f  %8.2f %5.0f  %8.2f %5.0f%s\n", f, plantDb, plantDeg, gDb, gDeg,
+					 loopDb, loopDeg, tDb, tDeg, good ? "" : "  <-");
+		ok &= good;
+	}
+	return ok;
+}
+
+int main(void){
+	static const uint16_t low[] = { 20, 25, 32, 41, 52, 66, 84, 107, 136, 174, 221, 280 };			// Hz, the sweep of DCDC_startFra(0)
+	static const uint16_t high[] = { 357, 453, 576, 733, 931, 1184 };
+	plantParam_t param;
+	int ok = 1;
+
+	plantDefault(&param);
+	simInit(&param);
+	simRun(2000);
+	simStart(FRA_PLANT_VIN, FRA_PLANT_V_OUT_MAX, FRA_PLANT_I_OUT_MAX);
+	ok &= (spreadSetProfile(SPREAD_OFF, 0, 0) == 0);
+	simRun(20000);
+	fraLinearise();
+	printf("operating point: Vin %.2f V, Vout %.2f V, iL %.2f A, duty %.4f\n", fraBase.avgVin, fraBase.avgVout, fraBase.iL[0], fraDuty);
+
+	ok &= fraCheck(low, sizeof(low) / sizeof(low[0]), DCDC_FRA_AMPLITUDE);
+	ok &= fraCheck(high, sizeof(high) / sizeof(high[0]), DCDC_FRA_AMPLITUDE / FRA_PLANT_HIGH_DIV);
+	ok &= (DCDC_getFault() == DCDC_FAULT_NONE);
+
+	printf("%s\n", ok ? "PASS" : "FAIL");
+	return ok ? 0 : 1;
+}
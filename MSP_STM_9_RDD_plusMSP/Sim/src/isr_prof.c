@@ -0,0 +1,164 @@
+/*
+ * isr_prof.c
+ *
+ *  Created on: 17 OCT. 2026
+ *  Binning of the ISR profiler, against a simulated DWT cycle counter
+ *
+ *  isrProfRecord with the edges of the log2 bins, the open last bin and the saturation of
+ *  a bin. Then the closed loop with CYCCNT stepping simDwtStep per read: ISR_PROF_ENTER
+ *  and ISR_PROF_EXIT read it once each, so every ADC1_2 call is charged exactly the step,
+ *  on both sides of a bin edge. The control latency probe is checked the same way with
+ *  the HRTIM counts the sim adds after JEOS. Its worst case must fit the budget of every
+ *  period, read from the register model: the CMP1 write is preloaded for the next period,
+ *  so from the trigger the budget is PERxR - CMP2xR counts. A latency pushed past the
+ *  period end must show as out of the budget.
+ */
+
+#include <stdio.h>
+#include "sim.h"
+#include "isrprof.h"
+#include "HiResTim.h"
+
+static int fails;
+static uint32_t budgetMin;																						// cycles, the shortest trigger to period end
+static uint32_t latencyMax;																					// cycles, from the counter of Timer A
+static uint16_t trigLast;																							// CMP2 of the running period
+
+static void check(int cond, const char* pWhat){
+	if(!cond) { printf("FAIL: %s\n", pWhat); fails++; }
+}
+
+/******************************************************************************************
+*  Cycles -> bin: 2^n <= cycles < 2^(n+1), 0 goes to bin 0, from 2^15 all in the last bin
+*******************************************************************************************/
+static void testBins(void){
+	static const uint32_t cycles[] = { 0, 1, 2, 3, 4, 7, 8, 255, 256, 32767, 32768, 1UL << 20, 0xFFFFFFFFUL };
+	static const uint8_t bins[] = { 0, 0, 1, 1, 2, 2, 3, 7, 8, 14, 15, 15, 15 };
+	isrProfStat_t stat;
+	uint64_t sum = 0;
+	uint32_t i;
+
+	for(i = 0; i < sizeof(cycles) / sizeof(cycles[0]); i++){
+		uint16_t before;
+		isrProfGet(ISR_PROF_TIM3, &stat);
+		before = stat.bins[bins[i]];
+		isrProfRecord(ISR_PROF_TIM3, cycles[i]);
+		isrProfGet(ISR_PROF_TIM3, &stat);
+		if(stat.bins[bins[i]] != before + 1)
+		{
+			printf("%u cycles: not in bin %u\n", cycles[i], bins[i]);
+			fails++;
+		}
+		sum += cycles[i];
+	}
+	check(stat.count == sizeof(cycles) / sizeof(cycles[0]), "count");
+	check(stat.min == 0, "min");
+	check(stat.max == 0xFFFFFFFFUL, "max");
+	check(stat.sum == sum, "sum");
+
+	for(i = 0; i < 70000; i++){
+		isrProfRecord(ISR_PROF_SYSTICK, 100);
+	}
+	isrProfGet(ISR_PROF_SYSTICK, &stat);
+	check(stat.bins[6] == 0xFFFF, "bin saturates at 0xFFFF");
+	check(stat.count == 70000, "count past the saturation");
+	check(stat.sum == 7000000ULL, "sum past the saturation");
+
+	isrProfReset();
+	isrProfGet(ISR_PROF_TIM3, &stat);
+	check((stat.count == 0) && (stat.min == 0xFFFFFFFFUL) && (stat.max == 0) && (stat.bins[15] == 0), "reset");
+}
+
+/******************************************************************************************
+*  Every ADC1_2 call of a run is charged step cycles
+*******************************************************************************************/
+static void testHandler(uint32_t step, uint8_t bin){
+	isrProfStat_t stat;
+	uint32_t calls;
+
+	simDwtStep = step;
+	isrProfReset();
+	calls = sim.adcIrqs;
+	simRun(2000);
+	calls = sim.adcIrqs - calls;
+	isrProfGet(ISR_PROF_ADC1_2, &stat);
+	printf("step %u: %u ADC1_2 calls, min %u max %u, bin %u %u\n", step, calls, stat.min, stat.max, bin, stat.bins[bin]);
+	check((calls != 0) && (stat.count == calls), "one record per ADC1_2 call");
+	check((stat.min == step) && (stat.max == step), "the simulated cycles");
+	check(stat.bins[bin] == calls, "the bin of the step");
+	check(stat.sum == (uint64_t)step * calls, "sum of the calls");
+}
+
+/******************************************************************************************
+*  Latency: trigger (CMP2) to the duty write, the sim adds ctrlCounts to the JEOS time
+*******************************************************************************************/
+static void testLatency(uint32_t counts, uint8_t bin){
+	isrProfStat_t stat;
+	uint32_t cycles = (SIM_JEOS_COUNTS + counts) >> 4;
+
+	sim.ctrlCounts = counts;
+	isrProfReset();
+	simRun(2000);
+	isrProfGet(ISR_PROF_CTRL_LATENCY, &stat);
+	printf("latency %u cycles: %u records, min %u max %u, bin %u %u\n", cycles, stat.count, stat.min, stat.max, bin, stat.bins[bin]);
+	check(stat.count != 0, "latency records");
+	check((stat.min == cycles) && (stat.max == cycles), "latency cycles");
+	check(stat.bins[bin] == stat.count, "latency bin");
+}
+
+/******************************************************************************************
+*  After the handlers of a period: CNTxR at the duty write and CMP2 the period ran with
+*******************************************************************************************/
+static void budgetHook(void){
+	HRTIM_Timerx_TypeDef* pTimA = &simHrtim1.sTimerxRegs[TIM_A];
+	uint32_t budget = (pTimA->PERxR - trigLast) >> 4;
+	uint32_t latency = (uint16_t)(pTimA->CNTxR - trigLast) >> 4;
+
+	if(budget < budgetMin) { budgetMin = budget; }
+	if(latency > latencyMax) { latencyMax = latency; }
+	trigLast = pTimA->CMP2xR;
+}
+
+static void testBudget(uint32_t counts, int within){
+	isrProfStat_t stat;
+
+	sim.ctrlCounts = counts;
+	simRun(10);
+	isrProfReset();
+	budgetMin = 0xFFFFFFFFUL;
+	latencyMax = 0;
+	trigLast = simHrtim1.sTimerxRegs[TIM_A].CMP2xR;
+	sim.pHook = budgetHook;
+	simRun(2000);
+	sim.pHook = 0;
+	isrProfGet(ISR_PROF_CTRL_LATENCY, &stat);
+	printf("trigger to duty: worst %u cycles, register model %u, budget %u cycles to the period end\n", stat.max, latencyMax, budgetMin);
+	check(stat.max == latencyMax, "latency entry against the counter of Timer A");
+	check((stat.max <= budgetMin) == within, within ? "duty written within the period" : "overrun not out of the budget");
+}
+
+int main(void){
+	plantParam_t param;
+
+	plantDefault(&param);
+	simInit(&param);
+	testBins();
+
+	simRun(2000);
+	simStart(240.0f, 150.0f, 80.0f);
+	simRun(2000);
+	testHandler(100, 6);
+	testHandler(127, 6);
+	testHandler(128, 7);
+	testHandler(40000, 15);
+	simDwtStep = 0;
+
+	testLatency(0, 6);																											// 80 cycles of the conversions
+	testLatency(16 * 176, 8);																								// 256 cycles
+	testBudget(0, 1);
+	testBudget(BUCK_PERIOD / 2, 0);																					// past the period end at any duty
+	sim.ctrlCounts = 0;
+
+	printf("%s\n", fails ? "FAIL" : "PASS");
+	return fails ? 1 : 0;
+}
@@ -0,0 +1,129 @@
+/*
+ * iv_trace.c
+ *
+ *  Created on: 17 OCT. 2026
+ *  I-V curve trace from COMMAND_IV_TRACE to the CSV of the pages
+ *
+ *  The protocol end to end: the trace is started by a TYPE_COMMAND packet through the
+ *  receive interrupt and read back as TYPE_IV_CURVE pages through the transmit interrupt
+ *  (uart.h), each reply checked for framing and CRC. Before the trace the reply is page 0
+ *  of no points, during it the pages of the points done so far. Once done, one request
+ *  more than the pages of the curve must walk every page in turn and wrap from the last
+ *  one to page 0; the points past the last one are 0 and a new trace starts at page 0.
+ *  The curve is written to iv_trace.csv and read back: every point must be on the string
+ *  curve of the plant (plantPvCurrent at its Vin) within IV_CURR_TOL, the sweep must run
+ *  from Vout / DUTY_MAX to the open circuit and its maximum must be the one of the plant
+ *  within IV_MPP_TOL. The sweep started at DUTY_MIN before: from a running operating
+ *  point the buck boosted the battery into the input, -830 A and Vin 1000 V in the sim.
+ */
+
+#include <stdio.h>
+#include <math.h>
+#include "sim.h"
+#include "uart.h"
+#include "ivcsv.h"
+#include "dcdc.h"
+
+#define IV_FILE								"iv_trace.csv"
+#define IV_CURR_TOL						0.4f																// A, 1.5 % of Isc
+#define IV_MPP_TOL						0.01f																// of the maximum of the plant
+#define IV_VOC_NEAR						0.98f																// of Voc, the last point
+#define IV_VOUT_NEAR					1.1f																// of Vout / DUTY_MAX, the first point, with the drop of the inductor
+
+static ivCsv_t curve;
+
+/******************************************************************************************
+*  The CSV back, every point against the curve of the plant
+*******************************************************************************************/
+static int checkCsv(void){
+	FILE* pFile = fopen(IV_FILE, "r");
+	char line[128];
+	float vFirst = 0.0f, vLast = 0.0f, pMax = 0.0f, vAtMax = 0.0f, errMax = 0.0f, vMpp, pMpp;
+	uint32_t rows = 0, outside = 0;
+
+	if(pFile == 0) { return 0; }
+	if(fgets(line, sizeof(line), pFile) == 0) { fclose(pFile); return 0; }
+	while(fgets(line, sizeof(line), pFile) != 0){
+		unsigned n;
+		float duty, vIn, iIn, pIn, err;
+		if(sscanf(line, "%u,%f,%f,%f,%f", &n, &duty, &vIn, &iIn, &pIn) != 5) { break; }
+		if(n != rows) { break; }
+		err = fabsf(iIn - plantPvCurrent(&sim.plant, vIn));
+		if(err > errMax) { errMax = err; }
+		if(err > IV_CURR_TOL) { outside++; }
+		if(rows == 0) { vFirst = vIn; }
+		vLast = vIn;
+		if(pIn > pMax) { pMax = pIn; vAtMax = vIn; }
+		rows++;
+	}
+	fclose(pFile);
+
+	pMpp = plantPvMpp(&sim.plant, &vMpp);
+	printf("%s: %u points, Vin %.1f..%.1f V, Iin %.3f A off the string curve at most, %u beyond %.2f A\n",
+				 IV_FILE, rows, vFirst, vLast, errMax, outside, IV_CURR_TOL);
+	printf("maximum %.0f W at %.1f V, the plant %.0f W at %.1f V\n", pMax, vAtMax, pMpp, vMpp);
+	return (rows == curve.points) && (outside == 0) && (vLast >= IV_VOC_NEAR * sim.plant.p.pvVoc)
+				 && (vFirst <= IV_VOUT_NEAR * sim.plant.avgVout * BUCK_PERIOD / DUTY_MAX)
+				 && (fabsf(pMax - pMpp) <= IV_MPP_TOL * pMpp);
+}
+
+int main(void){
+	plantParam_t param;
+	command_t response;
+	ivCurve_t page;
+	FILE* pFile;
+	uint32_t n, pages, wrapFails = 0, tailFails = 0;
+	int ok = 1;
+
+	plantDefault(&param);
+	simInit(&param);
+	simRun(2000);
+	simStart(240.0f, 150.0f, 80.0f);
+	simRun(20000);
+	uartInit();
+	ivCsvInit(&curve);
+
+	ok &= (uartRequest(TYPE_IV_CURVE, VERSION_IV_CURVE, page.bytes, sizeof(ivCurve_t)) == 0);
+	printf("before the trace: page %u, %u points, state %u\n", page.page, page.points, page.state);
+	ok &= (page.page == 0) && (page.points == 0) && (page.state == IVTRACE_IDLE) && (page.vIn[0] == 0.0f);
+
+	ok &= (uartCommand(COMMAND_IV_TRACE, 0, &response) == 0) && (response.commandCode == COMMAND_IV_TRACE) && (response.arg == 1);
+	simRun(IVTRACE_PERIODS / 4);
+	ok &= (uartRequest(TYPE_IV_CURVE, VERSION_IV_CURVE, page.bytes, sizeof(ivCurve_t)) == 0);
+	printf("running:          page %u, %u points, state %u\n", page.page, page.points, page.state);
+	ok &= (page.page == 0) && (page.state == IVTRACE_RUNNING) && (page.points > 0);
+	ok &= (ivCsvAddPage(&curve, &page) == 0);
+	for(n = 0; (n < 2 * IVTRACE_PERIODS) && (ivTraceState == IVTRACE_RUNNING); n++){
+		simPeriod();
+	}
+	pages = (ivTraceGetPointsNum() + IV_CURVE_PAGE_POINTS - 1) / IV_CURVE_PAGE_POINTS;
+
+	/* pages 1.. after page 0 of the running trace, the last one back to 0 */
+	for(n = 1; n <= pages + 1; n++){
+		uint16_t i;
+		if(uartRequest(TYPE_IV_CURVE, VERSION_IV_CURVE, page.bytes, sizeof(ivCurve_t)) || (page.page != n % pages)) { wrapFails++; continue; }
+		for(i = 0; i < IV_CURVE_PAGE_POINTS; i++){
+			if((page.page * IV_CURVE_PAGE_POINTS + i >= page.points) && ((page.vIn[i] != 0.0f) || (page.iIn[i] != 0.0f))) { tailFails++; }
+		}
+		ivCsvAddPage(&curve, &page);
+	}
+	printf("after the trace:  %u points, state %u, %u requests, %u off the page order, %u points past the last one not 0\n",
+				 curve.points, curve.state, pages + 1, wrapFails, tailFails);
+	ok &= (pages > 1) && (curve.points > IVTRACE_POINTS / 4) && (curve.state == IVTRACE_DONE) && (wrapFails == 0) && (tailFails == 0);
+
+	pFile = fopen(IV_FILE, "w");
+	ok &= (pFile != 0) && (ivCsvWrite(&curve, pFile) == 0);
+	if(pFile != 0) { fclose(pFile); }
+	ok &= checkCsv();
+
+	ok &= (uartRequest(TYPE_IV_CURVE, VERSION_IV_CURVE, page.bytes, sizeof(ivCurve_t)) == 0) && (page.page == (pages + 2) % pages);
+	ok &= (uartCommand(COMMAND_IV_TRACE, 0, &response) == 0) && (response.arg == 1);
+	simRun(IVTRACE_PERIODS / 4);
+	ok &= (uartRequest(TYPE_IV_CURVE, VERSION_IV_CURVE, page.bytes, sizeof(ivCurve_t)) == 0);
+	printf("new trace:        page %u, %u points, state %u\n", page.page, page.points, page.state);
+	ok &= (page.page == 0) && (page.state == IVTRACE_RUNNING);
+	ok &= (DCDC_getFault() == DCDC_FAULT_NONE);
+
+	printf("%s\n", ok ? "PASS" : "FAIL");
+	return ok ? 0 : 1;
+}
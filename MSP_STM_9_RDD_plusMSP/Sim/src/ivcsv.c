@@ -0,0 +1,55 @@
+/*
+ * ivcsv.c
+ *
+ *  Created on: 17 OCT. 2026
+ *  The pages of TYPE_IV_CURVE back to the I-V curve, see ivcsv.h
+ */
+
+#include <string.h>
+#include "ivcsv.h"
+
+void ivCsvInit(ivCsv_t* pCurve){
+	memset(pCurve, 0, sizeof(*pCurve));
+}
+
+int ivCsvAddPage(ivCsv_t* pCurve, const ivCurve_t* pPage){
+	uint16_t i;
+
+	if((pPage->page >= IVCSV_PAGES) || (pPage->points > IVTRACE_POINTS)) { return -1; }
+	pCurve->points = pPage->points;
+	pCurve->state = pPage->state;
+	pCurve->pageSeen[pPage->page] = 1;
+	for(i = 0; i < IV_CURVE_PAGE_POINTS; i++){
+		uint16_t n = pPage->page * IV_CURVE_PAGE_POINTS + i;
+		if(n >= IVTRACE_POINTS) { break; }
+		pCurve->vIn[n] = pPage->vIn[i];
+		pCurve->iIn[n] = pPage->iIn[i];
+	}
+	return 0;
+}
+
+int ivCsvComplete(const ivCsv_t* pCurve){
+	uint16_t page;
+
+	for(page = 0; page * IV_CURVE_PAGE_POINTS < pCurve->points; page++){
+		if(!pCurve->pageSeen[page]) { return 0; }
+	}
+	return 1;
+}
+
+/******************************************************************************************
+*  One row per point, the duty is the mean of the 2^IVTRACE_AVERAGE_LOG2 periods summed
+*  into it, each sample converted with the duty of the period before
+*******************************************************************************************/
+int ivCsvWrite(const ivCsv_t* pCurve, FILE* pFile){
+	uint16_t n;
+
+	if(!ivCsvComplete(pCurve)) { return -1; }
+	fprintf(pFile, "point,duty,vIn,iIn,pIn\n");
+	for(n = 0; n < pCurve->points; n++){
+		double period = ((double)n + 0.5) * (1U << IVTRACE_AVERAGE_LOG2) - 0.5;
+		double duty = (DUTY_MAX - (double)(DUTY_MAX - DUTY_MIN) * period / IVTRACE_PERIODS) / BUCK_PERIOD;
+		fprintf(pFile, "%u,%.4f,%.2f,%.3f,%.1f\n", n, duty, pCurve->vIn[n], pCurve->iIn[n], pCurve->vIn[n] * pCurve->iIn[n]);
+	}
+	return 0;
+}
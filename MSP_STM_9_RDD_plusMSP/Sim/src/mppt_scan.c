@@ -0,0 +1,116 @@
+/*
+ * mppt_scan.c
+ *
+ *  Created on: 17 OCT. 2026
+ *  Trigger and duration of the global maximum scan, and the scan on a multi-peak I-V curve
+ *
+ *  Trigger: the scan must start mpptScanInterval after the tracker does and then every
+ *  mpptScanInterval of tracking, each one lasting mpptScanDuration (64 whole dwells of
+ *  ticks, SCAN_DURATION_TOL); no scan with mpptScanInterval 0.
+ *  Multi-peak: eight bypass groups, two at 30%. The local maximum near the Voc side holds
+ *  less than half the power of the global one at about 180 V, the hill climber starting
+ *  from the fractional Voc point stays on it. With the scan the string must end within
+ *  SCAN_VIN_TOL of the global maximum and harvest SCAN_EFF_MIN of it after the first scan.
+ */
+
+#include <stdio.h>
+#include <math.h>
+#include "sim.h"
+#include "msp.h"
+#include "mppt.h"
+#include "dcdc.h"
+
+#define SCAN_INTERVAL					4.0f																// s
+#define SCAN_DURATION					500.0f															// ms
+#define SCAN_DURATION_TOL			0.05f																// dwells of whole ticks
+#define SCAN_POLL							0.001																// s
+#define SCAN_SHADE						0.3f
+#define SCAN_VIN_TOL					5.0f																// V
+#define SCAN_EFF_MIN					0.95f																// after the first scan
+#define SCAN_TRACKER_START		0.5																	// s, MSP_NO_MEAS_TICKS
+#define SCAN_SHADED_INTERVAL	30.0f																// s, no second scan in the window
+#define SCAN_SHADED_WINDOW		20.0																// s
+
+/******************************************************************************************
+*  Scan starts and their lengths over seconds of tracking
+*******************************************************************************************/
+static int testTrigger(float interval){
+	plantParam_t param;
+	double start = 0.0, t0, last = -1.0;
+	uint32_t scans = 0, spacingFails = 0, durationFails = 0;
+	int scanning = 0;
+	int ok;
+
+	plantDefault(&param);
+	simInit(&param);
+	simRun(2000);
+	mspInit(MPPT_MODE_PO, interval, SCAN_DURATION);
+	t0 = sim.time;
+	while(sim.time - t0 < 6.0 * SCAN_INTERVAL){
+		mspRun(SCAN_POLL);
+		if(MPPT_isScanning() == scanning) { continue; }
+		scanning = MPPT_isScanning();
+		if(scanning)
+		{
+			double expect = (last < 0.0) ? t0 + SCAN_TRACKER_START + interval : last + interval;
+			if(fabs(sim.time - expect) > 2.0 * SCAN_POLL) { spacingFails++; }
+			start = sim.time;
+			scans++;
+		}
+		else
+		{
+			double ms = (sim.time - start) * 1e3;
+			if(fabs(ms - SCAN_DURATION) > SCAN_DURATION * SCAN_DURATION_TOL) { durationFails++; }
+			if(scans == 1) { printf("interval %.0f s: first scan at %.3f s, %.1f ms\n", interval, start - t0, ms); }
+			last = sim.time;
+		}
+	}
+	printf("interval %.0f s: %u scans, %u off their start, %u off their duration\n", interval, scans, spacingFails, durationFails);
+	ok = (spacingFails == 0) && (durationFails == 0) && (DCDC_getFault() == DCDC_FAULT_NONE);
+	return ok && ((interval > 0.0f) ? (scans >= 5) : (scans == 0));
+}
+
+/******************************************************************************************
+*  The shaded string with the scan every interval s, 0 - none
+*******************************************************************************************/
+static float testShaded(float interval, float* pVin){
+	plantParam_t param;
+	double t0;
+	float eff;
+
+	plantDefault(&param);
+	param.pvGroups = 8;
+	param.vBat = 80.0f;																															// the global maximum above Vout / DUTY_MAX
+	simInit(&param);
+	simRun(2000);
+	mspInit(MPPT_MODE_PO, interval, 2000.0f);																			// fraction from the unshaded curve
+	mspIrradiance(6, SCAN_SHADE);
+	mspIrradiance(7, SCAN_SHADE);
+	t0 = sim.time;
+	mspRun(SCAN_TRACKER_START + ((interval > 0.0f) ? interval + 2.5 : 12.5));							// to after the first scan
+	msp.ePv = 0.0;
+	msp.eMpp = 0.0;
+	mspRun(SCAN_SHADED_WINDOW);
+	eff = mspEfficiency();
+	*pVin = sim.plant.avgVin;
+	printf("scan %s: Vin %.1f V, global maximum %.0f W at %.1f V, efficiency %.1f%%, %.0f s, fault %u\n",
+				 (interval > 0.0f) ? "on " : "off", *pVin, msp.pMpp, msp.vMpp, eff * 100.0f, sim.time - t0, DCDC_getFault());
+	return (DCDC_getFault() == DCDC_FAULT_NONE) ? eff : 0.0f;
+}
+
+int main(void){
+	float vOff, vOn, effOff, effOn;
+	int ok = 1;
+
+	ok &= testTrigger(SCAN_INTERVAL);
+	ok &= testTrigger(0.0f);
+
+	effOff = testShaded(0.0f, &vOff);
+	effOn = testShaded(SCAN_SHADED_INTERVAL, &vOn);
+	ok &= (fabsf(vOff - msp.vMpp) > 4.0f * SCAN_VIN_TOL);																// the hill climber alone stays on the local maximum
+	ok &= (fabsf(vOn - msp.vMpp) < SCAN_VIN_TOL);
+	ok &= (effOn >= SCAN_EFF_MIN) && (effOn > effOff);
+
+	printf("%s\n", ok ? "PASS" : "FAIL");
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,167 @@
+/*
+ * mppt_track.c
+ *
+ *  Created on: 17 OCT. 2026
+ *  Decisions of the P&O / incremental conductance tracker and its tracking efficiency
+ *  against the fractional Voc scheme on EN 50530 irradiance ramps
+ *
+ *  The decision table sets the filtered measurements of two tracker periods directly and
+ *  checks the direction and the class of the step (MPPT_STEP_MIN, between, MPPT_STEP_MAX).
+ *  P&O decides on the power change less twice that of the second half of the period, so a
+ *  ramp alone keeps the direction and a ramp over a lost step still reverses.
+ *  The ramps run the tracker of the board in closed loop (msp.h): 30% -> 100% -> 30% of the
+ *  STC irradiance at the 30, 50 and 100 W/m^2/s slopes of the standard, with a dwell at
+ *  each end. Efficiency is the string energy over the energy at the maximum of the present
+ *  curve, from the first ramp on.
+ */
+
+#include <stdio.h>
+#include <math.h>
+#include "sim.h"
+#include "msp.h"
+#include "meas.h"
+#include "mppt.h"
+#include "dcdc.h"
+
+#define MPPT_TRACK_STEP_MIN		0.2f																// V, mppt.c
+#define MPPT_TRACK_STEP_MAX		4.0f
+#define MPPT_TRACK_STEP_TOL		0.15f																// V, two counts of the pv volt base
+#define MPPT_TRACK_TICKS			195																	// MPPT_PERIOD_TICKS
+#define MPPT_TRACK_G_LOW			0.3f																// of 1000 W/m^2
+#define MPPT_TRACK_DWELL			5.0																	// s
+#define MPPT_TRACK_UPDATE			0.01																// s, irradiance steps of a ramp
+#define MPPT_TRACK_EFF_MIN		0.98f																// tracking modes, whole profile
+
+typedef
+	struct{
+		int mode;
+		float v0, i0, p0;																									// first period
+		float v1, i1, p1;																									// second period
+		float pMid;																												// power of its first half, 0 - p1
+		int dir;																													// expected sign of the setpoint move
+		int step;																													// -1 - MPPT_STEP_MIN, 1 - MPPT_STEP_MAX, 0 - between
+		const char* pName;
+} decision_t;
+
+static const decision_t decisions[] = {
+	/* P&O: the first move after MPPT_start is down, from the Voc side */
+	{ MPPT_MODE_PO,       240, 20, 4800,  240, 20, 4850,     0,  -1,  0, "P&O: power up, keep the direction" },
+	{ MPPT_MODE_PO,       240, 20, 4800,  240, 20, 4750,     0,   1,  0, "P&O: power down, reverse" },
+	{ MPPT_MODE_PO,       240, 20, 4800,  240, 20, 6800,     0,  -1,  1, "P&O: large dP, MPPT_STEP_MAX" },
+	{ MPPT_MODE_PO,       240, 20, 4800,  240, 20, 4800,     0,  -1, -1, "P&O: same power, MPPT_STEP_MIN" },
+	{ MPPT_MODE_PO,       240, 20, 4800,  240, 21, 5000,  4900,  -1, -1, "P&O: ramp only, keep the direction" },
+	{ MPPT_MODE_PO,       240, 20, 4800,  240, 21, 4950,  4850,   1,  0, "P&O: ramp over a lost step, reverse" },
+	/* incremental conductance: the sign of dP/dV = I + V * dI/dV */
+	{ MPPT_MODE_INC_COND, 200, 25, 5000,  202, 24.9f, 5030,  0,   1,  0, "IncCond: left of the maximum, up" },
+	{ MPPT_MODE_INC_COND, 250, 20, 5000,  252, 18, 4536,     0,  -1,  1, "IncCond: right of the maximum, down" },
+	{ MPPT_MODE_INC_COND, 240, 20, 4800,  240, 21, 5040,     0,   1, -1, "IncCond: same V, more current, up" },
+	{ MPPT_MODE_INC_COND, 240, 20, 4800,  240, 19, 4560,     0,  -1, -1, "IncCond: same V, less current, down" },
+	{ MPPT_MODE_INC_COND, 240, 20, 4800,  240, 20, 4800,     0,  -1, -1, "IncCond: no change, hold the direction" },
+};
+
+/******************************************************************************************
+*  The filtered measurements of one tracker period, MPPT_PERIOD_TICKS ticks: pMid in the
+*  first half (the sample of dP-P&O), p at the end
+*******************************************************************************************/
+static float trackerPeriod(float v, float i, float p, float pMid){
+	Iq vRef = 0;
+	uint16_t n;
+
+	meas.pvVolt.val = (Iq)(v / meas.pvVolt.base);
+	meas.pvCurr.val = (Iq)(i / meas.pvCurr.base);
+	for(n = 0; n < MPPT_TRACK_TICKS; n++){
+		meas.pvPower.val = (Iq)(((n < MPPT_TRACK_TICKS / 2) ? pMid : p) / meas.pvPower.base);
+		vRef = MPPT_tick();
+	}
+	return vRef * meas.pvVolt.base;
+}
+
+static int testDecisions(void){
+	int fails = 0;
+	uint16_t k;
+
+	meas.outVolt.val = (Iq)(120.0f / meas.outVolt.base);
+	meas.pvOcVolt.val = (Iq)(290.0f / meas.pvOcVolt.base);
+	for(k = 0; k < sizeof(decisions) / sizeof(decisions[0]); k++){
+		const decision_t* pD = &decisions[k];
+		float vStart, vEnd, move, size;
+		int ok;
+
+		MPPT_setMode(pD->mode);
+		MPPT_start((Iq)(pD->v0 / meas.pvVolt.base));
+		vStart = trackerPeriod(pD->v0, pD->i0, pD->p0, pD->p0);
+		vEnd = trackerPeriod(pD->v1, pD->i1, pD->p1, (pD->pMid != 0) ? pD->pMid : pD->p1);
+		move = vEnd - vStart;
+		size = fabsf(move);
+		ok = ((move > 0.0f) == (pD->dir > 0)) && (size > MPPT_TRACK_STEP_MIN - MPPT_TRACK_STEP_TOL);
+		if(pD->step < 0) { ok &= (size < MPPT_TRACK_STEP_MIN + MPPT_TRACK_STEP_TOL); }
+		if(pD->step > 0) { ok &= (fabsf(size - MPPT_TRACK_STEP_MAX) < MPPT_TRACK_STEP_TOL); }
+		if(pD->step == 0) { ok &= (size < MPPT_TRACK_STEP_MAX - MPPT_TRACK_STEP_TOL); }
+		printf("%-40s move %+.2f V %s\n", pD->pName, move, ok ? "" : "FAIL");
+		fails += !ok;
+	}
+	return fails == 0;
+}
+
+/******************************************************************************************
+*  A ramp of the irradiance of every group, slope in W/m^2/s
+*******************************************************************************************/
+static void ramp(float from, float to, float slope){
+	double seconds = fabsf(to - from) * 1000.0f / slope;
+	uint32_t steps = (uint32_t)(seconds / MPPT_TRACK_UPDATE + 0.5);
+	uint32_t n;
+
+	for(n = 1; n <= steps; n++){
+		mspIrradiance(PLANT_PV_GROUPS_MAX, from + (to - from) * n / steps);
+		mspRun(MPPT_TRACK_UPDATE);
+	}
+}
+
+static float testRamps(int mode, const char* pName){
+	static const float slopes[] = { 30.0f, 50.0f, 100.0f };
+	plantParam_t param;
+	uint16_t k;
+	float eff;
+
+	plantDefault(&param);
+	simInit(&param);
+	plantSetIrradiance(&sim.plant, PLANT_PV_GROUPS_MAX, MPPT_TRACK_G_LOW);
+	simRun(2000);
+	mspInit(mode, 0.0f, 0.0f);
+	mspRun(2.0 * MPPT_TRACK_DWELL);																									// start, first sample
+	msp.ePv = 0.0;
+	msp.eMpp = 0.0;
+
+	for(k = 0; k < sizeof(slopes) / sizeof(slopes[0]); k++){
+		ramp(MPPT_TRACK_G_LOW, 1.0f, slopes[k]);
+		mspRun(MPPT_TRACK_DWELL);
+		ramp(1.0f, MPPT_TRACK_G_LOW, slopes[k]);
+		mspRun(MPPT_TRACK_DWELL);
+	}
+	eff = mspEfficiency();
+	printf("%-9s tracking efficiency %.2f%% (%.0f of %.0f kJ), %u open circuit samples, fault %u\n",
+				 pName, eff * 100.0f, msp.ePv * 1e-3, msp.eMpp * 1e-3, msp.samples, DCDC_getFault());
+	return (DCDC_getFault() == DCDC_FAULT_NONE) ? eff : 0.0f;
+}
+
+int main(void){
+	plantParam_t param;
+	float focv, po, incCond;
+	int ok = 1;
+
+	plantDefault(&param);
+	simInit(&param);
+	simRun(2000);
+	mspInit(MPPT_MODE_PO, 0.0f, 0.0f);
+	mspRun(2.0);																																	// the Vin loop active for PWM_isVinRegulated
+	ok &= testDecisions();
+
+	focv = testRamps(MPPT_MODE_FOCV, "FOCV");
+	po = testRamps(MPPT_MODE_PO, "P&O");
+	incCond = testRamps(MPPT_MODE_INC_COND, "IncCond");
+	ok &= (po >= MPPT_TRACK_EFF_MIN) && (po > focv);
+	ok &= (incCond >= MPPT_TRACK_EFF_MIN) && (incCond > focv);
+
+	printf("%s\n", ok ? "PASS" : "FAIL");
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,154 @@
+/*
+ * msp.c
+ *
+ *  Created on: 17 OCT. 2026
+ *  The tracker of the MSP430 code against the sim, see msp.h
+ */
+
+#include <string.h>
+#include "sim.h"
+#include "msp.h"
+#include "meas.h"
+#include "cfg.h"
+#include "pwm.h"
+#include "io.h"
+#include "temp.h"
+#include "mppt.h"
+#include "dcdc.h"
+
+#define MSP_TICK_S						(PWM_PERIOD_US * 1.0e-6)											// CTRL_tick
+#define MSP_SAMPLE_PERIOD_TICKS	(unsigned long)( 10.0 * 1000000.0 / (float)PWM_PERIOD_US )		// ctrl.c
+#define MSP_OPEN_CIRCUIT_TICKS	(unsigned long)( 0.10 * 1000000.0 / (float)PWM_PERIOD_US )
+#define MSP_NO_MEAS_TICKS			(unsigned long)( 0.50 * 1000000.0 / (float)PWM_PERIOD_US )
+
+extern Iq MEAS_filterFast( Iq valNow, Iq valIn );
+extern void MEAS_init();
+extern void MEAS_update();
+extern void MEAS_setDoUpdate( int doUpd );
+
+/* the board parts of the MSP430 code the tracker doesn't use */
+LocalCfg CFG_localCfg;
+RemoteCfg CFG_remoteCfg;
+void CTRL_tick(void) {}
+void IO_fanSenseSpeed(void) {}
+unsigned int TEMP_getValue(void) { return 0; }
+
+msp_t msp;
+
+static unsigned long tickCount;
+static Iq pvVoltFrac;
+static Iq samplePtTarget;
+static Iq samplePtNow;
+static double nextTick;
+
+/******************************************************************************************
+*  pvOcVolt / pvMpVolt of the config from the curve at the present irradiance, Voc from
+*  the string at open circuit
+*******************************************************************************************/
+void mspInit(int mode, float scanInterval, float scanDuration){
+	float vMp;
+
+	memset(&msp, 0, sizeof(msp));
+	memset(&CFG_remoteCfg, 0, sizeof(CFG_remoteCfg));
+	CFG_remoteCfg.pvOcVolt = sim.plant.p.pvVoc;
+	plantPvMpp(&sim.plant, &vMp);
+	CFG_remoteCfg.pvMpVolt = vMp;
+	CFG_remoteCfg.mpptScanInterval = scanInterval;
+	CFG_remoteCfg.mpptScanDuration = scanDuration;
+	DCDC_setVoutLimit(150.0f);
+	DCDC_setIoutLimit(80.0f);
+
+	MEAS_init();
+	MEAS_update();
+	meas.pvVolt.val = meas.pvVolt.valPreFilter;																			// no filter run up from 0 V
+	meas.pvOcVolt.val = meas.pvVolt.val;
+	pvVoltFrac = IQ_cnst( CFG_remoteCfg.pvMpVolt / CFG_remoteCfg.pvOcVolt );
+	MPPT_init();
+	MPPT_setMode(mode);
+	tickCount = 0;
+	nextTick = sim.time + MSP_TICK_S;
+	msp.pMpp = plantPvMpp(&sim.plant, &msp.vMpp);
+}
+
+void mspIrradiance(uint8_t group, float gain){
+	plantSetIrradiance(&sim.plant, group, gain);
+	msp.pMpp = plantPvMpp(&sim.plant, &msp.vMpp);
+}
+
+/******************************************************************************************
+*  The Voc sample and the tracker of CTRL_tick
+*******************************************************************************************/
+void mspTick(void){
+	if(tickCount == 0)
+	{
+		IO_disablePwmCtrl();																														// open circuit
+		MEAS_setDoUpdate(0);
+	}
+	else if(tickCount < MSP_OPEN_CIRCUIT_TICKS)
+	{
+		meas.pvOcVolt.val = MEAS_filterFast(meas.pvOcVolt.val, meas.pvVolt.valPreFilter);
+	}
+	else if(tickCount == MSP_OPEN_CIRCUIT_TICKS)
+	{
+		samplePtTarget = IQ_mpy(meas.pvOcVolt.val, pvVoltFrac);
+		samplePtNow = meas.pvOcVolt.val;
+		PWM_setMpptSamplePt(samplePtNow);
+		IO_enablePwmCtrl();
+		msp.samples++;
+	}
+	else if(tickCount < MSP_NO_MEAS_TICKS)
+	{
+		if(samplePtNow > samplePtTarget)																								// 0.1 V per tick down to the target
+		{
+			samplePtNow -= IQ_cnst(0.1 / MEAS_PVVOLT_BASE);
+			PWM_setMpptSamplePt(samplePtNow);
+		}
+	}
+	else if(tickCount == MSP_NO_MEAS_TICKS)
+	{
+		PWM_setMpptSamplePt(samplePtTarget);
+		samplePtNow = samplePtTarget;
+		MPPT_start(samplePtTarget);
+		MEAS_setDoUpdate(1);
+	}
+	else if(MPPT_isTracking())
+	{
+		samplePtNow = MPPT_tick();
+		PWM_setMpptSamplePt(samplePtNow);
+	}
+
+	if(++tickCount == MSP_SAMPLE_PERIOD_TICKS) { tickCount = MPPT_isTracking() ? MSP_NO_MEAS_TICKS + 1 : 0; }
+	msp.ticks++;
+}
+
+/******************************************************************************************
+*  After the handlers of every period: the main loop of the board and the energies
+*******************************************************************************************/
+static void mspPeriod(void){
+	static double last;
+	double dt = sim.time - last;
+
+	last = sim.time;
+	if(dt <= 0.0 || dt > 1.0e-3) { return; }																						// the first period of a run
+	MEAS_update();
+	msp.ePv += sim.plant.avgVin * sim.plant.avgIin * dt;
+	msp.eMpp += msp.pMpp * dt;
+	if(sim.time >= nextTick)
+	{
+		nextTick += MSP_TICK_S;
+		mspTick();
+	}
+}
+
+void mspRun(double seconds){
+	double end = sim.time + seconds;
+
+	sim.pHook = mspPeriod;
+	while(sim.time < end){
+		simPeriod();
+	}
+}
+
+float mspEfficiency(void){
+	return (msp.eMpp > 0.0) ? (float)(msp.ePv / msp.eMpp) : 0.0f;
+}
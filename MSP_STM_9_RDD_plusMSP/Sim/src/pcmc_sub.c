@@ -0,0 +1,81 @@
+/*
+ * pcmc_sub.c
+ *
+ *  Created on: 17 OCT. 2026
+ *  Peak current mode above half duty: no period-2 oscillation with the slope compensation
+ *
+ *  Built with HRTIM_PEAK_CURRENT 1, the sim ends every pulse at the COMP2 trip against the
+ *  staircase of pcmc.c (sim.c). The Vin loop holds the string at PCMC_SUB_VIN at 60 % of
+ *  the irradiance, the battery needs a duty of about 0.55. With the inductor of the peak
+ *  current mode (PCMC_SUB_L) the valley current is a map of the last one with the factor
+ *  -(m2 - ma) / (m1 + ma), m1 0.71 A/us and m2 0.82 A/us here:
+ *  without a ramp m2 > m1 and a disturbance grows every other period, with DCDC_PCMC_SLOPE
+ *  it dies out. The alternating part of the on time over PCMC_SUB_WINDOW periods is the
+ *  measure: without a ramp it must be above PCMC_SUB_OSC, with the default below
+ *  PCMC_SUB_FLAT, the mean duty above 0.5 in both.
+ */
+
+#include <stdio.h>
+#include <math.h>
+#include "sim.h"
+#include "dcdc.h"
+
+#define PCMC_SUB_L						150.0e-6f														// H, the operating point of DCDC_PCMC_SLOPE
+#define PCMC_SUB_VIN					230.0f															// V, duty Vout / Vin about 0.55
+#define PCMC_SUB_SUN					0.6f																// the peak and the ramp under the limit
+#define PCMC_SUB_SETTLE				40000U															// periods, 2 s
+#define PCMC_SUB_WINDOW				1024U
+#define PCMC_SUB_OSC					0.01f																// duty, alternating amplitude of the oscillation
+#define PCMC_SUB_FLAT					0.001f															// duty, of the compensated loop
+
+static float subSum, subAlt;
+static uint32_t subN;
+
+static void subHook(void){
+	subSum += sim.duty[0];
+	subAlt += (subN & 1U) ? -sim.duty[0] : sim.duty[0];
+	subN++;
+}
+
+/******************************************************************************************
+*  Mean and alternating amplitude of the on time over PCMC_SUB_WINDOW periods
+*******************************************************************************************/
+static float subMeasure(float ampsPerUs, float* pMean){
+	float alt;
+
+	DCDC_setSlopeComp(ampsPerUs);
+	simRun(PCMC_SUB_SETTLE);
+	subSum = 0.0f;
+	subAlt = 0.0f;
+	subN = 0;
+	sim.pHook = subHook;
+	simRun(PCMC_SUB_WINDOW);
+	sim.pHook = 0;
+	*pMean = subSum / subN;
+	alt = fabsf(subAlt) / subN;
+	printf("ramp %.2f A/us: duty %.4f, period-2 amplitude %.5f, Vin %.1f V, Iout %.1f A, %u limit events\n",
+				 ampsPerUs, *pMean, alt, sim.plant.avgVin, sim.plant.avgIout, DCDC_getCurrLimitEvents());
+	return alt;
+}
+
+int main(void){
+	plantParam_t param;
+	float mean, alt;
+	int ok = 1;
+
+	plantDefault(&param);
+	param.l = PCMC_SUB_L;
+	simInit(&param);
+	simRun(2000);
+	plantSetIrradiance(&sim.plant, PLANT_PV_GROUPS_MAX, PCMC_SUB_SUN);
+	simStart(PCMC_SUB_VIN, 150.0f, 80.0f);
+
+	alt = subMeasure(0.0f, &mean);
+	ok &= (mean > 0.5f) && (alt > PCMC_SUB_OSC);
+	alt = subMeasure(DCDC_PCMC_SLOPE, &mean);
+	ok &= (mean > 0.5f) && (alt < PCMC_SUB_FLAT);
+	ok &= (fabsf(sim.plant.avgVin - PCMC_SUB_VIN) < 2.0f) && (DCDC_getFault() == DCDC_FAULT_NONE);
+
+	printf("%s\n", ok ? "PASS" : "FAIL");
+	return ok ? 0 : 1;
+}
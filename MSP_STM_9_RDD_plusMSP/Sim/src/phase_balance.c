@@ -0,0 +1,173 @@
+/*
+ * phase_balance.c
+ *
+ *  Created on: 17 OCT. 2026
+ *  Phase alignment and current balancing of the interleaved buck, HRTIM_PHASES phases
+ *
+ *  Alignment: every period of a run with the spread spectrum on, phase k must be reset by
+ *  the master event of its slot at k / HRTIM_PHASES of the master period (PHASE_ALIGN_DEG),
+ *  set Tx1 on that reset and carry the common duty plus its trim.
+ *  Balancing: the phases of the plant have different resistances, the currents split by
+ *  them. The test is the code that samples the phase currents: phaseBalance gets the work
+ *  cycle means of the phase currents. The spread of the phase currents must fall below
+ *  PHASE_SPREAD_MAX of the mean, the trims stay within PHASE_TRIM_MAX and sum to about 0,
+ *  so the common duty of the regulator is kept. A manual trim must move the current of
+ *  its phase.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "sim.h"
+#include "HiResTim.h"
+#include "phase.h"
+#include "dcdc.h"
+
+#define PHASE_ALIGN_PERIODS		20000U
+#define PHASE_ALIGN_DEG				0.1f																// of the master period
+#define PHASE_RUN_PERIODS			40000U															// 2 s
+#define PHASE_SPREAD_MIN			0.3f																// unbalanced, before
+#define PHASE_SPREAD_MAX			0.05f																// (max - min) / mean, after
+#define PHASE_MANUAL_TRIM			8																		// counts, 0.03 V on a 20 mOhm phase
+
+typedef char phaseTestCheck_t[(HRTIM_PHASES > 1) ? 1 : -1];												// built with HRTIM_PHASES > 1
+
+extern volatile uint32_t workCycles;
+
+static const float phaseRl[PLANT_PHASES_MAX] = { 0.015f, 0.02f, 0.025f, 0.03f };					// Ohm
+static const uint32_t phaseReset[4] = { HRTIM_RSTR_MSTPER, HRTIM_RSTR_MSTCMP1, HRTIM_RSTR_MSTCMP2, HRTIM_RSTR_MSTCMP3 };
+
+static uint8_t balance;																									// 1 - phaseBalance every work cycle
+static float iSum[HRTIM_PHASES];
+static uint32_t iNum;
+static float iMean[HRTIM_PHASES];																				// A, of the last work cycle
+
+/******************************************************************************************
+*  Work cycle means of the phase currents, Q16 to phaseBalance
+*******************************************************************************************/
+static void periodHook(void){
+	static uint32_t lastCycles;
+	int32_t curr[HRTIM_PHASES];
+	uint16_t k;
+
+	for(k = 0; k < HRTIM_PHASES; k++){
+		iSum[k] += sim.plant.avgIL[k];
+	}
+	iNum++;
+	if(workCycles == lastCycles) { return; }
+	lastCycles = workCycles;
+	for(k = 0; k < HRTIM_PHASES; k++){
+		iMean[k] = iSum[k] / iNum;
+		curr[k] = (int32_t)(iMean[k] * 65536.0f);
+		iSum[k] = 0.0f;
+	}
+	iNum = 0;
+	if(balance) { phaseBalance(curr); }
+}
+
+static float spread(float* pMean){
+	float min = iMean[0], max = iMean[0], mean = 0.0f;
+	uint16_t k;
+
+	for(k = 0; k < HRTIM_PHASES; k++){
+		if(iMean[k] < min) { min = iMean[k]; }
+		if(iMean[k] > max) { max = iMean[k]; }
+		mean += iMean[k] / HRTIM_PHASES;
+	}
+	*pMean = mean;
+	return (mean > 0.0f) ? (max - min) / mean : 0.0f;
+}
+
+/******************************************************************************************
+*  Slots of the master timer, the reset and set events and the duty of every phase
+*******************************************************************************************/
+static int testAlignment(void){
+	uint32_t periodMin = 0xFFFF, periodMax = 0, fails = 0;
+	float errMax = 0.0f;
+	uint32_t n;
+	uint16_t k;
+
+	for(n = 0; n < PHASE_ALIGN_PERIODS; n++){
+		uint32_t per = simHrtim1.sMasterRegs.MPER;
+		uint32_t cmp[4] = { 0, simHrtim1.sMasterRegs.MCMP1R, simHrtim1.sMasterRegs.MCMP2R, simHrtim1.sMasterRegs.MCMP3R };
+		uint32_t duty0 = simHrtim1.sTimerxRegs[TIM_A].CMP1xR - hrtimPhaseTrim[0];
+
+		if(per < periodMin) { periodMin = per; }
+		if(per > periodMax) { periodMax = per; }
+		for(k = 0; k < HRTIM_PHASES; k++){
+			const HRTIM_Timerx_TypeDef* pTim = &simHrtim1.sTimerxRegs[TIM_A + k];
+			float err = fabsf((float)cmp[k] / per - (float)k / HRTIM_PHASES) * 360.0f;
+			if(err > errMax) { errMax = err; }
+			if(err > PHASE_ALIGN_DEG) { fails++; }
+			if((pTim->RSTxR != phaseReset[k]) || (pTim->SETx1R != HRTIM_SET1R_RESYNC)) { fails++; }
+			if(pTim->PERxR <= per) { fails++; }																				// the master resets the phase first
+			if(pTim->CMP1xR != duty0 + hrtimPhaseTrim[k]) { fails++; }
+		}
+		simPeriod();
+	}
+	printf("%u phases: master period %u..%u counts, slot error %.4f deg max, %u fails\n",
+				 HRTIM_PHASES, periodMin, periodMax, errMax, fails);
+	return (fails == 0) && (periodMax > periodMin);																	// the spread spectrum moved the slots
+}
+
+static int testBalance(void){
+	float trimSum = 0.0f, mean, before, after, iManual;
+	int16_t trimMax = 0;
+	int ok = 1;
+	uint16_t k;
+
+	simRun(PHASE_RUN_PERIODS);
+	before = spread(&mean);
+	printf("no balancing: mean %.2f A, spread %.1f%%:", mean, before * 100.0f);
+	for(k = 0; k < HRTIM_PHASES; k++){
+		printf(" %.2f", iMean[k]);
+	}
+	printf(" A\n");
+
+	balance = 1;
+	simRun(PHASE_RUN_PERIODS);
+	after = spread(&mean);
+	printf("balancing:    mean %.2f A, spread %.1f%%, trims", mean, after * 100.0f);
+	for(k = 0; k < HRTIM_PHASES; k++){
+		trimSum += hrtimPhaseTrim[k];
+		if(abs(hrtimPhaseTrim[k]) > trimMax) { trimMax = abs(hrtimPhaseTrim[k]); }
+		printf(" %d", hrtimPhaseTrim[k]);
+	}
+	printf(" counts\n");
+	ok &= (before > PHASE_SPREAD_MIN) && (after < PHASE_SPREAD_MAX);
+	ok &= (trimMax <= PHASE_TRIM_MAX) && (fabsf(trimSum) <= HRTIM_PHASES);
+
+	/* a manual trim on phase 1, the balancing off again and reset */
+	balance = 0;
+	phaseInit();
+	simRun(PHASE_RUN_PERIODS);
+	iManual = iMean[1];
+	ok &= (phaseSetTrim(1, PHASE_MANUAL_TRIM) == 0) && (phaseSetTrim(1, PHASE_TRIM_MAX + 1) != 0) && (phaseSetTrim(HRTIM_PHASES, 0) != 0);
+	simRun(PHASE_RUN_PERIODS);
+	printf("manual trim %d counts on phase 1: %.2f -> %.2f A\n", PHASE_MANUAL_TRIM, iManual, iMean[1]);
+	ok &= (iMean[1] > iManual + 0.5f);
+	return ok;
+}
+
+int main(void){
+	plantParam_t param;
+	uint16_t k;
+	int ok = 1;
+
+	plantDefault(&param);
+	param.phases = HRTIM_PHASES;
+	for(k = 0; k < HRTIM_PHASES; k++){
+		param.rL[k] = phaseRl[k];
+	}
+	simInit(&param);
+	sim.pHook = periodHook;
+	simRun(2000);
+	simStart(240.0f, 150.0f, 80.0f);
+	simRun(PHASE_ALIGN_PERIODS);
+
+	ok &= testAlignment();
+	ok &= testBalance();
+	ok &= (DCDC_getFault() == DCDC_FAULT_NONE);
+	printf("%s\n", ok ? "PASS" : "FAIL");
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,97 @@
+/*
+ * pid_step.c
+ *
+ *  Created on: 17 OCT. 2026
+ *  Vin step response of the PI regulator and its recovery from the duty limit
+ *
+ *  Settling is the first period after which the plant Vin stays within PID_STEP_BAND of
+ *  the setpoint for PID_STEP_HOLD periods. A 15 V step must settle within
+ *  PID_STEP_SETTLE_MAX periods; the old +/-10 count stepper needs at least the duty change
+ *  / 10 periods for the same step, printed for comparison.
+ *  Anti-windup: after PID_STEP_SATURATED periods at DUTY_MAX (setpoint below the reach of
+ *  the battery) the duty must leave the limit within PID_STEP_RELEASE_MAX periods of a
+ *  setpoint back in range and settle within PID_STEP_RECOVER_MAX: Vin overshoots and the
+ *  output loops hold the duty for a while on the way back.
+ */
+
+#include <stdio.h>
+#include <math.h>
+#include "sim.h"
+#include "HiResTim.h"
+#include "dcdc.h"
+
+#define PID_STEP_BAND					1.5f																// V, 10% of the step, above the dither of the dead time ESC
+#define PID_STEP_HOLD					500U																// periods
+#define PID_STEP_WINDOW				20000U															// periods, 1 s
+#define PID_STEP_SETTLE_MAX		100U																// periods, "tens of cycles"
+#define PID_STEP_SATURATED		4000U																// periods at DUTY_MAX
+#define PID_STEP_RELEASE_MAX	5U																	// periods
+#define PID_STEP_RECOVER_MAX	250U																// periods, 30 V out of the limit over the output loops
+#define PID_STEP_STEPPER			10.0f																// counts of BUCK_PERIOD per period, DCDC_REG_STEP
+
+/******************************************************************************************
+*  Duty ratio of the last period
+*******************************************************************************************/
+static float dutyNow(void){
+	return simHrtim1.sTimerxRegs[TIM_A].CMP1xR * 1.0f / simHrtim1.sTimerxRegs[TIM_A].PERxR;
+}
+
+/******************************************************************************************
+*  Periods from the setpoint change to the last period out of the band, PID_STEP_WINDOW
+*  if it doesn't stay in. pDuty - mean duty ratio of the hold periods
+*******************************************************************************************/
+static uint32_t settlePeriods(float vIn, float* pDuty){
+	uint32_t settled = 0;
+	uint32_t n;
+	float sum = 0.0f;
+
+	setVin(vIn);
+	for(n = 1; n <= PID_STEP_WINDOW; n++){
+		simPeriod();
+		if(fabsf(sim.plant.avgVin - vIn) > PID_STEP_BAND) { settled = n; sum = 0.0f; }
+			else { sum += dutyNow(); }
+		if(n - settled >= PID_STEP_HOLD) { break; }
+	}
+	if(pDuty != 0) { *pDuty = sum / PID_STEP_HOLD; }
+	return (n > PID_STEP_WINDOW) ? PID_STEP_WINDOW : settled;
+}
+
+int main(void){
+	plantParam_t param;
+	uint32_t settle, recover, release;
+	float duty240, duty225, dutyLimit;
+	int ok = 1;
+
+	plantDefault(&param);
+	simInit(&param);
+	simRun(2000);
+	simStart(240.0f, 150.0f, 80.0f);
+	simRun(PID_STEP_WINDOW);
+	settlePeriods(240.0f, &duty240);
+
+	settle = settlePeriods(225.0f, &duty225);
+	printf("240 -> 225 V: settled in %u periods, duty %.3f -> %.3f, the stepper needs %.0f periods or more\n",
+				 settle, duty240, duty225, fabsf(duty225 - duty240) * BUCK_PERIOD / PID_STEP_STEPPER);
+	ok &= (settle <= PID_STEP_SETTLE_MAX);
+
+	/* below Vout / DUTY_MAX, the loop stays at the limit */
+	setVin(150.0f);
+	simRun(PID_STEP_SATURATED);
+	dutyLimit = dutyNow();
+	printf("limit: duty %.3f (DUTY_MAX %.3f), Vin %.1f V\n", dutyLimit, DUTY_MAX * 1.0f / BUCK_PERIOD, sim.plant.avgVin);
+	ok &= (dutyLimit > DUTY_MAX * 1.0f / BUCK_PERIOD - 0.005f);
+
+	setVin(240.0f);
+	for(release = 1; release <= PID_STEP_WINDOW; release++){
+		simPeriod();
+		if(dutyNow() < dutyLimit - 0.005f) { break; }
+	}
+	recover = release + settlePeriods(240.0f, 0);
+	printf("limit -> 240 V: duty off the limit in %u periods, settled in %u periods\n", release, recover);
+	ok &= (release <= PID_STEP_RELEASE_MAX);
+	ok &= (recover <= PID_STEP_RECOVER_MAX);
+
+	ok &= (DCDC_getFault() == DCDC_FAULT_NONE);
+	printf("%s\n", ok ? "PASS" : "FAIL");
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,272 @@
+/*
+ * plant.c
+ *
+ *  Created on: 17 OCT. 2026
+ *  Averaged model of the buck stage for the host simulation
+ *
+ *  Every phase is a switch node averaged over the period: the high side conducts from the
+ *  rising dead time to CMP1, the dead times put the body diode on the node, the side of it
+ *  is given by the sign of the inductor current. Without pulses (outputs disabled or a burst
+ *  idle period) the diodes carry the current down to zero.
+ *  Switching loss and the synthetic dead time loss are drawn from the input capacitor.
+ */
+
+#include <math.h>
+#include <string.h>
+#include "plant.h"
+
+/******************************************************************************************
+*  6 kW board: a string of about 6 kW at 245 V into a 120 V battery
+*******************************************************************************************/
+void plantDefault(plantParam_t* pParam){
+	uint8_t k;
+
+	memset(pParam, 0, sizeof(*pParam));
+	pParam->pvIsc = 26.0f;
+	pParam->pvVoc = 290.0f;
+	pParam->pvVt = 16.0f;
+	pParam->pvGroups = 1;
+	pParam->pvVbypass = 0.5f;
+	pParam->cIn = 1000.0e-6f;
+	pParam->phases = 1;
+	pParam->l = 15.0e-6f;																					// DCDC_DEADBEAT_L
+	for(k = 0; k < PLANT_PHASES_MAX; k++){
+		pParam->rL[k] = 0.02f;
+	}
+	pParam->vDiode = 0.8f;
+	pParam->eSw = 1.0e-3f;
+	pParam->cOut = 1000.0e-6f;																			// DCDC_DEADBEAT_C
+	pParam->vBat = 120.0f;
+	pParam->rBat = 0.1f;
+	pParam->rLoad = 0.0f;
+	pParam->dtLossK = 0.0f;
+	pParam->dtRiseOpt = 64.0f;
+	pParam->dtFallOpt = 64.0f;
+	pParam->dtFallSlope = 0.0f;
+}
+
+/******************************************************************************************
+*  String voltage at the current i, the groups with less than i go over their bypass diode
+*******************************************************************************************/
+static float pvStringVoltage(const plant_t* pPlant, float i){
+	const plantParam_t* p = &pPlant->p;
+	float vt = p->pvVt / p->pvGroups;
+	float v = 0.0f;
+	uint8_t k;
+
+	for(k = 0; k < p->pvGroups; k++){
+		float isc = pPlant->pvGain[k] * p->pvIsc;
+		v += (i < isc) ? vt * logf((isc - i) / pPlant->pvI0 + 1.0f) : -p->pvVbypass;
+	}
+	return v;
+}
+
+/******************************************************************************************
+*  I(V) of a string with bypass diodes by bisection, V(I) falls with I
+*******************************************************************************************/
+static void pvTableBuild(plant_t* pPlant){
+	float iMax = 0.0f;
+	uint16_t n;
+	uint8_t k;
+
+	for(k = 0; k < pPlant->p.pvGroups; k++){
+		if(pPlant->pvGain[k] * pPlant->p.pvIsc > iMax) { iMax = pPlant->pvGain[k] * pPlant->p.pvIsc; }
+	}
+	pPlant->pvTableStep = pPlant->p.pvVoc * 1.05f / (PLANT_PV_TABLE - 1);
+	for(n = 0; n < PLANT_PV_TABLE; n++){
+		float v = n * pPlant->pvTableStep;
+		float lo = 0.0f, hi = iMax;
+		uint8_t it;
+
+		if(pvStringVoltage(pPlant, 0.0f) <= v) { pPlant->pvTable[n] = 0.0f; continue; }
+		for(it = 0; it < 40; it++){
+			float mid = 0.5f * (lo + hi);
+			if(pvStringVoltage(pPlant, mid) > v) { lo = mid; } else { hi = mid; }
+		}
+		pPlant->pvTable[n] = 0.5f * (lo + hi);
+	}
+}
+
+/******************************************************************************************
+*
+*
+*******************************************************************************************/
+void plantInit(plant_t* pPlant, const plantParam_t* pParam){
+	uint8_t k;
+
+	memset(pPlant, 0, sizeof(*pPlant));
+	pPlant->p = *pParam;
+	if(pPlant->p.pvGroups < 1) { pPlant->p.pvGroups = 1; }
+	if(pPlant->p.pvGroups > PLANT_PV_GROUPS_MAX) { pPlant->p.pvGroups = PLANT_PV_GROUPS_MAX; }
+	if(pPlant->p.phases < 1) { pPlant->p.phases = 1; }
+	if(pPlant->p.phases > PLANT_PHASES_MAX) { pPlant->p.phases = PLANT_PHASES_MAX; }
+	for(k = 0; k < PLANT_PV_GROUPS_MAX; k++){
+		pPlant->pvGain[k] = 1.0f;
+	}
+	pPlant->pvI0 = pParam->pvIsc / (expf(pParam->pvVoc / pParam->pvVt) - 1.0f);
+	if(pPlant->p.pvGroups > 1) { pvTableBuild(pPlant); }
+
+	pPlant->vIn = pvStringVoltage(pPlant, 0.0f);																// open circuit, the converter is off
+	pPlant->vOut = (pParam->rBat > 0.0f) ? pParam->vBat : 0.0f;
+	pPlant->avgVin = pPlant->vIn;
+	pPlant->avgVout = pPlant->vOut;
+}
+
+/******************************************************************************************
+*  Irradiance ratio of one group or of the string, the curve follows at once
+*******************************************************************************************/
+void plantSetIrradiance(plant_t* pPlant, uint8_t group, float gain){
+	uint8_t k;
+
+	for(k = 0; k < pPlant->p.pvGroups; k++){
+		if((group >= pPlant->p.pvGroups) || (group == k)) { pPlant->pvGain[k] = gain; }
+	}
+	if(pPlant->p.pvGroups > 1) { pvTableBuild(pPlant); }
+}
+
+/******************************************************************************************
+*  PV current at the string voltage, no reverse current (blocking diode)
+*******************************************************************************************/
+float plantPvCurrent(const plant_t* pPlant, float vIn){
+	float i;
+
+	if(pPlant->p.pvGroups == 1)
+	{
+		i = pPlant->pvGain[0] * pPlant->p.pvIsc - pPlant->pvI0 * (expf(vIn / pPlant->p.pvVt) - 1.0f);
+	}
+	else
+	{
+		float x = vIn / pPlant->pvTableStep;
+		int32_t n;
+
+		if(x < 0.0f) { x = 0.0f; }
+		n = (int32_t)x;
+		if(n >= PLANT_PV_TABLE - 1) { return 0.0f; }
+		i = pPlant->pvTable[n] + (x - n) * (pPlant->pvTable[n + 1] - pPlant->pvTable[n]);
+	}
+	return (i > 0.0f) ? i : 0.0f;
+}
+
+/******************************************************************************************
+*  Global maximum of the present curve by a scan of 1/2000 of Voc and a refinement
+*******************************************************************************************/
+float plantPvMpp(const plant_t* pPlant, float* pVmp){
+	float step = pPlant->p.pvVoc / 2000.0f;
+	float vBest = 0.0f, pBest = 0.0f;
+	float v;
+	uint16_t n;
+
+	for(n = 1; n <= 2000; n++){
+		float p;
+		v = n * step;
+		p = v * plantPvCurrent(pPlant, v);
+		if(p > pBest) { pBest = p; vBest = v; }
+	}
+	for(n = 0; n < 40; n++){																									// the step around the best point
+		float p;
+		v = vBest - step + n * (step / 20.0f);
+		p = v * plantPvCurrent(pPlant, v);
+		if(p > pBest) { pBest = p; vBest = v; }
+	}
+	if(pVmp != 0) { *pVmp = vBest; }
+	return pBest;
+}
+
+/******************************************************************************************
+*  One PWM period: pDuty[k] - CMP1 / period of phase k, bit k of pulses - phase k switches,
+*  dtRise / dtFall - dead times, counts of PLANT_TDTG
+*******************************************************************************************/
+void plantStep(plant_t* pPlant, float period, const float* pDuty, uint32_t pulses, float dtRise, float dtFall){
+	const plantParam_t* p = &pPlant->p;
+	float dt = period * (1.0f / PLANT_SUBSTEPS);
+	float tr = dtRise * PLANT_TDTG / period;
+	float tf = dtFall * PLANT_TDTG / period;
+	float kDt = 1.0f / p->l * dt;
+	float sumVin = 0.0f, sumIpv = 0.0f, sumVout = 0.0f, sumIout = 0.0f, sumPin = 0.0f;
+	float sumIL[PLANT_PHASES_MAX] = { 0.0f };
+	float pLoss = 0.0f;
+	uint8_t s, k;
+
+	if(pulses != 0)																														// per period: the losses change slowly
+	{
+		float iOut = 0.0f, dtLoss = 0.0f;
+		uint8_t n = 0;
+
+		for(k = 0; k < p->phases; k++){
+			if(pulses & (1UL << k)) { iOut += pPlant->iL[k]; n++; }
+		}
+		pLoss = p->eSw * n / period;
+		if(p->dtLossK > 0.0f)
+		{
+			float dr = dtRise - p->dtRiseOpt;
+			float df = dtFall - (p->dtFallOpt + p->dtFallSlope * fabsf(iOut));
+			dtLoss = p->dtLossK * (dr * dr + df * df);
+			pLoss += dtLoss * fabsf(pPlant->vOut * iOut);
+		}
+	}
+
+	for(s = 0; s < PLANT_SUBSTEPS; s++){
+		float vIn = pPlant->vIn;
+		float vOut = pPlant->vOut;
+		float iPv = plantPvCurrent(pPlant, vIn);
+		float iConv = (vIn > 1.0f) ? pLoss / vIn : 0.0f;
+		float iSum = 0.0f;
+		float iLoad;
+
+		for(k = 0; k < p->phases; k++){
+			float iL = pPlant->iL[k];
+			float vSw, iNew;
+
+			if(pulses & (1UL << k))
+			{
+				float d = pDuty[k];
+				if(iL >= 0.0f)																											// low side diode in both dead times
+				{
+					vSw = vIn * (d - tr) - p->vDiode * (tr + tf);
+					iConv += iL * (d - tr);
+				}
+				else																																	// high side diode
+				{
+					vSw = vIn * (d - tr) + (vIn + p->vDiode) * (tr + tf);
+					iConv += iL * (d + tf);
+				}
+				iNew = iL + (vSw - iL * p->rL[k] - vOut) * kDt;
+			}
+			else
+			{
+				if(iL > 0.0f) { vSw = -p->vDiode; }
+					else if(iL < 0.0f) { vSw = vIn + p->vDiode; iConv += iL; }
+					else { vSw = vOut; }
+				iNew = iL + (vSw - iL * p->rL[k] - vOut) * kDt;
+				if(iL * iNew <= 0.0f) { iNew = 0.0f; }																	// the diode blocks
+			}
+			pPlant->iL[k] = iNew;
+			iSum += iNew;
+			sumIL[k] += iNew;
+		}
+
+		iLoad = (p->rLoad > 0.0f) ? vOut / p->rLoad : 0.0f;
+		if(p->rBat > 0.0f) { iLoad += (vOut - p->vBat) / p->rBat; }
+		pPlant->vIn = vIn + (iPv - iConv) / p->cIn * dt;
+		pPlant->vOut = vOut + (iSum - iLoad) / p->cOut * dt;
+		if(pPlant->vOut < 0.0f) { pPlant->vOut = 0.0f; }
+
+		sumVin += vIn;
+		sumIpv += iPv;
+		sumVout += vOut;
+		sumIout += iSum;
+		sumPin += vIn * iConv;
+	}
+
+	pPlant->avgVin = sumVin * (1.0f / PLANT_SUBSTEPS);
+	pPlant->avgIin = sumIpv * (1.0f / PLANT_SUBSTEPS);
+	pPlant->avgVout = sumVout * (1.0f / PLANT_SUBSTEPS);
+	pPlant->avgIout = sumIout * (1.0f / PLANT_SUBSTEPS);
+	for(k = 0; k < p->phases; k++){
+		pPlant->avgIL[k] = sumIL[k] * (1.0f / PLANT_SUBSTEPS);
+	}
+	pPlant->pIn = sumPin * (1.0f / PLANT_SUBSTEPS);
+	pPlant->pOut = pPlant->avgVout * pPlant->avgIout;
+	pPlant->ePv += (double)pPlant->avgVin * pPlant->avgIin * period;
+	pPlant->eOut += (double)pPlant->pOut * period;
+}
@@ -0,0 +1,165 @@
+/*
+ * protect_awd.c
+ *
+ *  Created on: 17 OCT. 2026
+ *  AWD2 / AWD3 windows of protectThresholds and the persistence of their faults
+ *
+ *  protectThresholds alone: the 8-bit code of every window must be the limit code >> 4,
+ *  the code of a limit must stay inside its window and 16 codes beyond it must trip, a
+ *  limit past the ADC range must never trip. The reverse input current is the low side of
+ *  the iIn window, below ZERO_CURR_CODE.
+ *  In the closed loop the averages of the plant are replaced at the conversions of a few
+ *  periods: PROTECT_INSIDE codes inside a limit never trips, PROTECT_BEYOND codes beyond
+ *  it latches the fault of the window after DCDC_AWD_PERSIST sample sets in a row and not
+ *  after one set less, nor after two such runs split by a set inside.
+ */
+
+#include <stdio.h>
+#include "sim.h"
+#include "dcdc.h"
+#include "adc.h"
+#include "protect.h"
+#include "HiResTim.h"
+
+#define PROTECT_V_IN_MAX			260.0f															// V, the sim runs at 240 V
+#define PROTECT_V_OUT_MAX			126.5f															// V, battery about 125 V: a larger step of the Vout sample moves the feed-forward duty into AWD1
+#define PROTECT_I_IN_MIN			(-2.0f)															// A, reverse PV current
+#define PROTECT_I_IN_MAX			28.0f																// A, Isc 26 A
+#define PROTECT_I_OUT_MAX			60.0f																// A, about 48 A
+#define PROTECT_INSIDE				2.0f																// codes, the Vref correction of the scale
+#define PROTECT_BEYOND				18.0f																// codes, past the 16 of the 8-bit step
+
+#define PROTECT_VIN_PER_CODE	(REFERENCE_VOLTAGE / 4096.0f * VIN_CONVERCE_COEFF)
+#define PROTECT_VOUT_PER_CODE	(REFERENCE_VOLTAGE / 4096.0f * VOUT_CONVERCE_COEFF)
+#define PROTECT_AMPS_PER_CODE	(REFERENCE_VOLTAGE * 50 * I_CONVERCE_COEFF / 4096.0f)
+
+typedef
+	struct{
+		const char* pName;
+		float* pAvg;																										// average of the plant the sensor converts
+		float limit;
+		float perCode;
+		float zero;																											// code of 0 V / 0 A
+		int8_t side;																										// 1 - high limit, -1 - low limit
+		uint8_t fault;																									// dcdcFault_ent
+} protectCase_t;
+
+static const protectLimits_t limits = {
+	PROTECT_V_IN_MAX, PROTECT_V_OUT_MAX, PROTECT_I_IN_MIN, PROTECT_I_IN_MAX, PROTECT_I_OUT_MAX };
+
+static float* pInject;
+static float injectValue;
+
+/******************************************************************************************
+*  8-bit thresholds: a code trips a high window if code >> 4 > hi, a low one if < lo
+*******************************************************************************************/
+static int awdTrips(uint16_t code, uint8_t thr, int8_t side){
+	return (side > 0) ? ((code >> 4) > thr) : ((code >> 4) < thr);
+}
+
+static int checkWindow(const char* pName, uint8_t thr, float limitCode, int8_t side){
+	uint16_t inside = (side > 0) ? (uint16_t)limitCode : (uint16_t)(limitCode + 0.999f);
+	uint16_t beyond = (side > 0) ? (uint16_t)limitCode + 16 : (uint16_t)limitCode - 16;
+	int good;
+
+	good = (thr == ((uint16_t)limitCode >> 4)) && !awdTrips(inside, thr, side) && awdTrips(beyond, thr, side);
+	printf("%-6s limit code %7.1f, threshold %3u: code %4u %s, code %4u %s\n", pName, limitCode, thr,
+				 inside, awdTrips(inside, thr, side) ? "trips" : "inside", beyond, awdTrips(beyond, thr, side) ? "trips" : "inside");
+	return good;
+}
+
+static int checkThresholds(void){
+	protectLimits_t wide = limits;
+	adcWatchdogs_t wd;
+	int ok = 1;
+
+	protectThresholds(&limits, PROTECT_VIN_PER_CODE, PROTECT_VOUT_PER_CODE, PROTECT_AMPS_PER_CODE, &wd);
+	ok &= checkWindow("vIn", wd.vIn.hi, PROTECT_V_IN_MAX / PROTECT_VIN_PER_CODE, 1) && (wd.vIn.lo == 0);
+	ok &= checkWindow("vOut", wd.vOut.hi, PROTECT_V_OUT_MAX / PROTECT_VOUT_PER_CODE, 1) && (wd.vOut.lo == 0);
+	ok &= checkWindow("iIn", wd.iIn.hi, ZERO_CURR_CODE + PROTECT_I_IN_MAX / PROTECT_AMPS_PER_CODE, 1);
+	ok &= checkWindow("-iIn", wd.iIn.lo, ZERO_CURR_CODE + PROTECT_I_IN_MIN / PROTECT_AMPS_PER_CODE, -1);
+	ok &= (wd.iIn.lo < (ZERO_CURR_CODE >> 4));																		// 0 A inside
+	ok &= checkWindow("iOut", wd.iOut.hi, ZERO_CURR_CODE + PROTECT_I_OUT_MAX / PROTECT_AMPS_PER_CODE, 1) && (wd.iOut.lo == 0);
+
+	wide.vInMax = 1.0e4f;																													// past the ADC range: never trips
+	wide.iInMin = -1.0e4f;
+	wide.iOutMax = 1.0e4f;
+	protectThresholds(&wide, PROTECT_VIN_PER_CODE, PROTECT_VOUT_PER_CODE, PROTECT_AMPS_PER_CODE, &wd);
+	printf("past the range: vIn hi %u, iIn lo %u, iOut hi %u\n", wd.vIn.hi, wd.iIn.lo, wd.iOut.hi);
+	ok &= (wd.vIn.hi == 255) && (wd.iIn.lo == 0) && (wd.iOut.hi == 255);
+	return ok;
+}
+
+/******************************************************************************************
+*  The plant step, then one average replaced for the conversions of the period
+*******************************************************************************************/
+static void injectStep(float period){
+	uint32_t dtr = simHrtim1.sTimerxRegs[TIM_A].DTxR;
+	float tdtg = (float)(1U << ((dtr & HRTIM_DTR_DTPRSC) >> HRTIM_DTR_DTPRSC_Pos)) * (1.0f / 8.0f);
+
+	plantStep(&sim.plant, period, sim.duty, sim.pulses,
+						((dtr & HRTIM_DTR_DTR) >> HRTIM_DTR_DTR_Pos) * tdtg, ((dtr & HRTIM_DTR_DTF) >> HRTIM_DTR_DTF_Pos) * tdtg);
+	*pInject = injectValue;
+}
+
+/******************************************************************************************
+*  Fault after runs of sets at value, one set of the plant between the runs
+*******************************************************************************************/
+static uint8_t runCase(float* pAvg, float value, uint32_t sets, uint32_t runs){
+	plantParam_t param;
+	uint32_t r;
+
+	plantDefault(&param);
+	simInit(&param);
+	simRun(2000);
+	simStart(240.0f, 150.0f, 80.0f);
+	simRun(20000);
+	DCDC_setProtectLimits(PROTECT_V_IN_MAX, PROTECT_V_OUT_MAX, PROTECT_I_IN_MIN, PROTECT_I_IN_MAX, PROTECT_I_OUT_MAX);
+	simRun(100);
+	if(DCDC_getFault() != DCDC_FAULT_NONE) { return 0xFF; }
+
+	pInject = pAvg;
+	injectValue = value;
+	for(r = 0; r < runs; r++){
+		sim.pStep = injectStep;
+		simRun(sets);
+		sim.pStep = 0;
+		simPeriod();
+	}
+	simRun(10);
+	return DCDC_getFault();
+}
+
+static int checkCase(const protectCase_t* pCase){
+	float codeLimit = pCase->zero + pCase->limit / pCase->perCode;
+	float inside = (codeLimit - pCase->side * PROTECT_INSIDE - pCase->zero) * pCase->perCode;
+	float beyond = (codeLimit + pCase->side * PROTECT_BEYOND - pCase->zero) * pCase->perCode;
+	uint8_t fInside = runCase(pCase->pAvg, inside, 4 * DCDC_AWD_PERSIST, 1);
+	uint8_t fShort = runCase(pCase->pAvg, beyond, DCDC_AWD_PERSIST - 1, 1);
+	uint8_t fSplit = runCase(pCase->pAvg, beyond, DCDC_AWD_PERSIST - 1, 2);
+	uint8_t fFull = runCase(pCase->pAvg, beyond, DCDC_AWD_PERSIST, 1);
+
+	printf("%-6s %8.2f inside: fault %u, %8.2f beyond: %u sets fault %u, split %u, %u sets fault %u (expected %u)\n",
+				 pCase->pName, inside, fInside, beyond, DCDC_AWD_PERSIST - 1, fShort, fSplit, DCDC_AWD_PERSIST, fFull, pCase->fault);
+	return (fInside == DCDC_FAULT_NONE) && (fShort == DCDC_FAULT_NONE) && (fSplit == DCDC_FAULT_NONE) && (fFull == pCase->fault);
+}
+
+int main(void){
+	const protectCase_t cases[] = {
+		{ "vIn", &sim.plant.avgVin, PROTECT_V_IN_MAX, PROTECT_VIN_PER_CODE, 0.0f, 1, DCDC_FAULT_VIN },
+		{ "vOut", &sim.plant.avgVout, PROTECT_V_OUT_MAX, PROTECT_VOUT_PER_CODE, 0.0f, 1, DCDC_FAULT_VOUT },
+		{ "iIn", &sim.plant.avgIin, PROTECT_I_IN_MAX, PROTECT_AMPS_PER_CODE, ZERO_CURR_CODE, 1, DCDC_FAULT_IIN },
+		{ "-iIn", &sim.plant.avgIin, PROTECT_I_IN_MIN, PROTECT_AMPS_PER_CODE, ZERO_CURR_CODE, -1, DCDC_FAULT_IIN },
+		{ "iOut", &sim.plant.avgIout, PROTECT_I_OUT_MAX, PROTECT_AMPS_PER_CODE, ZERO_CURR_CODE, 1, DCDC_FAULT_IOUT },
+	};
+	uint8_t n;
+	int ok;
+
+	ok = checkThresholds();
+	for(n = 0; n < sizeof(cases) / sizeof(cases[0]); n++){
+		ok &= checkCase(&cases[n]);
+	}
+
+	printf("%s\n", ok ? "PASS" : "FAIL");
+	return ok ? 0 : 1;
+}
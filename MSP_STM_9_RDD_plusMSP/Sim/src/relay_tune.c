@@ -0,0 +1,156 @@
+/*
+ * relay_tune.c
+ *
+ *  Created on: 17 OCT. 2026
+ *  DCDC_startAutoTune on the plant: the relay limit cycle and the gains it sets
+ *
+ *  During the experiment the Vin of the plant is followed from rising crossing of the
+ *  target to rising crossing. The last AUTOTUNE_CYCLES cycles, the ones measured, must be
+ *  a converged limit cycle: their periods within TUNE_JITTER, a crossing is known to a
+ *  period, their swings within TUNE_SPREAD of the mean, and the ultimate period behind
+ *  the gains (Ki = Kp / (AUTOTUNE_TI_TU * Tu)) the mean one of the plant within TUNE_TU.
+ *  The gains must be applied and stabilise the Vin loop: a TUNE_STEP_V step of the target
+ *  settles within TUNE_SETTLE_MAX periods into TUNE_BAND and stays, the same as with the
+ *  gains set by DCDC_setPidGains on a fresh run, within TUNE_SAME periods and 0.2 V of
+ *  overshoot. The default gains are printed for comparison.
+ */
+
+#include <stdio.h>
+#include <math.h>
+#include "sim.h"
+#include "dcdc.h"
+#include "autotune.h"
+
+#define TUNE_VIN							240.0f															// V
+#define TUNE_STEP_V						15.0f																// V
+#define TUNE_BAND							1.5f																// V
+#define TUNE_HOLD							500U																// periods in the band
+#define TUNE_WINDOW						20000U															// periods, 1 s
+#define TUNE_SETTLE_MAX				400U																// periods
+#define TUNE_SAME							5U																	// periods
+#define TUNE_JITTER						3.0f																// periods, longest minus shortest cycle
+#define TUNE_SPREAD						0.25f																// of the mean swing
+#define TUNE_TU								0.1f																// of the mean period
+#define TUNE_CROSS_MAX				64
+
+static uint32_t crossAt[TUNE_CROSS_MAX];
+static float swing[TUNE_CROSS_MAX];
+static uint16_t crosses;
+static float vMax, vMin;
+static float vLast;
+
+/******************************************************************************************
+*  Rising crossings of the target and the peak-to-peak Vin of every cycle
+*******************************************************************************************/
+static void relayHook(void){
+	float v = sim.plant.avgVin;
+
+	if(v > vMax) { vMax = v; }
+	if(v < vMin) { vMin = v; }
+	if((vLast < TUNE_VIN) && (v >= TUNE_VIN) && (crosses < TUNE_CROSS_MAX))
+	{
+		crossAt[crosses] = (uint32_t)sim.periods;
+		swing[crosses] = vMax - vMin;
+		crosses++;
+		vMax = v;
+		vMin = v;
+	}
+	vLast = v;
+}
+
+static void startPlant(void){
+	plantParam_t param;
+
+	plantDefault(&param);
+	simInit(&param);
+	simRun(2000);
+	simStart(TUNE_VIN, 150.0f, 80.0f);
+	simRun(TUNE_WINDOW);
+}
+
+/******************************************************************************************
+*  Periods to the last one out of TUNE_BAND after the target step, the overshoot
+*******************************************************************************************/
+static uint32_t stepSettle(float* pOvershoot){
+	float vIn = TUNE_VIN - TUNE_STEP_V;
+	uint32_t settled = 0;
+	uint32_t n;
+
+	*pOvershoot = 0.0f;
+	setVin(vIn);
+	for(n = 1; n <= TUNE_WINDOW; n++){
+		simPeriod();
+		if(vIn - sim.plant.avgVin > *pOvershoot) { *pOvershoot = vIn - sim.plant.avgVin; }
+		if(fabsf(sim.plant.avgVin - vIn) > TUNE_BAND) { settled = n; }
+		if(n - settled >= TUNE_HOLD) { break; }
+	}
+	return (n > TUNE_WINDOW) ? TUNE_WINDOW : settled;
+}
+
+/******************************************************************************************
+*  Periods and swings of the measured cycles: the last AUTOTUNE_CYCLES of the experiment
+*******************************************************************************************/
+static int checkCycles(float tuGains){
+	float pMin = 1e9f, pMax = 0.0f, sMin = 1e9f, sMax = 0.0f, pSum = 0.0f, sSum = 0.0f, pMean, sMean;
+	uint16_t k;
+
+	if(crosses < AUTOTUNE_CYCLES + 1) { return 0; }
+	for(k = crosses - AUTOTUNE_CYCLES; k < crosses; k++){
+		float p = (float)(crossAt[k] - crossAt[k - 1]);
+		if(p < pMin) { pMin = p; }
+		if(p > pMax) { pMax = p; }
+		if(swing[k] < sMin) { sMin = swing[k]; }
+		if(swing[k] > sMax) { sMax = swing[k]; }
+		pSum += p;
+		sSum += swing[k];
+	}
+	pMean = pSum / AUTOTUNE_CYCLES;
+	sMean = sSum / AUTOTUNE_CYCLES;
+	printf("relay: %u cycles, the last %u: period %.1f..%.1f periods, swing %.2f..%.2f V; Tu of the gains %.1f periods\n",
+				 crosses - 1, AUTOTUNE_CYCLES, pMin, pMax, sMin, sMax, tuGains);
+	return (pMax - pMin <= TUNE_JITTER) && (sMax - sMin <= TUNE_SPREAD * sMean) && (fabsf(tuGains - pMean) <= TUNE_TU * pMean);
+}
+
+int main(void){
+	float kp = 0.0f, ki = 0.0f, overTuned, overSet, overDefault;
+	uint32_t n, settleTuned, settleSet, settleDefault;
+	uint8_t state;
+	int ok = 1;
+
+	startPlant();
+	crosses = 0;
+	vLast = sim.plant.avgVin;
+	vMax = vLast;
+	vMin = vLast;
+	ok &= (DCDC_startAutoTune() == 0);
+	sim.pHook = relayHook;
+	for(n = 0; (n < AUTOTUNE_MAX_PERIODS) && (DCDC_getAutoTuneState() == AUTOTUNE_RUNNING); n++){
+		simPeriod();
+	}
+	sim.pHook = 0;
+	simRun(100);																														// the slow path computes the gains
+	state = DCDC_getAutoTuneState();
+	ok &= (state == AUTOTUNE_DONE) && (DCDC_getAutoTuneGains(&kp, &ki) == 0) && (ki > 0.0f);
+	printf("autotune: state %u after %u periods, Kp %.4f Ki %.5f (default %.4f %.5f)\n", state, n, kp, ki, DCDC_PID_KP, DCDC_PID_KI);
+	ok &= checkCycles((ki > 0.0f) ? kp / (AUTOTUNE_TI_TU * ki) : 0.0f);
+
+	simRun(TUNE_WINDOW);
+	settleTuned = stepSettle(&overTuned);
+
+	startPlant();
+	DCDC_setPidGains(DCDC_LOOP_VIN, kp, ki, 0.0f);
+	simRun(TUNE_WINDOW);
+	settleSet = stepSettle(&overSet);
+
+	startPlant();
+	settleDefault = stepSettle(&overDefault);
+
+	printf("%.0f -> %.0f V: autotune %u periods, %.2f V overshoot; set %u, %.2f V; default gains %u, %.2f V\n",
+				 TUNE_VIN, TUNE_VIN - TUNE_STEP_V, settleTuned, overTuned, settleSet, overSet, settleDefault, overDefault);
+	ok &= (settleTuned <= TUNE_SETTLE_MAX);
+	ok &= (settleTuned <= settleSet + TUNE_SAME) && (settleSet <= settleTuned + TUNE_SAME) && (fabsf(overTuned - overSet) <= 0.2f);
+	ok &= (DCDC_getFault() == DCDC_FAULT_NONE);
+
+	printf("%s\n", ok ? "PASS" : "FAIL");
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,431 @@
+/*
+ * sim.c
+ *
+ *  Created on: 17 OCT. 2026
+ *  PWM period loop of the host simulation
+ *
+ *  Order of one period, as on the board:
+ *   - the timers take the preloaded period, duty and dead times, the plant runs the period
+ *   - ADC trigger: injected pairs (ADC_INJECTED_FAST) or the hardware triggered regular
+ *     sequence with its DMA words, the analog watchdogs check every conversion
+ *   - ADC1_2 interrupt, a regular sequence started by it is converted after it
+ *   - DMA1 channel 1 interrupt, HRTIM Timer A repetition interrupt
+ *   - EXTI0 when the software interrupt is pending, then the thread
+ *  With HRTIM_CURR_LIMIT_EEV (one phase) COMP2 may end the pulse before CMP1: the inductor
+ *  current of the plant at the period start is the valley the high side ramps up from,
+ *  it is compared with the DAC2 code, or with the staircase DMA1 channel 7 plays, past
+ *  the CMP3 blanking. The averaged step of the plant then takes that on time.
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include "sim.h"
+#include "HiResTim.h"
+#include "adc.h"
+#include "dcdc.h"
+#include "isrprof.h"
+
+#define SIM_CODE_MAX					4095
+#define SIM_VREF_CPU_CODE			((uint16_t)(CPU_VREF_VALUE / REFERENCE_VOLTAGE * 4096.0f + 0.5f))
+#define SIM_V12								12.0f
+#define SIM_VINTREF						1.23f
+#define SIM_AMPS_TO_CODE			(4096.0f / (REFERENCE_VOLTAGE * 50 * I_CONVERCE_COEFF))
+
+sim_t sim;
+
+/******************************************************************************************
+*  Code of one channel at the averages of the last period
+*******************************************************************************************/
+static float simVoltsToCode(float volts, float coeff){
+	return volts / coeff * (4096.0f / REFERENCE_VOLTAGE);
+}
+
+uint16_t simCode(uint8_t adc, uint8_t channel){
+	const plant_t* pPlant = &sim.plant;
+	float code;
+	int32_t c;
+
+	if(adc == 0)
+	{
+		switch(channel)
+		{
+			case I_IN_SENSOR:		code = ZERO_CURR_CODE + pPlant->avgIin * SIM_AMPS_TO_CODE; break;
+			case I_OUT_SENSOR:	code = ZERO_CURR_CODE + pPlant->avgIout * SIM_AMPS_TO_CODE; break;
+			case VREF_CPU:			code = SIM_VREF_CPU_CODE; break;
+			default:						code = 2048.0f; break;														// temperatures, leak reference
+		}
+	}
+	else
+	{
+		switch(channel)
+		{
+			case V_IN_SENSOR:			code = simVoltsToCode(pPlant->avgVin, VIN_CONVERCE_COEFF); break;
+			case V_OUT_SENSOR:		code = simVoltsToCode(pPlant->avgVout, VOUT_CONVERCE_COEFF); break;
+			case I_OUTCOM_SENSOR:	code = ZERO_CURR_CODE + pPlant->avgIout * SIM_AMPS_TO_CODE; break;
+			case V12_SENSOR:			code = simVoltsToCode(SIM_V12, V12_CONVERCE_COEFF); break;
+			case V_INT_REF:				code = simVoltsToCode(SIM_VINTREF, 1.0f); break;
+			default:							code = 0.0f; break;																// leak check
+		}
+	}
+
+	c = (int32_t)(code + 0.5f);
+	if(sim.noise != 0)
+	{
+		sim.noiseSeed = sim.noiseSeed * 1664525U + 1013904223U;
+		c += (int32_t)((sim.noiseSeed >> 16) % (2U * sim.noise + 1U)) - sim.noise;
+	}
+	if(c < 0) { c = 0; }
+	if(c > SIM_CODE_MAX) { c = SIM_CODE_MAX; }
+	return (uint16_t)c;
+}
+
+/******************************************************************************************
+*  Analog watchdogs of one conversion: AWD1 12 bit, AWD2 / AWD3 on the 8 MSBs
+*******************************************************************************************/
+static uint32_t simAwd(ADC_TypeDef* pAdc, uint8_t channel, uint16_t code, uint8_t injected){
+	uint32_t flags = 0;
+	uint32_t cfgr = pAdc->CFGR;
+	uint32_t code8 = code >> 4;
+
+	if(cfgr & (injected ? ADC_CFGR_JAWD1EN : ADC_CFGR_AWD1EN))
+	{
+		if(!(cfgr & ADC_CFGR_AWD1SGL) || (((cfgr & ADC_CFGR_AWD1CH) >> ADC_CFGR_AWD1CH_Pos) == channel))
+		{
+			uint32_t hi = (pAdc->TR1 & ADC_TR1_HT1) >> ADC_TR1_HT1_Pos;
+			uint32_t lo = (pAdc->TR1 & ADC_TR1_LT1) >> ADC_TR1_LT1_Pos;
+			if((code > hi) || (code < lo)) { flags |= ADC_ISR_AWD1; }
+		}
+	}
+	if(pAdc->AWD2CR & (1UL << channel))
+	{
+		if((code8 > ((pAdc->TR2 & ADC_TR2_HT2) >> ADC_TR2_HT2_Pos)) || (code8 < ((pAdc->TR2 & ADC_TR2_LT2) >> ADC_TR2_LT2_Pos))) { flags |= ADC_ISR_AWD2; }
+	}
+	if(pAdc->AWD3CR & (1UL << channel))
+	{
+		if((code8 > ((pAdc->TR3 & ADC_TR3_HT3) >> ADC_TR3_HT3_Pos)) || (code8 < ((pAdc->TR3 & ADC_TR3_LT3) >> ADC_TR3_LT3_Pos))) { flags |= ADC_ISR_AWD3; }
+	}
+	return flags;
+}
+
+/******************************************************************************************
+*  Injected sequence of both ADCs, up to 4 conversions, the master trigger starts ADC2
+*******************************************************************************************/
+static void simInjected(void){
+	uint8_t adc;
+
+	for(adc = 0; adc < 2; adc++){
+		ADC_TypeDef* pAdc = simAdcRegs(adc);
+		uint32_t jsqr = pAdc->JSQR;
+		uint32_t n = (jsqr & ADC_JSQR_JL) + 1;
+		uint32_t flags = ADC_ISR_JEOC | ADC_ISR_JEOS;
+		volatile uint32_t* pJdr = &pAdc->JDR1;
+		uint32_t i;
+
+		for(i = 0; i < n; i++){
+			uint8_t channel = (uint8_t)((jsqr >> (ADC_JSQR_JSQ1_Pos + 6 * i)) & 0x1FU);
+			uint16_t code = simCode(adc, channel);
+			pJdr[i] = code;
+			flags |= simAwd(pAdc, channel, code, 1);
+		}
+		simAdcSetFlags(adc, flags);
+	}
+}
+
+/******************************************************************************************
+*  One DMA1 channel 1 word, circular, memory increment
+*******************************************************************************************/
+static void simDmaWord(uint32_t word){
+	DMA_Channel_TypeDef* pCh = &simDma1Channel[0];
+	uint32_t pos;
+
+	if(!(pCh->CCR & DMA_CCR_EN) || (pCh->CNDTR == 0)) { return; }
+	if(sim.dmaReload < pCh->CNDTR) { sim.dmaReload = pCh->CNDTR; }									// the count of the enable, never less than left
+	pos = sim.dmaReload - pCh->CNDTR;
+	((volatile uint32_t*)(uintptr_t)pCh->CMAR)[pos] = word;
+	sim.dmaWords++;
+	pCh->CNDTR--;
+	if(pCh->CNDTR == sim.dmaReload / 2) { simDma1.ISR |= DMA_ISR_HTIF1 | DMA_ISR_GIF1; }
+	if(pCh->CNDTR == 0)
+	{
+		simDma1.ISR |= DMA_ISR_TCIF1 | DMA_ISR_GIF1;
+		if(pCh->CCR & DMA_CCR_CIRC) { pCh->CNDTR = sim.dmaReload; }
+	}
+}
+
+/******************************************************************************************
+*  Regular sequence in dual mode, one DMA word per conversion pair
+*******************************************************************************************/
+static void simRegular(void){
+	ADC_TypeDef* pAdc1 = simAdcRegs(0);
+	ADC_TypeDef* pAdc2 = simAdcRegs(1);
+	uint32_t n = ((pAdc1->SQR1 & ADC_SQR1_L) >> ADC_SQR1_L_Pos) + 1;
+	uint32_t flags1 = ADC_ISR_EOC | ADC_ISR_EOS;
+	uint32_t flags2 = ADC_ISR_EOC | ADC_ISR_EOS;
+	uint32_t i;
+
+	for(i = 0; i < n; i++){
+		uint32_t pos = (i < 4) ? (ADC_SQR1_SQ1_Pos + 6 * i) : (6 * (i - 4));
+		uint8_t ch1 = (uint8_t)((((i < 4) ? pAdc1->SQR1 : pAdc1->SQR2) >> pos) & 0x1FU);
+		uint8_t ch2 = (uint8_t)((((i < 4) ? pAdc2->SQR1 : pAdc2->SQR2) >> pos) & 0x1FU);
+		uint16_t code1 = simCode(0, ch1);
+		uint16_t code2 = simCode(1, ch2);
+
+		pAdc1->DR = code1;
+		pAdc2->DR = code2;
+		simAdc12Common.CDR = code1 | ((uint32_t)code2 << 16);
+		flags1 |= simAwd(pAdc1, ch1, code1, 0);
+		flags2 |= simAwd(pAdc2, ch2, code2, 0);
+		simDmaWord(simAdc12Common.CDR);
+	}
+	simAdcSetFlags(0, flags1);
+	simAdcSetFlags(1, flags2);
+}
+
+/******************************************************************************************
+*  HRTIM writes of the firmware: output enable / disable, burst trigger, interrupt clear
+*******************************************************************************************/
+static void simHrtimCommit(void){
+	HRTIM_Common_TypeDef* pCommon = &simHrtim1.sCommonRegs;
+	uint8_t k;
+
+	if(pCommon->OENR) { sim.outputs |= pCommon->OENR; pCommon->OENR = 0; }
+	if(pCommon->ODISR) { sim.outputs &= ~pCommon->ODISR; pCommon->ODISR = 0; }
+	if(pCommon->BMTRGR & HRTIM_BMTRGR_SW)
+	{
+		if(pCommon->BMCR & HRTIM_BMCR_BME) { pCommon->BMCR |= HRTIM_BMCR_BMSTAT; sim.burstCount = 0; }
+		pCommon->BMTRGR = 0;
+	}
+	if(!(pCommon->BMCR & HRTIM_BMCR_BME)) { pCommon->BMCR &= ~HRTIM_BMCR_BMSTAT; }
+	for(k = 0; k < 5; k++){
+		simHrtim1.sTimerxRegs[k].TIMxISR &= ~simHrtim1.sTimerxRegs[k].TIMxICR;
+		simHrtim1.sTimerxRegs[k].TIMxICR = 0;
+	}
+}
+
+#if HRTIM_CURR_LIMIT_EEV && (HRTIM_PHASES == 1)
+/******************************************************************************************
+*  Counts from the period start to the COMP2 trip of EEV1, cmp1 if it doesn't trip.
+*  The DAC holds the first code of the ramp until the Timer E reset at CMP4, then the
+*  DMA moves one code per Timer E period and stops at the last one.
+*******************************************************************************************/
+static uint32_t simCurrLimit(uint32_t cmp1, float iStart, float ampsPerCount){
+	HRTIM_Timerx_TypeDef* pTimA = &simHrtim1.sTimerxRegs[TIM_A];
+	DMA_Channel_TypeDef* pCh = &simDma1Channel[6];
+	const uint16_t* pRamp = 0;
+	uint32_t steps = 1, stepCounts = cmp1, rampStart = 0;
+	uint32_t t = pTimA->CMP3xR;																									// EEFxR1 blanking to CMP3
+
+	if(!(simComp2.CSR & COMP2_CSR_COMP2EN) || !(pTimA->RSTx1R & HRTIM_RST1R_EXTVNT1)) { return cmp1; }
+	if((pCh->CCR & DMA_CCR_EN) && (pCh->CNDTR != 0))
+	{
+		pRamp = (const uint16_t*)(uintptr_t)pCh->CMAR;
+		steps = pCh->CNDTR;
+		stepCounts = simHrtim1.sTimerxRegs[TIM_E].PERxR;
+		rampStart = pTimA->CMP4xR;
+		pCh->CNDTR = 0;																														// played within this period
+	}
+	while(t < cmp1){
+		uint32_t step = (t < rampStart) ? 0 : (t - rampStart) / stepCounts;
+		uint32_t end;
+		float iTrip, i;
+
+		if(step >= steps - 1) { step = steps - 1; end = cmp1; }
+			else { end = rampStart + (step + 1) * stepCounts; }
+		if(end > cmp1) { end = cmp1; }
+		iTrip = (((pRamp != 0) ? pRamp[step] : simDac2.DHR12R1) - (float)ZERO_CURR_CODE) * (1.0f / SIM_AMPS_TO_CODE);
+		i = iStart + ampsPerCount * t;
+		if(i >= iTrip) { return t; }
+		if(ampsPerCount > 0.0f)
+		{
+			float tTrip = (iTrip - iStart) / ampsPerCount;
+			if(tTrip < end) { return (uint32_t)tTrip + 1; }
+		}
+		t = end;
+	}
+	return cmp1;
+}
+#endif
+
+static void simAfterHandler(void){
+	simAdcCommit(0);
+	simAdcCommit(1);
+	simHrtimCommit();
+}
+
+/******************************************************************************************
+*  One interrupt of the firmware, timed with the monotonic clock if sim.isrTiming
+*******************************************************************************************/
+static void simHandler(simIsr_ent isr, void (*pHandler)(void)){
+	if(sim.isrTiming)
+	{
+		struct timespec t0, t1;
+		clock_gettime(CLOCK_MONOTONIC, &t0);
+		pHandler();
+		clock_gettime(CLOCK_MONOTONIC, &t1);
+		sim.isrLastNs[isr] = (t1.tv_sec - t0.tv_sec) * 1e9 + (t1.tv_nsec - t0.tv_nsec);
+		sim.isrNs[isr] += sim.isrLastNs[isr];
+		sim.isrCalls[isr]++;
+	}
+	else
+	{
+		pHandler();
+	}
+	simAfterHandler();
+}
+
+/******************************************************************************************
+*  Fresh peripherals and plant, the firmware init as in main()
+*******************************************************************************************/
+void simInit(const plantParam_t* pParam){
+	uint32_t seed = sim.noiseSeed;
+
+	memset(&sim, 0, sizeof(sim));
+	sim.noiseSeed = (seed != 0) ? seed : 12345U;
+	sim.thread = 1;
+	simDevReset();
+	plantInit(&sim.plant, pParam);
+
+	isrProfInit();
+	DCDC_Init();
+	simAfterHandler();
+}
+
+void simStart(float vIn, float vOutLimit, float iOutLimit){
+	DCDC_setVoutLimit(vOutLimit);
+	DCDC_setIoutLimit(iOutLimit);
+	setVin(vIn);
+	DCDC_Start_Stop(1);
+}
+
+/******************************************************************************************
+*
+*
+*******************************************************************************************/
+void simPeriod(void){
+	HRTIM_Timerx_TypeDef* pTimA = &simHrtim1.sTimerxRegs[TIM_A];
+	HRTIM_Common_TypeDef* pCommon = &simHrtim1.sCommonRegs;
+	ADC_TypeDef* pAdc1;
+	uint32_t per, dtr, prsc, cmp2;
+	uint32_t idle = 0;
+	float period, tdtg;
+	uint8_t k;
+
+	simAfterHandler();																													// writes of the thread
+
+	/* period start: the preloaded registers */
+#if HRTIM_PHASES > 1
+	per = simHrtim1.sMasterRegs.MPER;
+#else
+	per = pTimA->PERxR;
+#endif
+	if(per == 0) { per = BUCK_PERIOD; }
+	period = per * (1.0f / SIM_HRTIM_HZ);
+	cmp2 = pTimA->CMP2xR;
+
+	if(pCommon->BMCR & HRTIM_BMCR_BMSTAT)
+	{
+		idle = (sim.burstCount < pCommon->BMCMPR);
+		if(++sim.burstCount > pCommon->BMPER) { sim.burstCount = 0; }
+	}
+
+	sim.pulses = 0;
+	for(k = 0; k < sim.plant.p.phases; k++){
+		float duty = 0.0f;
+		if(k < HRTIM_PHASES)
+		{
+			uint32_t cmp1 = simHrtim1.sTimerxRegs[TIM_A + k].CMP1xR;
+			if(!idle && (((sim.outputs >> (2 * k)) & 3U) == 3U)) { sim.pulses |= 1UL << k; }
+#if HRTIM_CURR_LIMIT_EEV && (HRTIM_PHASES == 1)
+			if(sim.pulses & (1UL << k))
+			{
+				const plant_t* pPlant = &sim.plant;
+				float volts = pPlant->vIn - pPlant->vOut - pPlant->iL[k] * pPlant->p.rL[k];
+				uint32_t end = simCurrLimit(cmp1, pPlant->iL[k], volts / pPlant->p.l * (1.0f / SIM_HRTIM_HZ));
+				if(end < cmp1) { cmp1 = end; pTimA->TIMxISR |= HRTIM_TIMISR_CPT1; }
+			}
+#endif
+			duty = cmp1 * (1.0f / per);
+			if(duty > 1.0f) { duty = 1.0f; }
+		}
+		sim.duty[k] = duty;
+	}
+	dtr = pTimA->DTxR;
+	prsc = (dtr & HRTIM_DTR_DTPRSC) >> HRTIM_DTR_DTPRSC_Pos;
+	tdtg = (float)(1U << prsc) * (1.0f / 8.0f);																	// counts of PLANT_TDTG, DTPRSC 3 - 6.944 ns
+	if(sim.pStep != 0)
+	{
+		sim.pStep(period);
+	}
+	else
+	{
+		plantStep(&sim.plant, period, sim.duty, sim.pulses,
+							((dtr & HRTIM_DTR_DTR) >> HRTIM_DTR_DTR_Pos) * tdtg, ((dtr & HRTIM_DTR_DTF) >> HRTIM_DTR_DTF_Pos) * tdtg);
+	}
+	sim.periods++;
+	sim.time += period;
+
+	/* ADC trigger, CMP2 */
+	pAdc1 = simAdcRegs(0);
+	if((pAdc1->CR & ADC_CR_JADSTART) && (pAdc1->JSQR & ADC_JSQR_JEXTEN))
+	{
+		simInjected();
+		pTimA->CNTxR = cmp2 + SIM_JEOS_COUNTS + sim.ctrlCounts;
+	}
+	if((pAdc1->CR & ADC_CR_ADSTART) && (pAdc1->CFGR & ADC_CFGR_EXTEN)) { simRegular(); }
+
+	if(simNvicEnabled[ADC1_2_IRQn] &&
+		 ((simAdcFlags(0) & simAdcRegs(0)->IER) | (simAdcFlags(1) & simAdcRegs(1)->IER)))
+	{
+		sim.adcIrqs++;
+		simHandler(SIM_ISR_ADC, ADC1_2_IRQHandler);
+	}
+	if((pAdc1->CR & ADC_CR_ADSTART) && !(pAdc1->CFGR & ADC_CFGR_EXTEN))										// software start, single sequence
+	{
+		simRegular();
+		pAdc1->CR &= ~ADC_CR_ADSTART;
+	}
+
+	if(simNvicEnabled[DMA1_Channel1_IRQn])
+	{
+		uint32_t ccr = simDma1Channel[0].CCR;
+		uint32_t mask = ((ccr & DMA_CCR_HTIE) ? DMA_ISR_HTIF1 : 0) | ((ccr & DMA_CCR_TCIE) ? DMA_ISR_TCIF1 : 0);
+		if(simDma1.ISR & mask)
+		{
+			sim.dmaIrqs++;
+			simHandler(SIM_ISR_DMA, DMA1_Channel1_IRQHandler);
+			for(k = 0; k < 7; k++){
+				if(simDma1.IFCR & (1UL << (4 * k))) { simDma1.ISR &= ~(0xFUL << (4 * k)); }
+			}
+			simDma1.ISR &= ~simDma1.IFCR;
+			simDma1.IFCR = 0;
+			simAfterHandler();
+		}
+	}
+
+	pTimA->TIMxISR |= HRTIM_TIMISR_REP;
+	if(simNvicEnabled[HRTIM1_TIMA_IRQn] && (pTimA->TIMxDIER & HRTIM_TIMDIER_REPIE))
+	{
+		simHandler(SIM_ISR_HRTIM, HRTIM1_TIMA_IRQHandler);
+	}
+
+	if(simExti.SWIER & simExti.IMR & EXTI_SWIER_SWIER0)
+	{
+		simExti.SWIER &= ~EXTI_SWIER_SWIER0;
+		simExti.PR |= EXTI_PR_PR0;
+		if(simNvicEnabled[EXTI0_IRQn])
+		{
+			simHandler(SIM_ISR_EXTI0, EXTI0_IRQHandler);
+			simExti.PR = 0;
+		}
+	}
+
+	if(sim.thread) { DCDC_Loop(0); }
+	if(sim.pHook != 0) { sim.pHook(); }
+}
+
+void simRun(uint32_t periods){
+	while(periods--){
+		simPeriod();
+	}
+}
@@ -0,0 +1,135 @@
+/*
+ * simdev.c
+ *
+ *  Created on: 17 OCT. 2026
+ *  Peripheral instances of the host simulation
+ *
+ *  ADC1 and ADC2 keep their flags apart from the register: ISR shows them with
+ *  SIM_ISR_SHOWN, a write of the firmware replaces that value, the bits written are
+ *  cleared at the next commit. simAdcAccess commits before every access, so the
+ *  firmware sees the hardware behaviour within one handler too.
+ */
+
+#include <string.h>
+#include "sim.h"
+
+#define SIM_ISR_SHOWN					(1UL << 31)														// not an ADC flag
+
+HRTIM_TypeDef simHrtim1;
+ADC_Common_TypeDef simAdc12Common;
+DMA_TypeDef simDma1;
+DMA_Channel_TypeDef simDma1Channel[7];
+RCC_TypeDef simRcc;
+FLASH_TypeDef simFlash;
+GPIO_TypeDef simGpio[4];
+EXTI_TypeDef simExti;
+COMP_TypeDef simComp2;
+DAC_TypeDef simDac2;
+USART_TypeDef simUsart1;
+CoreDebug_Type simCoreDebug;
+
+uint32_t SystemCoreClock = 72000000U;
+uint8_t simNvicEnabled[SIM_IRQ_NUM];
+uint32_t simDwtStep = 0;
+
+static DWT_Type simDwt;
+static uint8_t simNvicPriority[SIM_IRQ_NUM];
+
+static struct {
+	ADC_TypeDef regs;
+	uint32_t flags;
+	uint8_t enabled;
+} simAdc[2];
+
+/******************************************************************************************
+*  Every peripheral at its reset value, the DLL of the HRTIM is calibrated at once
+*******************************************************************************************/
+void simDevReset(void){
+	memset(&simHrtim1, 0, sizeof(simHrtim1));
+	memset(&simAdc12Common, 0, sizeof(simAdc12Common));
+	memset(&simDma1, 0, sizeof(simDma1));
+	memset(simDma1Channel, 0, sizeof(simDma1Channel));
+	memset(&simRcc, 0, sizeof(simRcc));
+	memset(&simFlash, 0, sizeof(simFlash));
+	memset(simGpio, 0, sizeof(simGpio));
+	memset(&simExti, 0, sizeof(simExti));
+	memset(&simComp2, 0, sizeof(simComp2));
+	memset(&simDac2, 0, sizeof(simDac2));
+	memset(&simUsart1, 0, sizeof(simUsart1));
+	memset(&simCoreDebug, 0, sizeof(simCoreDebug));
+	memset(&simDwt, 0, sizeof(simDwt));
+	memset(simAdc, 0, sizeof(simAdc));
+	memset(simNvicEnabled, 0, sizeof(simNvicEnabled));
+	memset(simNvicPriority, 0, sizeof(simNvicPriority));
+
+	simHrtim1.sCommonRegs.ISR = HRTIM_ISR_DLLRDY;
+	simUsart1.ISR = USART_ISR_TC;																		// transmitter idle
+	simAdc[0].regs.ISR = SIM_ISR_SHOWN;
+	simAdc[1].regs.ISR = SIM_ISR_SHOWN;
+}
+
+/******************************************************************************************
+*  Hardware side of the last writes: written ISR bits cleared, the bits of CR that the
+*  ADC clears itself, ADRDY after ADEN
+*******************************************************************************************/
+void simAdcCommit(uint8_t adc){
+	ADC_TypeDef* pRegs = &simAdc[adc].regs;
+	uint32_t cr = pRegs->CR;
+
+	if(!(pRegs->ISR & SIM_ISR_SHOWN)) { simAdc[adc].flags &= ~pRegs->ISR; }
+	if(cr & ADC_CR_ADCAL) { cr &= ~ADC_CR_ADCAL; }																// calibration done
+	if(cr & ADC_CR_ADSTP) { cr &= ~(ADC_CR_ADSTP | ADC_CR_ADSTART); }
+	if(cr & ADC_CR_JADSTP) { cr &= ~(ADC_CR_JADSTP | ADC_CR_JADSTART); }
+	if(cr & ADC_CR_ADDIS) { cr &= ~(ADC_CR_ADDIS | ADC_CR_ADEN); simAdc[adc].enabled = 0; }
+	if((cr & ADC_CR_ADEN) && !simAdc[adc].enabled)
+	{
+		simAdc[adc].enabled = 1;
+		simAdc[adc].flags |= ADC_ISR_ADRDY;
+	}
+	pRegs->CR = cr;
+	pRegs->ISR = simAdc[adc].flags | SIM_ISR_SHOWN;
+}
+
+ADC_TypeDef* simAdcAccess(uint8_t adc){
+	simAdcCommit(adc);
+	return &simAdc[adc].regs;
+}
+
+ADC_TypeDef* simAdcRegs(uint8_t adc){
+	return &simAdc[adc].regs;
+}
+
+void simAdcSetFlags(uint8_t adc, uint32_t flags){
+	simAdcCommit(adc);
+	simAdc[adc].flags |= flags;
+	simAdc[adc].regs.ISR = simAdc[adc].flags | SIM_ISR_SHOWN;
+}
+
+uint32_t simAdcFlags(uint8_t adc){
+	simAdcCommit(adc);
+	return simAdc[adc].flags;
+}
+
+/******************************************************************************************
+*  The cycle counter runs simDwtStep per access, 0 - stands still
+*******************************************************************************************/
+DWT_Type* simDwtAccess(void){
+	if(simDwt.CTRL & DWT_CTRL_CYCCNTENA_Msk) { simDwt.CYCCNT += simDwtStep; }
+	return &simDwt;
+}
+
+/******************************************************************************************
+*
+*
+*******************************************************************************************/
+void NVIC_SetPriority(int32_t IRQn, uint32_t priority){
+	if((IRQn >= 0) && (IRQn < SIM_IRQ_NUM)) { simNvicPriority[IRQn] = (uint8_t)priority; }
+}
+
+void NVIC_EnableIRQ(int32_t IRQn){
+	if((IRQn >= 0) && (IRQn < SIM_IRQ_NUM)) { simNvicEnabled[IRQn] = 1; }
+}
+
+void NVIC_DisableIRQ(int32_t IRQn){
+	if((IRQn >= 0) && (IRQn < SIM_IRQ_NUM)) { simNvicEnabled[IRQn] = 0; }
+}
@@ -0,0 +1,193 @@
+/*
+ * slow_adc.c
+ *
+ *  Created on: 17 OCT. 2026
+ *  Round robin of the slow ADC pairs against the full slow sequence
+ *
+ *  Built twice, slow_adc_rr (ADC_SLOW_ROUND_ROBIN 1) and slow_adc_all (0). Both run the
+ *  closed loop and check every start of the regular sequence: one start per
+ *  2^ADC_SLOW_DIV_LOG2 periods with ADC_SLOW_SLOTS DMA words; with the round robin the
+ *  pair in SQR1 is the next one of the rotation, so every slow pair is converted once per
+ *  2^ADC_SLOW_ROUND_LOG2 periods. The codes in slowValue must be the codes of the sim for
+ *  the channels of their field, a pair stored in the slot of another one would show.
+ *  "record <file>" (slow_adc_all) writes the DMA words and the host ns of the handlers per
+ *  period, "compare <file>" (slow_adc_rr) prints the reduction; the DMA words must fall by
+ *  ADC_SLOW_PAIRS. The host times only compare the variants, the cycles of the board come
+ *  from isrprof.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "sim.h"
+#include "adc.h"
+#include "dcdc.h"
+
+#define SLOW_PERIODS					100000U															// 5 s of the board
+#define SLOW_CODE_TOL					1																		// codes, constant channels
+#define SLOW_IOUT_TOL					32																	// codes, I_OUTCOM_SENSOR: the slow average against the last period
+
+#if ADC_SLOW_ROUND_ROBIN
+#define SLOW_NAME							"round robin"
+#else
+#define SLOW_NAME							"full sequence"
+#endif
+
+typedef char slowTestCheck_t[ADC_INJECTED_FAST ? 1 : -1];										// the slow pairs are a software started sequence
+
+extern slowAdcValue_t slowValue;
+
+static const uint8_t slowCh1[ADC_SLOW_PAIRS] = { VREF_CPU, TMP_CMP, V_LEAK_REF, TMP_CASE };	// the fields of slowAdcValue_t
+static const uint8_t slowCh2[ADC_SLOW_PAIRS] = { V12_SENSOR, I_OUTCOM_SENSOR, V_LEAK_CHECK, V_INT_REF };
+
+static uint32_t lastWords;
+static uint64_t lastStart;
+#if ADC_SLOW_ROUND_ROBIN
+static int8_t lastPair = -1;
+#endif
+static uint32_t starts, startFails;
+static uint32_t pairStarts[ADC_SLOW_PAIRS];
+
+/******************************************************************************************
+*  Per period: a start of the regular sequence shows as DMA words, its pair stays in SQR1
+*  until the next start
+*******************************************************************************************/
+static void periodHook(void){
+	uint32_t words = sim.dmaWords - lastWords;
+
+	lastWords = sim.dmaWords;
+	if(words == 0) { return; }
+	if(words != ADC_SLOW_SLOTS) { startFails++; }
+	if((starts != 0) && (sim.periods - lastStart != (1U << ADC_SLOW_DIV_LOG2))) { startFails++; }
+	lastStart = sim.periods;
+	starts++;
+#if ADC_SLOW_ROUND_ROBIN
+	{
+		uint8_t ch1 = (uint8_t)((simAdcRegs(0)->SQR1 & ADC_SQR1_SQ1) >> ADC_SQR1_SQ1_Pos);
+		uint8_t ch2 = (uint8_t)((simAdcRegs(1)->SQR1 & ADC_SQR1_SQ1) >> ADC_SQR1_SQ1_Pos);
+		int8_t pair = 0;
+
+		while((pair < ADC_SLOW_PAIRS) && ((slowCh1[pair] != ch1) || (slowCh2[pair] != ch2))){
+			pair++;
+		}
+		if(pair == ADC_SLOW_PAIRS) { startFails++; return; }
+		if((lastPair >= 0) && (pair != (lastPair + 1) % ADC_SLOW_PAIRS)) { startFails++; }
+		lastPair = pair;
+		pairStarts[pair]++;
+	}
+#else
+	{
+		uint8_t pair;
+		for(pair = 0; pair < ADC_SLOW_PAIRS; pair++){
+			pairStarts[pair]++;
+		}
+	}
+#endif
+}
+
+/******************************************************************************************
+*  slowValue against the codes of the sim, field by field
+*******************************************************************************************/
+static int checkCodes(void){
+	const uint16_t* pField = &slowValue.vrefCpu;
+	uint32_t fails = 0;
+	uint8_t pair;
+
+	for(pair = 0; pair < ADC_SLOW_PAIRS; pair++){
+		int code1 = pField[2 * pair], code2 = pField[2 * pair + 1];
+		int sim1 = simCode(0, slowCh1[pair]), sim2 = simCode(1, slowCh2[pair]);
+		int tol2 = (slowCh2[pair] == I_OUTCOM_SENSOR) ? SLOW_IOUT_TOL : SLOW_CODE_TOL;
+		if(abs(code1 - sim1) > SLOW_CODE_TOL) { fails++; }
+		if(abs(code2 - sim2) > tol2) { fails++; }
+		printf("pair %u: %4d / %4d codes, sim %4d / %4d, %u starts\n", pair, code1, code2, sim1, sim2, pairStarts[pair]);
+	}
+	return fails == 0;
+}
+
+/******************************************************************************************
+*  ns of all handlers per period, less the cost of the clock reads around them
+*******************************************************************************************/
+static double handlerNs(void){
+	struct timespec t0, t1;
+	double clockNs = 0.0, totalNs = 0.0;
+	uint16_t i;
+	uint8_t n;
+
+	for(i = 0; i < 1000; i++){
+		clock_gettime(CLOCK_MONOTONIC, &t0);
+		clock_gettime(CLOCK_MONOTONIC, &t1);
+		clockNs += (t1.tv_sec - t0.tv_sec) * 1e9 + (t1.tv_nsec - t0.tv_nsec);
+	}
+	clockNs *= 1.0 / 1000.0;
+	for(n = 0; n < SIM_ISR_NUM; n++){
+		double ns = sim.isrNs[n] - clockNs * sim.isrCalls[n];
+		if(ns > 0.0) { totalNs += ns; }
+	}
+	return totalNs / SLOW_PERIODS;
+}
+
+int main(int argc, char** argv){
+	plantParam_t param;
+	double wordsPerPeriod, ns, wordsOther, nsOther;
+	uint32_t words0;
+	FILE* pFile;
+	int compare;
+	int ok = 1;
+	uint8_t pair;
+
+	if((argc != 3) || (strcmp(argv[1], "record") && strcmp(argv[1], "compare")))
+	{
+		fprintf(stderr, "usage: %s record|compare <file>\n", argv[0]);
+		return 2;
+	}
+	compare = (strcmp(argv[1], "compare") == 0);
+
+	plantDefault(&param);
+	simInit(&param);
+	simRun(2000);
+	simStart(240.0f, 150.0f, 80.0f);
+	simRun(20000);
+
+	words0 = sim.dmaWords;
+	lastWords = words0;
+	sim.pHook = periodHook;
+	sim.isrTiming = 1;
+	simRun(SLOW_PERIODS);
+	sim.isrTiming = 0;
+
+	wordsPerPeriod = (double)(sim.dmaWords - words0) / SLOW_PERIODS;
+	ns = handlerNs();
+	printf("%s: %u starts, %u off their period, pair or words, %.3f DMA words and %.1f host ns of handlers per period\n",
+				 SLOW_NAME, starts, startFails, wordsPerPeriod, ns);
+	ok &= (startFails == 0) && (starts >= SLOW_PERIODS >> ADC_SLOW_DIV_LOG2);
+	for(pair = 0; pair < ADC_SLOW_PAIRS; pair++){
+		ok &= (pairStarts[pair] + 1 >= (SLOW_PERIODS >> ADC_SLOW_ROUND_LOG2) * (ADC_SLOW_ROUND_ROBIN ? 1 : ADC_SLOW_PAIRS));
+	}
+	ok &= checkCodes();
+	ok &= (DCDC_getFault() == DCDC_FAULT_NONE);
+
+	if(compare)
+	{
+		pFile = fopen(argv[2], "r");
+		if((pFile == 0) || (fscanf(pFile, "%lf %lf", &wordsOther, &nsOther) != 2))
+		{
+			fprintf(stderr, "%s: no record of the other variant\n", argv[2]);
+			return 2;
+		}
+		fclose(pFile);
+		printf("against the other variant: DMA words %.3f -> %.3f per period (1/%.1f), host ns of handlers %.1f -> %.1f\n",
+					 wordsOther, wordsPerPeriod, wordsOther / wordsPerPeriod, nsOther, ns);
+		ok &= (wordsPerPeriod * ADC_SLOW_PAIRS > wordsOther * 0.99) && (wordsPerPeriod * ADC_SLOW_PAIRS < wordsOther * 1.01);
+	}
+	else
+	{
+		pFile = fopen(argv[2], "w");
+		if(pFile == 0) { return 2; }
+		fprintf(pFile, "%f %f\n", wordsPerPeriod, ns);
+		fclose(pFile);
+	}
+
+	printf("%s\n", ok ? "PASS" : "FAIL");
+	return ok ? 0 : 1;
+}
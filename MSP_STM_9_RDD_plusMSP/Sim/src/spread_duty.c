@@ -0,0 +1,138 @@
+/*
+ * spread_duty.c
+ *
+ *  Created on: 17 OCT. 2026
+ *  Duty ratio of spreadScaleDuty over the spread spectrum sweep
+ *
+ *  Every profile is stepped with spreadNextPeriod. At every period each duty of
+ *  DUTY_MIN..DUTY_MAX in counts of BUCK_PERIOD is scaled by spreadScaleDuty; CMP against
+ *  the exact dutyRef * PER / BUCK_PERIOD must stay within SPREAD_DUTY_TOL counts, so CMP / PER
+ *  is the ratio of dutyRef for every period. The periods must stay on the grid, the
+ *  triangle must walk every step of it by PERIOD_STEP and the custom table must be
+ *  followed, bad tables rejected.
+ *  The incremental rescale the regulator had before (buckPeriod * 1000 / dutyCycle, then
+ *  PERIOD_STEP * 1000 / that, added to the duty every period) is run over the same triangle
+ *  for the printout: its truncation is carried from period to period.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "spread.h"
+
+#define SPREAD_DUTY_TOL				1.0																	// counts of the current period
+#define SPREAD_SWEEPS					100U																// triangles of the reference
+#define SPREAD_LFSR_PERIODS		65535U
+#define SPREAD_REF_DUTY_LOW		4321U																// counts of BUCK_PERIOD, not a round ratio
+#define SPREAD_REF_DUTY_HIGH	30007U
+
+static const uint8_t customTable[] = { 0, 59, 30, 1, 58, 29, 7 };
+static const uint8_t badTable[] = { 3, SPREAD_STEPS_NUM };
+
+static double errMax;
+static uint32_t gridFails;
+
+/******************************************************************************************
+*  One period of the profile, every duty of the range against its exact scaling
+*******************************************************************************************/
+static uint16_t checkPeriod(void){
+	uint16_t per = spreadNextPeriod();
+	uint32_t d;
+
+	if((per < BUCK_PERIOD_MIN) || (per > BUCK_PERIOD_MAX) || ((per - BUCK_PERIOD_MIN) % PERIOD_STEP)) { gridFails++; }
+	for(d = DUTY_MIN; d <= DUTY_MAX; d++){
+		double err = fabs(spreadScaleDuty((uint16_t)d) - (double)d * per / BUCK_PERIOD);
+		if(err > errMax) { errMax = err; }
+	}
+	return per;
+}
+
+static int testTriangle(void){
+	uint8_t seen[SPREAD_STEPS_NUM] = { 0 };
+	uint16_t last = BUCK_PERIOD_MAX;
+	uint32_t n, stepFails = 0, missing = 0;
+
+	spreadInit();
+	errMax = 0.0;
+	gridFails = 0;
+	for(n = 0; n < 2 * SPREAD_STEPS_NUM; n++){
+		uint16_t per = checkPeriod();
+		if(abs((int)per - (int)last) != PERIOD_STEP) { stepFails++; }
+		seen[SPREAD_INDEX(per)] = 1;
+		last = per;
+	}
+	for(n = 0; n < SPREAD_STEPS_NUM; n++){
+		if(!seen[n]) { missing++; }
+	}
+	printf("triangle: %u periods, %u off the grid, %u steps not PERIOD_STEP, %u periods missing, CMP error %.3f counts max\n",
+				 2 * SPREAD_STEPS_NUM, gridFails, stepFails, missing, errMax);
+	return (gridFails == 0) && (stepFails == 0) && (missing == 0) && (errMax <= SPREAD_DUTY_TOL);
+}
+
+static int testLfsr(void){
+	uint32_t n;
+
+	spreadInit();
+	spreadSetProfile(SPREAD_LFSR, 0, 0);
+	errMax = 0.0;
+	gridFails = 0;
+	for(n = 0; n < SPREAD_LFSR_PERIODS; n++){
+		checkPeriod();
+	}
+	printf("LFSR:     %u periods, %u off the grid, CMP error %.3f counts max\n", SPREAD_LFSR_PERIODS, gridFails, errMax);
+	return (gridFails == 0) && (errMax <= SPREAD_DUTY_TOL);
+}
+
+static int testCustom(void){
+	uint32_t n, orderFails = 0;
+	int ok;
+
+	spreadInit();
+	ok = (spreadSetProfile(SPREAD_CUSTOM, badTable, sizeof(badTable)) != 0) && (spreadSetProfile(SPREAD_CUSTOM, 0, 4) != 0);
+	ok &= (spreadSetProfile(SPREAD_CUSTOM, customTable, sizeof(customTable)) == 0);
+	errMax = 0.0;
+	gridFails = 0;
+	for(n = 0; n < 3 * sizeof(customTable); n++){
+		if(checkPeriod() != BUCK_PERIOD_MIN + customTable[n % sizeof(customTable)] * PERIOD_STEP) { orderFails++; }
+	}
+	spreadSetProfile(SPREAD_OFF, 0, 0);
+	if(checkPeriod() != BUCK_PERIOD) { orderFails++; }
+	printf("custom:   %u periods, %u off the table, CMP error %.3f counts max\n", (uint32_t)(3 * sizeof(customTable)), orderFails, errMax);
+	return ok && (orderFails == 0) && (gridFails == 0) && (errMax <= SPREAD_DUTY_TOL);
+}
+
+/******************************************************************************************
+*  The former rescale, two divides per period, over SPREAD_SWEEPS triangles
+*******************************************************************************************/
+static double oldRescaleError(uint16_t dutyStart){
+	int32_t period = BUCK_PERIOD_MAX, duty = dutyStart * BUCK_PERIOD_MAX / BUCK_PERIOD;
+	int32_t dir = -1;
+	double err = 0.0;
+	uint32_t n;
+
+	for(n = 0; n < 2 * (SPREAD_STEPS_NUM - 1) * SPREAD_SWEEPS; n++){
+		int32_t deltaDuty = period * 1000 / duty;
+		double e;
+		deltaDuty = PERIOD_STEP * 1000 / deltaDuty;
+		period += dir * PERIOD_STEP;
+		duty += dir * deltaDuty;
+		if(period == BUCK_PERIOD_MIN) { dir = 1; }
+			else if(period == BUCK_PERIOD_MAX) { dir = -1; }
+		e = fabs(duty - (double)dutyStart * period / BUCK_PERIOD);
+		if(e > err) { err = e; }
+	}
+	return err;
+}
+
+int main(void){
+	int ok = 1;
+
+	ok &= testTriangle();
+	ok &= testLfsr();
+	ok &= testCustom();
+	printf("former rescale over %u triangles: CMP error %.1f counts max at duty %u, %.1f at %u\n", SPREAD_SWEEPS,
+				 oldRescaleError(SPREAD_REF_DUTY_LOW), SPREAD_REF_DUTY_LOW, oldRescaleError(SPREAD_REF_DUTY_HIGH), SPREAD_REF_DUTY_HIGH);
+
+	printf("%s\n", ok ? "PASS" : "FAIL");
+	return ok ? 0 : 1;
+}
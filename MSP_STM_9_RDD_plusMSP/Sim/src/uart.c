@@ -0,0 +1,157 @@
+/*
+ * uart.c
+ *
+ *  Created on: 17 OCT. 2026
+ *  The USART1 protocol of the MSP430 code against the sim, see uart.h
+ */
+
+#include <string.h>
+#include "sim.h"
+#include "uart.h"
+#include "usci.h"
+#include "crc16.h"
+#include "lcd.h"
+#include "time.h"
+#include "ctrl.h"
+
+#define UART_DLE							0x10
+#define UART_STX							0x02
+#define UART_ETX							0x03
+#define UART_FOOTER						6																		// CRC, its stuffing, DLE ETX
+#define UART_TDR_NONE					0x100U																// not a byte, TDR not written
+
+extern unsigned char tx_count;
+extern unsigned int tx_buf_len;
+extern void USART1_IRQHandler(void);
+
+/* the board parts of the MSP430 code the protocol doesn't use */
+void lcd_loadTelemetry(void) {}
+int lcd_queueWrite(int type) { (void)type; return 0; }
+void lcd_checkPersistentUpdate(void) {}
+void lcd_checkAutoTuneUpdate(void) {}
+void TIME_set(Time tm) { (void)tm; }
+Time TIME_get(void) { return 0; }
+void CTRL_enableOutput(int enable) { (void)enable; }
+
+static uint8_t rxPacket[PACKET_LENGTH];
+static uint8_t txPacket[PACKET_LENGTH];
+
+/******************************************************************************************
+*  A packet of the host, framed as uart_send frames it
+*******************************************************************************************/
+static uint16_t uartFrame(uint8_t* pOut, packetIdentifier_t id, const uint8_t* pData, uint16_t size){
+	uint16_t k = 4, len, i;
+	uint8_t c, d;
+
+	pOut[0] = UART_DLE;
+	pOut[1] = UART_STX;
+	if(id.byte == UART_DLE) { pOut[k++] = UART_DLE; }
+	pOut[k++] = id.byte;
+	for(i = 0; i < size; i++){
+		if(pData[i] == UART_DLE) { pOut[k++] = UART_DLE; }
+		pOut[k++] = pData[i];
+	}
+	len = k + UART_FOOTER;
+	pOut[2] = (uint8_t)len;
+	pOut[3] = (len == UART_DLE) ? UART_DLE : 0;
+	CalculateCRC16(pOut, k + 2, 0, 0x00);
+	c = pOut[k];
+	d = pOut[k + 1];
+	if(c == UART_DLE) { pOut[k++] = UART_DLE; }
+	pOut[k++] = c;
+	if(d == UART_DLE) { pOut[k++] = UART_DLE; }
+	pOut[k++] = d;
+	while(k < len - 2){
+		pOut[k++] = 0;
+	}
+	pOut[k++] = UART_DLE;
+	pOut[k++] = UART_ETX;
+	return len;
+}
+
+/******************************************************************************************
+*  The packet through the receive interrupt, one uart_receive of the main loop, the reply
+*  clocked out through the transmit interrupt; returns its bytes, 0 - no reply
+*******************************************************************************************/
+static uint16_t uartExchange(const uint8_t* pPacket, uint16_t len){
+	uint16_t n = 0, i;
+
+	for(i = 0; i < len; i++){
+		simUsart1.RDR = pPacket[i];
+		simUsart1.ISR |= USART_ISR_RXNE;
+		USART1_IRQHandler();
+		simUsart1.ISR &= ~USART_ISR_RXNE;
+	}
+	simUsart1.TDR = UART_TDR_NONE;
+	uart_receive();
+	if(simUsart1.TDR == UART_TDR_NONE) { return 0; }
+	txPacket[n++] = (uint8_t)simUsart1.TDR;																			// uart_tx
+	while((tx_count < tx_buf_len) && (n < PACKET_LENGTH)){
+		USART1_IRQHandler();																												// TC, the next byte
+		txPacket[n++] = (uint8_t)simUsart1.TDR;
+	}
+	USART1_IRQHandler();																													// TC of the last byte, back to idle
+	return n;
+}
+
+void uartInit(void){
+	uart_init();
+	uartExchange(rxPacket, 0);																										// RESPONSE_STARTUP of the first uart_receive
+}
+
+int uartCommand(uint16_t code, uint16_t arg, command_t* pResponse){
+	packetIdentifier_t id;
+	command_t command;
+	uint16_t len;
+
+	id.byte = 0;
+	id.type = TYPE_COMMAND;
+	id.version = VERSION_COMMAND;
+	command.commandCode = code;
+	command.arg = arg;
+	len = uartExchange(rxPacket, uartFrame(rxPacket, id, command.bytes, sizeof(command_t)));
+	if(uartDecode(txPacket, len, &id, pResponse->bytes, sizeof(command_t))) { return -1; }
+	return (id.type == TYPE_COMMAND) ? 0 : -1;
+}
+
+int uartRequest(uint8_t type, uint8_t version, void* pData, uint16_t size){
+	packetIdentifier_t id;
+	uint16_t len;
+
+	id.byte = 0;
+	id.type = type;
+	id.request = 1;
+	id.version = version;
+	len = uartExchange(rxPacket, uartFrame(rxPacket, id, 0, 0));
+	if(uartDecode(txPacket, len, &id, pData, size)) { return -1; }
+	return ((id.type == type) && (id.version == version) && !id.request) ? 0 : -1;
+}
+
+/******************************************************************************************
+*  Framing, length, stuffing and CRC of a packet of the board, its data unstuffed; the
+*  data must be size bytes
+*******************************************************************************************/
+int uartDecode(const uint8_t* pPacket, uint16_t len, packetIdentifier_t* pId, void* pData, uint16_t size){
+	uint8_t crc[PACKET_LENGTH];
+	uint8_t* pOut = pData;
+	uint16_t k = 4, i;
+
+	if((len < UART_FOOTER + 5) || (len > PACKET_LENGTH)) { return -1; }
+	if((pPacket[0] != UART_DLE) || (pPacket[1] != UART_STX) || (pPacket[len - 2] != UART_DLE) || (pPacket[len - 1] != UART_ETX)) { return -1; }
+	if((pPacket[2] != (uint8_t)len) || (pPacket[3] != ((len == UART_DLE) ? UART_DLE : 0))) { return -1; }
+	if(pPacket[k] == UART_DLE) { k++; }
+	pId->byte = pPacket[k++];
+	for(i = 0; (i < size) && (k < len - UART_FOOTER); i++){
+		if(pPacket[k] == UART_DLE) { k++; }
+		pOut[i] = pPacket[k++];
+	}
+	if((i != size) || (k != len - UART_FOOTER)) { return -1; }
+
+	memcpy(crc, pPacket, k);
+	i = k;
+	if(pPacket[i] == UART_DLE) { i++; }
+	crc[k] = pPacket[i++];
+	if(pPacket[i] == UART_DLE) { i++; }
+	crc[k + 1] = pPacket[i];
+	return (CalculateCRC16(crc, k + 2, 1, 0x00) == 2) ? 0 : -1;
+}
@@ -25,6 +25,23 @@
 #define MAX_DUTY_STEP_NEG			(-1 * MAX_DUTY_STEP_POS)
 #define PERIOD_STEP						200
 #define PERIOD_STEP_NEG				(-1 * PERIOD_STEP)
+#ifndef HRTIM_PHASES
+#define HRTIM_PHASES					1																	// interleaved buck phases on TIM_A..TIM_D, the board has TA1 TA2 only
+#endif
+#define PHASE_SLAVE_PERIOD		0xFFDF														// several phases: a phase timer is reset by the master before this
+#define PHASE_TRIM_MAX				(BUCK_PERIOD / 50)								// +/-2% duty trim per phase
+#define DEAD_TIME_INIT				(HRTIM_DTR_DTR_6 >> HRTIM_DTR_DTR_Pos)		// Tdtg counts, 64 x 6.944 ns = 444 ns rising and falling
+#ifndef HRTIM_CURR_LIMIT_EEV
+#define HRTIM_CURR_LIMIT_EEV	0																	// 1 - COMP2 through EEV1 resets Tx1 of every phase within the period, comp.c
+#endif
+#define CURR_LIMIT_BLANK			(BUCK_PERIOD / 50)								// 1 us after the period start: rising dead time and turn-on spike
+#ifndef HRTIM_PEAK_CURRENT
+#define HRTIM_PEAK_CURRENT		0																	// 1 - peak current mode: the comparator ends the pulse, CMP1 caps it at DUTY_MAX, pcmc.c
+#endif
+#define PCMC_RAMP_STEPS				16																// DAC steps of the slope compensation per period
+#define PCMC_RAMP_STEP				(DUTY_MAX / PCMC_RAMP_STEPS)			// Timer E period, 1.9 us
+#define BURST_PERIODS					16																// PWM periods per burst
+#define BURST_IDLE_PERIODS		12																// of them with TA1 TA2 idle
 
 typedef
 	enum {
@@ -43,12 +60,21 @@ typedef
 
 
 
+typedef char hrtimPhasesCheck_t[((HRTIM_PHASES >= 1) && (HRTIM_PHASES <= 4)) ? 1 : -1];
+typedef char hrtimPeakCurrentCheck_t[(!HRTIM_PEAK_CURRENT || (HRTIM_CURR_LIMIT_EEV && (HRTIM_PHASES == 1))) ? 1 : -1];	// one current sensor, one phase
+
+extern int16_t hrtimPhaseTrim[HRTIM_PHASES];
+
 /** function prototype declarations **/
 extern void initHighResolutionTimer(void);
 extern uint16_t hrtimerUpdateDuty(uint16_t dutycycle);
+extern void hrtimerUpdatePeriod(uint16_t period);
+extern void hrtimerSetDeadTime(uint16_t rise, uint16_t fall);
 extern void hrtimersGpioInit(void);
 extern uint16_t hrtimersOutEnable(uint16_t duty);
 extern void hrtimersOutDisable(void);
+extern void hrtimersBurstStart(void);
+extern void hrtimersBurstStop(void);
 
 
 #endif /* CODE_INC_HIRESTIM_H_ */
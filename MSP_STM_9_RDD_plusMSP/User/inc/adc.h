@@ -36,7 +36,8 @@
 
 #define ADC_STARTUP_TIMEOUT		20												// mks
 
-#define ADC_AVERAGE_NUMBER		1
+#define ADC_OUT_FRAC					4													// decimator output = average code * 2^ADC_OUT_FRAC
+#define ADC_AVERAGE_NUMBER		(1U << ADC_OUT_FRAC)			// scaled like a sum of that many samples
 #define ADC_SAMPLE_NUMBER			ADC_AVERAGE_NUMBER * 1.0f
 
 #define VIN_DIVIDER_R1				660.0f 										// kOhm
@@ -67,24 +68,57 @@
 #define TMP_CASE_COEFF				1.0f
 #define INT_REF_COEFF					1.0f
 
+/*  fixed-point scaling: value(Q16) = sum * SCALE * (2^32 / vrefCpu sum) >> 32 */
+#define FIXED_Q								16
+#define FIXED_ONE							(1UL << FIXED_Q)
+#define VIN_SCALE_Q						((uint32_t)(CPU_VREF_VALUE * VIN_CONVERCE_COEFF * FIXED_ONE))
+#define VOUT_SCALE_Q					((uint32_t)(CPU_VREF_VALUE * VOUT_CONVERCE_COEFF * FIXED_ONE))
+#define I_SCALE_Q							((uint32_t)(CPU_VREF_VALUE * 50 * I_CONVERCE_COEFF * FIXED_ONE))
+#define V12_SCALE_Q						((uint32_t)(CPU_VREF_VALUE * V12_CONVERCE_COEFF * FIXED_ONE))
+
+#define ADC_PAIRS_NUM					6													// ADC1/ADC2 pairs of a sample set
+
+/*  1 - Iin Vin Iout Vout are an injected group on HRTIM_ADCTRG2, the control runs at its JEOS;
+    the slow channels are a regular sequence, started every 2^ADC_SLOW_DIV_LOG2 PWM periods */
+#define ADC_INJECTED_FAST			1
+#define ADC_FAST_PAIRS				2													// pairs 0, 1 of regAdcValue_t
+#define ADC_SLOW_PAIRS				(ADC_PAIRS_NUM - ADC_FAST_PAIRS)
+#define ADC_SLOW_DIV_LOG2			2
+
+/*  1 - the regular sequence is one slow pair, the next one of the rotation each start, a single
+    DMA slot; every slow channel is sampled once per 2^ADC_SLOW_ROUND_LOG2 periods (ADC_INJECTED_FAST) */
+#ifndef ADC_SLOW_ROUND_ROBIN
+#define ADC_SLOW_ROUND_ROBIN	1
+#endif
+#define ADC_SLOW_ROUND_LOG2		(ADC_SLOW_DIV_LOG2 + 2)					// PWM periods of one rotation of the ADC_SLOW_PAIRS
+#if ADC_SLOW_ROUND_ROBIN
+#define ADC_SLOW_SLOTS				1													// DMA words of the regular sequence
+#else
+#define ADC_SLOW_SLOTS				ADC_SLOW_PAIRS
+#endif
+
+#pragma anon_unions
 typedef
-	__packed struct{
-		uint16_t iInSensor;
-		uint16_t vInSensor;
-		uint16_t iOutSensor;
-		uint16_t vOutSensor;
-		uint16_t vrefCpu;
-		uint16_t v12Sensor;
-		uint16_t tmpCmp;
-		uint16_t iOutComSensor;
-		uint16_t vLeakRef;
-		uint16_t vLeakCheck;
-		uint16_t tmpCase;
-		uint16_t vRefInt;
+	union{
+		struct{
+			uint16_t iInSensor;
+			uint16_t vInSensor;
+			uint16_t iOutSensor;
+			uint16_t vOutSensor;
+			uint16_t vrefCpu;
+			uint16_t v12Sensor;
+			uint16_t tmpCmp;
+			uint16_t iOutComSensor;
+			uint16_t vLeakRef;
+			uint16_t vLeakCheck;
+			uint16_t tmpCase;
+			uint16_t vRefInt;
+		};
+		uint32_t pair[ADC_PAIRS_NUM];																				// DMA words: ADC1 low half, ADC2 high half
 } regAdcValue_t;
 
 typedef
-	__packed struct{
+	struct{
 		uint32_t iInSensor;
 		uint32_t vInSensor;
 		uint32_t iOutSensor;
@@ -115,8 +149,50 @@ typedef
 		float vRefInt;
 } floatValue_t;
 
+typedef
+	struct{
+		int32_t iInSensor;
+		int32_t vInSensor;
+		int32_t iOutSensor;
+		int32_t vOutSensor;
+		int32_t vrefCpu;
+		int32_t v12Sensor;
+		int32_t tmpCmp;
+		int32_t iOutComSensor;
+		int32_t vLeakRef;
+		int32_t vLeakCheck;
+		int32_t tmpCase;
+		int32_t vRefInt;
+} fixedValue_t;																										// Q16 volts / amperes
+
 #define ADC_STRUCT_MEMBERS_NUM	(sizeof(regAdcValue_t) / sizeof(int16_t))
 
+typedef
+	struct{
+		uint16_t vrefCpu;
+		uint16_t v12Sensor;
+		uint16_t tmpCmp;
+		uint16_t iOutComSensor;
+		uint16_t vLeakRef;
+		uint16_t vLeakCheck;
+		uint16_t tmpCase;
+		uint16_t vRefInt;
+} slowAdcValue_t;																									// average codes of the slow channels, slow decimator rate
+
+typedef
+	struct{
+		uint8_t hi;																											// 8 MSBs of the code, trips above
+		uint8_t lo;																											// trips below, 0 - no low limit
+} adcWindow_t;
+
+typedef
+	struct{
+		adcWindow_t iIn;																								// ADC1 AWD2
+		adcWindow_t iOut;																								// ADC1 AWD3
+		adcWindow_t vIn;																								// ADC2 AWD2
+		adcWindow_t vOut;																								// ADC2 AWD3
+} adcWatchdogs_t;
+
 
 /** function prototype declarations **/
 extern void initAdcToDualRegularSimultaneousMode(void);
@@ -126,5 +202,7 @@ extern void updateSumValue(uint16_t* pMomentVal, uint32_t* pSumValue);
 extern void updateAverageValue(float* pAverageValue, uint32_t* pSumValue);
 extern void updateCalcValue(floatValue_t* pAverageValue,  floatValue_t* pCalcValue);
 extern void setAdcMasterAnalogWatchdogThresholds(uint16_t hiThr, uint16_t loThr);
+extern void setAdcWindowWatchdogs(const adcWatchdogs_t* pWd);
+extern void adcSlowStart(uint8_t pair);																// regular sequence of the slow pair 0..ADC_SLOW_PAIRS-1
 
 #endif /* CODE_INC_ADC_H_ */
@@ -0,0 +1,47 @@
+/*
+ * autotune.h
+ *
+ *  Created on: 17 OCT. 2026
+ *  Relay feedback experiment on the Vin loop, PI gains from the limit cycle
+ */
+
+#ifndef CODE_INC_AUTOTUNE_H_
+#define CODE_INC_AUTOTUNE_H_
+
+#include "stm32f3xx.h"
+
+#define AUTOTUNE_SETTLE_CYCLES	2																// limit cycles before the measurement
+#define AUTOTUNE_CYCLES_LOG2		3
+#define AUTOTUNE_CYCLES					(1U << AUTOTUNE_CYCLES_LOG2)						// limit cycles averaged
+#define AUTOTUNE_MAX_PERIODS		40000U																// ~2 s at 20 kHz, no limit cycle - fail
+
+/*  Tyreus-Luyben PI from the ultimate gain and period: the input capacitor makes the Vin plant
+    an integrator, the Ti = 0.8 Tu of Astrom-Hagglund left it in a limit cycle of the loops */
+#define AUTOTUNE_KP_KU					0.3125f
+#define AUTOTUNE_TI_TU					2.2f
+
+typedef
+	enum {
+		AUTOTUNE_IDLE = 0,
+		AUTOTUNE_RUNNING,
+		AUTOTUNE_MEASURED,																							// limit cycle measured, gains not computed yet
+		AUTOTUNE_DONE,																									// gains computed
+		AUTOTUNE_FAIL,																									// no limit cycle or its amplitude within the hysteresis
+		AUTOTUNE_LIMIT,																									// stopped by the output voltage / current limit
+		AUTOTUNE_ABORT																									// stopped by the DC/DC stop
+	} autoTuneState_ent;
+
+extern volatile uint8_t autoTuneState;																		// autoTuneState_ent
+
+/* PWM interrupt */
+static __inline uint8_t autoTuneActive(void){
+	return autoTuneState == AUTOTUNE_RUNNING;
+}
+extern int32_t autoTuneStep(int32_t vInErrorQ);													// Q16 Vin - target in, Q31 regulator output for the next period
+extern void autoTuneStop(autoTuneState_ent state);
+
+/* thread */
+extern void autoTuneStart(int32_t outQ31, int32_t relayQ31, int32_t hystQ);
+extern int autoTuneGains(uint8_t errorShift, float* pKp, float* pKi);		// per unit gains of a loop with the error base 2^errorShift V
+
+#endif /* CODE_INC_AUTOTUNE_H_ */
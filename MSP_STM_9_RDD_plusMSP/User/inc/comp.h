@@ -0,0 +1,21 @@
+/*
+ * comp.h
+ *
+ *  Created on: 17 OCT. 2026
+ *  Cycle-by-cycle output current limit: COMP2 against a DAC2 threshold
+ */
+
+#ifndef CODE_INC_COMP_H_
+#define CODE_INC_COMP_H_
+
+#include "stm32f3xx.h"
+
+#define COMP_DAC_MAX					4095U
+
+/** function prototype declarations **/
+extern void initCurrLimitComparator(uint16_t dacCode);
+extern void setCurrLimitCode(uint16_t dacCode);
+extern void initSlopeCompensation(void);
+extern void slopeRampStart(const uint16_t* pRamp, uint16_t steps);
+
+#endif /* CODE_INC_COMP_H_ */
@@ -3,15 +3,134 @@
 #include <stdint.h>
 #include "adc.h"
 
+/* averaging and scaling arithmetic: 1 - integer Q16, 0 - float, the host benchmark builds both */
+#ifndef DCDC_FIXED_POINT
+#define DCDC_FIXED_POINT		1
+#endif
+
+/* Vin regulator: DCDC_REG_STEP - +/-10 counts per period, DCDC_REG_PI - CMSIS-DSP arm_pid_q31 */
+#define DCDC_REG_STEP				0
+#define DCDC_REG_PI					1
+#define DCDC_REGULATOR			DCDC_REG_PI
+
+/* 1 - the ideal buck duty Vout/Vin of the last sample is fed forward, the regulator adds its correction */
+#ifndef DCDC_FEED_FORWARD
+#define DCDC_FEED_FORWARD		1
+#endif
+
+/* 1 - DCDC_startIvTrace sweeps the duty for the PV I-V curve, ivtrace.h */
+#define DCDC_IV_TRACE				1
+
+/* 1 - DCDC_startAutoTune runs a relay experiment on the Vin loop and sets its PI gains, autotune.h */
+#define DCDC_AUTOTUNE				1
+/* relay step, duty ratio (current ratio with HRTIM_PEAK_CURRENT, DCDC_DEADBEAT): the battery holds Vout, a duty
+   step h moves the inductor current by h * Vin / (rL + rBat), about 10 A here, 0.02 ran into the Iout limit */
+#define DCDC_AUTOTUNE_RELAY	0.005f
+#define DCDC_AUTOTUNE_HYST	0.5f																// V, relay hysteresis on the Vin error, above the noise
+
+/* 1 - DCDC_startFra measures the Vin loop frequency response by a sine injection, fra.h */
+#define DCDC_FRA						1
+#define DCDC_FRA_AMPLITUDE	0.005f															// injection, duty ratio (current ratio with HRTIM_PEAK_CURRENT, DCDC_DEADBEAT)
+
+/* 1 - HRTIM burst mode (pulse skipping) below DCDC_BURST_ENTER_IOUT, back above DCDC_BURST_EXIT_IOUT */
+#define DCDC_LIGHT_LOAD			1
+#define DCDC_BURST_ENTER_IOUT	1.0f																// A, filtered work cycle average
+#define DCDC_BURST_EXIT_IOUT	2.0f																// A
+#define DCDC_BURST_FILTER_LOG2	4																	// the thresholds see the current over 2^n work cycles
+
+/* 1 - dead time tuned for the best efficiency per load bin, deadtime.h */
+#define DCDC_DEAD_TIME_ESC	1
+
+/* sample sets in a row out of an AWD2 / AWD3 window before the fault: a single noisy conversion
+   doesn't stop the PWM, the AWD1 peak current trips at once */
+#define DCDC_AWD_PERSIST		3
+
+/* A, cycle-by-cycle limit of COMP2 / DAC2 (HRTIM_CURR_LIMIT_EEV), below the FAULT_CURR_CODE shutdown */
+#define DCDC_CYCLE_CURR_LIMIT	85.0f
+
+/* A/us, slope compensation ramp of the peak current mode (HRTIM_PEAK_CURRENT), >= Vout / 2L:
+   0.5 for the 150 V output limit with a 150 uH inductor. The ramp and the peak share the
+   DCDC_CYCLE_CURR_LIMIT range of DAC2, 0.5 A/us takes 14 A of it at DUTY_MAX. Not for the
+   15 uH of DCDC_DEADBEAT_L: its ripple of ~200 A p-p is above the limit, and Vout / 2L would be 5 A/us */
+#define DCDC_PCMC_SLOPE			0.5f
+
+/* 1 - the PI loops give the inductor current reference, the duty is the deadbeat prediction of the buck model, deadbeat.h */
+#ifndef DCDC_DEADBEAT
+#define DCDC_DEADBEAT				0
+#endif
+#define DCDC_DEADBEAT_L			15.0e-6f														// H, until DCDC_setPlantModel
+#define DCDC_DEADBEAT_C			1000.0e-6f													// F, output capacitor
+
+/* analog watchdog that stopped the PWM, latched until the next start */
+typedef enum{
+	DCDC_FAULT_NONE,
+	DCDC_FAULT_IOUT_PEAK,																						// ADC1 AWD1, FAULT_CURR_CODE
+	DCDC_FAULT_IOUT,																								// ADC1 AWD3
+	DCDC_FAULT_IIN,																									// ADC1 AWD2, above the limit or reverse current
+	DCDC_FAULT_VIN,																									// ADC2 AWD2
+	DCDC_FAULT_VOUT																									// ADC2 AWD3
+} dcdcFault_ent;
+
+/* PI loops, the lowest duty of them is applied (min-select) */
+typedef enum{
+	DCDC_LOOP_VIN,																					// input voltage, MPPT setpoint
+	DCDC_LOOP_IOUT,																					// output current limit
+	DCDC_LOOP_VOUT,																					// output voltage limit
+	DCDC_LOOPS_NUM
+} dcdcLoop_ent;
+
+/* PI defaults, per unit: error base 2^SHIFT volts / amperes, output 1.0 = full period */
+#define DCDC_PID_VIN_SHIFT	5
+#define DCDC_PID_KP					0.05f
+#define DCDC_PID_KI					0.002f
+#define DCDC_PID_KD					0.0f
+
+#define DCDC_PID_IOUT_SHIFT	6
+#if DCDC_DEADBEAT																								// output 1.0 = DCDC_CYCLE_CURR_LIMIT, reached two periods later
+#define DCDC_PID_IOUT_KP		0.2f
+#define DCDC_PID_IOUT_KI		0.2f
+#else
+#define DCDC_PID_IOUT_KP		0.05f
+#define DCDC_PID_IOUT_KI		0.004f
+#endif
+
+#define DCDC_PID_VOUT_SHIFT	6
+#define DCDC_PID_VOUT_KP		0.05f
+#define DCDC_PID_VOUT_KI		0.002f
 
 extern floatValue_t averageValue;
 extern floatValue_t calculatedValue;
-extern volatile regAdcValue_t momentValue;
+extern regAdcValue_t momentValue;
+#if DCDC_FIXED_POINT
+extern fixedValue_t fixedValue;
+#endif
 
 int setVin(float Vin);
 
 extern int DCDC_Start_Stop(uint8_t SS);     //RDD 1-Start; 0-Stop: Not work HRtim
 extern int DCDC_Enable_Disable(uint8_t ED); //RDD 1-Enable: DCDC work in stop mode; 0-Disable :  Not control DCDC, not regulator, but adc work
+extern int DCDC_setPidGains(uint8_t loop, float kp, float ki, float kd);	// per unit gains, |k| < 1, applied at the next PWM period
+extern int DCDC_setVoutLimit(float vOut);									// V, output voltage limit loop
+extern int DCDC_setIoutLimit(float iOut);									// A, output current limit loop
+extern uint8_t DCDC_getActiveLoop(void);									// dcdcLoop_ent of the last PWM period
+extern int DCDC_setPhaseTrim(uint8_t phase, float duty);					// duty ratio added to one phase, |duty| <= 0.02
+extern int DCDC_setBurstThresholds(float iEnter, float iExit);			// A, iExit > iEnter
+extern uint8_t DCDC_isBurstMode(void);
+extern int DCDC_setCycleCurrLimit(float amps);										// A, the DAC threshold of the comparator, -1 with no HRTIM_CURR_LIMIT_EEV / DCDC_DEADBEAT
+extern int DCDC_setSlopeComp(float ampsPerUs);												// A/us, peak current mode only
+extern int DCDC_setPlantModel(float inductance, float capacitance);					// H, F, DCDC_DEADBEAT only
+extern uint32_t DCDC_getCurrLimitEvents(void);											// PWM periods cut short by the current limit
+extern float DCDC_getEfficiency(void);														// Pout / Pin, filtered, 0 until the dead time loop has run
+extern int DCDC_setProtectLimits(float vInMax, float vOutMax, float iInMin, float iInMax, float iOutMax);	// V, A, AWD2 / AWD3 windows
+extern uint8_t DCDC_getFault(void);																			// dcdcFault_ent
+extern int DCDC_startIvTrace(void);													// running DC/DC only, the regulator is back after the sweep
+extern int DCDC_startAutoTune(void);												// running DC/DC with the Vin loop in control only
+extern uint8_t DCDC_getAutoTuneState(void);									// autoTuneState_ent
+extern int DCDC_getAutoTuneGains(float* pKp, float* pKi);				// 0 once per experiment, the gains are applied already
+extern int DCDC_startFra(uint16_t freq);												// Hz, 0 - the sweep; running DC/DC with the Vin loop in control only
+extern uint8_t DCDC_getFraState(void);													// fraState_ent
+extern uint16_t DCDC_getFraPointsNum(void);
+extern int DCDC_getFraPoint(uint16_t n, float* pFreq, float* pPlantDb, float* pPlantDeg, float* pLoopDb, float* pLoopDeg);	// Hz, dB, deg of the plant and the loop
 
 extern int	DCDC_Init(void);
 extern int 	DCDC_Loop(char l);
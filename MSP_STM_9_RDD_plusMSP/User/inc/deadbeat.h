@@ -0,0 +1,34 @@
+/*
+ * deadbeat.h
+ *
+ *  Created on: 17 OCT. 2026
+ *  Deadbeat inductor current control: the duty from the buck model
+ */
+
+#ifndef CODE_INC_DEADBEAT_H_
+#define CODE_INC_DEADBEAT_H_
+
+#include "stm32f3xx.h"
+#include "HiResTim.h"
+
+#define DEADBEAT_HRTIM_CLK			(72000000.0f * 16)										// HRTIM counts per second
+#define DEADBEAT_MODEL_MIN			(512.0f / DEADBEAT_HRTIM_CLK)				// H, F: the Q24 coefficients fit 32 bits
+
+/* last sample and the periods around it */
+typedef
+	struct{
+		int32_t vIn;																										// Q16 V
+		int32_t vOut;
+		int32_t iL;																											// Q16 A, the inductor current sample
+		int32_t iLoad;																									// Q16 A, the output current of the work cycle
+		int32_t duty;																										// Q31 duty of the running period
+		uint16_t period;																								// HRTIM counts of the running period
+		uint16_t periodNext;																						// and of the next one
+} deadbeatSample_t;
+
+/** function prototype declarations **/
+extern int deadbeatSetModel(float inductance, float capacitance);			// H, F, >= DEADBEAT_MODEL_MIN
+extern void deadbeatSetScale(float amps);																// A of the reference 1.0
+extern int32_t deadbeatStep(int32_t refQ31, const deadbeatSample_t* pNow);	// PWM interrupt, Q31 duty of the next period, not limited
+
+#endif /* CODE_INC_DEADBEAT_H_ */
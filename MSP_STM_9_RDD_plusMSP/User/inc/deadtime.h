@@ -0,0 +1,37 @@
+/*
+ * deadtime.h
+ *
+ *  Created on: 17 OCT. 2026
+ *  Dead time of the buck legs tuned for the best efficiency by extremum seeking
+ */
+
+#ifndef CODE_INC_DEADTIME_H_
+#define CODE_INC_DEADTIME_H_
+
+#include "stm32f3xx.h"
+#include "HiResTim.h"
+
+#define DT_MIN								40																// Tdtg counts, 278 ns, shoot-through margin of the switches
+#define DT_MAX								96																// 667 ns
+#define DT_DITHER							4																	// +/- around the centre while seeking
+#define DT_STEP								2																	// centre step per dither cycle
+#define DT_SETTLE							50																// work cycles skipped after each change, 40 ms
+#define DT_DWELL							250																// work cycles averaged per dither half, 200 ms
+#define DT_GRAD_MIN						0.0005f														// efficiency difference taken as a gradient
+#define DT_PIN_MIN						300.0f														// W, no seeking below
+#define DT_BINS								8																	// load bins of the learned dead time
+#define DT_BIN_WIDTH					10.0f															// A of output current per bin
+#define DT_BIN_HYST						2.0f															// A past the edges of the bin before the next one takes over
+#define DT_EFF_ALPHA					(1.0f / 64)												// efficiency estimate filter, per work cycle
+
+typedef char dtBoundsCheck_t[(DT_MAX <= 0x1FF) && (DT_MIN + DT_DITHER + DT_STEP <= DT_MAX - DT_DITHER) &&
+														 (DT_MIN + DT_DITHER <= DEAD_TIME_INIT) && (DEAD_TIME_INIT <= DT_MAX - DT_DITHER) ? 1 : -1];		// the dither of any centre inside DT_MIN..DT_MAX
+
+/** function prototype declarations **/
+extern void deadTimeInit(void);
+extern void deadTimeUpdate(float pIn, float pOut, float iOut);							// once per work cycle, thread
+extern void deadTimeHold(void);																							// back to the centre of the bin, seeking stops
+extern float deadTimeEfficiency(void);
+extern void deadTimeGet(uint8_t bin, uint16_t* pRise, uint16_t* pFall);
+
+#endif /* CODE_INC_DEADTIME_H_ */
@@ -0,0 +1,48 @@
+/*
+ * decim.h
+ *
+ *  Created on: 17 OCT. 2026
+ *  CIC / boxcar decimator for the dual ADC stream
+ */
+
+#ifndef CODE_INC_DECIM_H_
+#define CODE_INC_DECIM_H_
+
+#include "adc.h"
+
+/*  iIn, vIn, iOut, vOut lead regAdcValue_t, the rest are slow channels */
+#define DECIM_FAST_CHANNELS		4
+#define DECIM_SLOW_CHANNELS		(ADC_STRUCT_MEMBERS_NUM - DECIM_FAST_CHANNELS)
+
+/*  order 1 - boxcar, 2, 3 - CIC; ratio = 2^LOG2R */
+#define DECIM_FAST_ORDER			2
+#define DECIM_FAST_LOG2R			4																					// 20 kHz / 16 = 1.25 kHz
+#define DECIM_SLOW_ORDER			2
+#define DECIM_SLOW_LOG2R			8																					// 20 kHz / 256 = 78 Hz
+#define DECIM_MAX_ORDER				3
+
+/*  packed pre-sum ahead of the integrators, 2^LOG2 samples, two channels per 32 bit add;
+    LOG2 <= 4 keeps 12 bit codes inside 16 bit lanes, LOG2 <= both group LOG2R */
+#define DECIM_PRESUM_LOG2			2
+
+#define DECIM_OUT_FRAC				ADC_OUT_FRAC																// output = code * 2^DECIM_OUT_FRAC
+
+/*  ADC_SLOW_ROUND_ROBIN: the slow group gets one set per rotation from decimSlowUpdate, no
+    pre-sum; DECIM_SLOW_LOG2R is still counted in PWM periods */
+#if ADC_SLOW_ROUND_ROBIN
+#define DECIM_SLOW_PRESUM_LOG2	0
+#define DECIM_SLOW_INPUT_LOG2		ADC_SLOW_ROUND_LOG2													// PWM periods per input set
+#else
+#define DECIM_SLOW_PRESUM_LOG2	DECIM_PRESUM_LOG2
+#define DECIM_SLOW_INPUT_LOG2		0
+#endif
+
+#define DECIM_FAST_READY			0x01
+#define DECIM_SLOW_READY			0x02
+
+/** function prototype declarations **/
+extern void decimInit(void);
+extern uint8_t decimUpdate(const volatile regAdcValue_t* pSample, wordAdcValue_t* pOut);
+extern uint8_t decimSlowUpdate(const volatile uint32_t* pSlowPairs, wordAdcValue_t* pOut);	// ADC_SLOW_ROUND_ROBIN, pairs 2..5
+
+#endif /* CODE_INC_DECIM_H_ */
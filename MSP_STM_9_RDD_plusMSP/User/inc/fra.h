@@ -0,0 +1,63 @@
+/*
+ * fra.h
+ *
+ *  Created on: 17 OCT. 2026
+ *  Frequency response of the Vin loop, sine injection into the regulator output
+ */
+
+#ifndef CODE_INC_FRA_H_
+#define CODE_INC_FRA_H_
+
+#include "stm32f3xx.h"
+#include "HiResTim.h"
+
+#define FRA_SINE_LOG2						8
+#define FRA_SINE_SIZE						(1U << FRA_SINE_LOG2)									// Q15 sine table, one period
+#define FRA_SETTLE_CYCLES				2U																		// injection cycles before the measurement
+#define FRA_CYCLES							8U																		// injection cycles measured, at least
+#define FRA_MIN_PERIODS					2000U																	// PWM periods measured, at least, ~100 ms
+#define FRA_MAX_PERIODS					0xFFFFU																// a point ends here at the latest
+#define FRA_FREQ_MIN						20U																		// Hz, FRA_CYCLES fit in FRA_MAX_PERIODS
+#define FRA_FREQ_MAX						(BUCK_CLK / 4)												// Hz, 4 samples per cycle
+#define FRA_POINTS_MAX					24U																		// sweep list
+
+typedef
+	enum {
+		FRA_IDLE = 0,																										// no response
+		FRA_RUNNING,
+		FRA_DONE,																												// all points of the list
+		FRA_LIMIT,																											// stopped by a limit loop taking over or no whole cycle
+		FRA_ABORT																												// stopped by the DC/DC stop
+	} fraState_ent;
+
+/* correlation sums of one point over whole injection cycles */
+typedef
+	struct{
+		int64_t vInCos;																									// Q16 V * Q15
+		int64_t vInSin;
+		int64_t outCos;																									// Q15 ratio * Q15
+		int64_t outSin;
+		uint32_t periodSum;																							// HRTIM counts of the measured periods
+		uint16_t periods;
+		uint16_t cycles;
+} fraPoint_t;
+
+typedef char fraPeriodsCheck_t[((uint64_t)FRA_MAX_PERIODS * BUCK_PERIOD_MAX <= 0xFFFFFFFFUL) ? 1 : -1];	// periodSum
+typedef char fraFreqCheck_t[((FRA_SETTLE_CYCLES + FRA_CYCLES + 1) * BUCK_CLK / FRA_FREQ_MIN <= FRA_MAX_PERIODS) ? 1 : -1];
+
+extern volatile uint8_t fraState;																					// fraState_ent
+
+/* PWM interrupt */
+static __inline uint8_t fraActive(void){
+	return fraState == FRA_RUNNING;
+}
+extern int32_t fraStep(int32_t vInQ, int32_t outQ31, uint16_t period);	// Q16 Vin, Q31 regulator output in, Q31 output with the injection
+extern void fraStop(fraState_ent state);
+
+/* thread */
+extern void fraInit(void);
+extern void fraStart(const uint16_t* pFreq, uint16_t points, int32_t ampQ31);	// Hz, FRA_FREQ_MIN..FRA_FREQ_MAX
+extern uint16_t fraGetPointsNum(void);
+extern int fraGetPoint(uint16_t n, float* pFreq, float* pPlantDb, float* pPlantDeg, float* pLoopDb, float* pLoopDeg);
+
+#endif /* CODE_INC_FRA_H_ */
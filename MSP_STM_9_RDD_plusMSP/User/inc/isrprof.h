@@ -0,0 +1,70 @@
+/*
+ * isrprof.h
+ *
+ *  Created on: 17 OCT. 2026
+ *  Interrupt execution time from the DWT cycle counter
+ *
+ *  Times are inclusive: a handler preempted by a higher priority one is
+ *  charged with the preemption too.
+ */
+
+#ifndef CODE_INC_ISRPROF_H_
+#define CODE_INC_ISRPROF_H_
+
+#include "stm32f3xx.h"
+
+#define ISR_PROFILE						1																	// 0 - the probes compile to nothing
+#define ISR_PROF_BINS					16																// bin n: 2^n <= cycles < 2^(n+1), the last bin is open
+
+typedef
+	enum {
+		ISR_PROF_HRTIM = 0,
+		ISR_PROF_DMA1_CH1,
+		ISR_PROF_ADC1_2,
+		ISR_PROF_USART1,
+		ISR_PROF_TIM3,
+		ISR_PROF_SYSTICK,
+		ISR_PROF_CTRL_LATENCY,																						// not a handler: ADC trigger to the duty write (ADC_INJECTED_FAST)
+		ISR_PROF_NUM
+	} isrProf_ent;
+
+typedef
+	struct{
+		uint32_t count;
+		uint32_t min;
+		uint32_t max;
+		uint64_t sum;
+		uint16_t bins[ISR_PROF_BINS];																			// saturate at 0xFFFF
+} isrProfStat_t;
+
+extern isrProfStat_t isrProfStat[ISR_PROF_NUM];
+
+#if ISR_PROFILE
+#define ISR_PROF_ENTER()			uint32_t isrProfStart = DWT->CYCCNT
+#define ISR_PROF_EXIT(h)			isrProfRecord((h), DWT->CYCCNT - isrProfStart)
+#else
+#define ISR_PROF_ENTER()
+#define ISR_PROF_EXIT(h)
+#endif
+
+/******************************************************************************************
+*  Is called from the profiled handler only, so every entry has a single writer
+*******************************************************************************************/
+static __inline void isrProfRecord(isrProf_ent handler, uint32_t cycles){
+	isrProfStat_t* pStat = &isrProfStat[handler];
+	uint32_t bin = 31 - __CLZ(cycles | 1U);
+
+	if(bin >= ISR_PROF_BINS) { bin = ISR_PROF_BINS - 1; }
+	if(pStat->bins[bin] != 0xFFFF) { pStat->bins[bin]++; }
+	if(cycles < pStat->min) { pStat->min = cycles; }
+	if(cycles > pStat->max) { pStat->max = cycles; }
+	pStat->count++;
+	pStat->sum += cycles;
+}
+
+/** function prototype declarations **/
+extern void isrProfInit(void);
+extern void isrProfReset(void);
+extern void isrProfGet(isrProf_ent handler, isrProfStat_t* pStat);
+
+#endif /* CODE_INC_ISRPROF_H_ */
@@ -0,0 +1,51 @@
+/*
+ * ivtrace.h
+ *
+ *  Created on: 17 OCT. 2026
+ *  PV I-V curve trace by a duty sweep DUTY_MAX..DUTY_MIN
+ */
+
+#ifndef CODE_INC_IVTRACE_H_
+#define CODE_INC_IVTRACE_H_
+
+#include "stm32f3xx.h"
+#include "HiResTim.h"
+
+#define IVTRACE_POINTS_LOG2		8
+#define IVTRACE_POINTS				(1U << IVTRACE_POINTS_LOG2)								// 256 points of the curve
+#define IVTRACE_AVERAGE_LOG2	4																	// PWM periods per point
+#define IVTRACE_PERIODS				(IVTRACE_POINTS << IVTRACE_AVERAGE_LOG2)	// 4096 periods, ~205 ms at 20 kHz
+#define IVTRACE_OPEN_CODES		4																	// Iin codes above ZERO_CURR_CODE, the end at open circuit
+
+typedef
+	enum {
+		IVTRACE_IDLE = 0,																								// no curve
+		IVTRACE_RUNNING,
+		IVTRACE_DONE,																										// swept to the open circuit
+		IVTRACE_LIMIT,																									// stopped by the output voltage / current limit
+		IVTRACE_ABORT																										// stopped by the DC/DC stop
+	} ivTraceState_ent;
+
+typedef
+	struct{
+		uint16_t vInSum;																								// sum of 2^IVTRACE_AVERAGE_LOG2 ADC codes
+		uint16_t iInSum;
+} ivTracePoint_t;
+
+typedef char ivTraceSumCheck_t[((4095U << IVTRACE_AVERAGE_LOG2) <= 0xFFFF) ? 1 : -1];
+
+extern volatile uint8_t ivTraceState;																				// ivTraceState_ent
+
+/* PWM interrupt */
+static __inline uint8_t ivTraceActive(void){
+	return ivTraceState == IVTRACE_RUNNING;
+}
+extern uint16_t ivTraceStep(uint16_t vInCode, uint16_t iInCode);					// duty for the next period, counts of BUCK_PERIOD
+extern void ivTraceStop(ivTraceState_ent state);
+
+/* thread */
+extern void ivTraceStart(uint32_t vScale, uint32_t iScale, uint16_t dutyNow);	// dutyNow - counts, the start of the approach
+extern uint16_t ivTraceGetPointsNum(void);
+extern int ivTraceGetPoint(uint16_t n, float* pVin, float* pIin);
+
+#endif /* CODE_INC_IVTRACE_H_ */
@@ -0,0 +1,21 @@
+/*
+ * pcmc.h
+ *
+ *  Created on: 17 OCT. 2026
+ *  Peak current mode: current reference with slope compensation on DAC2
+ */
+
+#ifndef CODE_INC_PCMC_H_
+#define CODE_INC_PCMC_H_
+
+#include "stm32f3xx.h"
+#include "HiResTim.h"
+
+#define PCMC_STEP_US					(PCMC_RAMP_STEP * 1.0e6f / (72000000.0f * 16))		// one ramp step, us
+
+/** function prototype declarations **/
+extern void pcmcInit(uint16_t limitCode);
+extern void pcmcSetScale(uint16_t limitCode, uint16_t slopeCodes);				// DAC codes of the reference 1.0 and of one ramp step
+extern void pcmcPeriod(int32_t refQ31);																		// PWM interrupt, reference 0..1.0 of the limit
+
+#endif /* CODE_INC_PCMC_H_ */
@@ -0,0 +1,22 @@
+/*
+ * phase.h
+ *
+ *  Created on: 17 OCT. 2026
+ *  Duty trim and current balancing of the interleaved buck phases
+ */
+
+#ifndef CODE_INC_PHASE_H_
+#define CODE_INC_PHASE_H_
+
+#include "stm32f3xx.h"
+#include "HiResTim.h"
+
+#define PHASE_BALANCE_KI			2																	// counts of duty per ampere of unbalance per work cycle
+#define PHASE_BALANCE_MIN_Q		(1L << 16)												// Q16, no balancing below 1 A mean phase current
+
+/** function prototype declarations **/
+extern void phaseInit(void);
+extern int phaseSetTrim(uint8_t phase, int16_t counts);
+extern void phaseBalance(const int32_t* pCurr);															// Q16 phase currents of the work cycle
+
+#endif /* CODE_INC_PHASE_H_ */
@@ -0,0 +1,27 @@
+/*
+ * protect.h
+ *
+ *  Created on: 17 OCT. 2026
+ *  Window limits of the ADC analog watchdogs AWD2 / AWD3
+ */
+
+#ifndef CODE_INC_PROTECT_H_
+#define CODE_INC_PROTECT_H_
+
+#include "stm32f3xx.h"
+#include "adc.h"
+
+typedef
+	struct{
+		float vInMax;																										// V
+		float vOutMax;																									// V
+		float iInMin;																										// A, negative: reverse PV current
+		float iInMax;																										// A
+		float iOutMax;																									// A
+} protectLimits_t;
+
+/** function prototype declarations **/
+extern void protectThresholds(const protectLimits_t* pLim, float vInPerCode, float vOutPerCode, float ampsPerCode,
+															adcWatchdogs_t* pWd);
+
+#endif /* CODE_INC_PROTECT_H_ */
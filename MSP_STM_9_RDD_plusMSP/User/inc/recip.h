@@ -0,0 +1,37 @@
+/*
+ * recip.h
+ *
+ *  Created on: 17 OCT. 2026
+ *  Table reciprocal for divisions in the PWM interrupt
+ */
+
+#ifndef CODE_INC_RECIP_H_
+#define CODE_INC_RECIP_H_
+
+#include "stm32f3xx.h"
+
+#define RECIP_TABLE_BITS			8
+#define RECIP_TABLE_SIZE			((1U << RECIP_TABLE_BITS) + 1)
+
+extern const uint32_t recipTable[RECIP_TABLE_SIZE];												// 2^31 / (1 + i / 256)
+
+/******************************************************************************************
+*  num / den in Q31, saturated to 0x7FFFFFFF, no divide instruction.
+*  den is normalised with CLZ, 1/mantissa is interpolated from the table (error < 2e-5 of full scale).
+*******************************************************************************************/
+static __inline int32_t recipRatioQ31(uint32_t num, uint32_t den){
+	uint32_t n, m, i, f, t;
+	uint64_t q;
+
+	if(num >= den) { return 0x7FFFFFFF; }																		// den == 0 too
+	n = __CLZ(den);
+	m = den << n;																															// 1.0 <= m / 2^31 < 2.0
+	i = (m >> (31 - RECIP_TABLE_BITS)) & ((1U << RECIP_TABLE_BITS) - 1);
+	f = (m >> (23 - RECIP_TABLE_BITS)) & 0xFF;
+	t = recipTable[i] - (((recipTable[i] - recipTable[i + 1]) * f) >> 8);
+	q = ((uint64_t)num * t) >> (31 - n);
+
+	return (q > 0x7FFFFFFF) ? 0x7FFFFFFF : (int32_t)q;
+}
+
+#endif /* CODE_INC_RECIP_H_ */
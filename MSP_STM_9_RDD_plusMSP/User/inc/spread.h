@@ -0,0 +1,34 @@
+/*
+ * spread.h
+ *
+ *  Created on: 17 OCT. 2026
+ *  Spread spectrum of the buck PWM period
+ */
+
+#ifndef CODE_INC_SPREAD_H_
+#define CODE_INC_SPREAD_H_
+
+#include "stm32f3xx.h"
+#include "HiResTim.h"
+
+#define SPREAD_STEPS_NUM			((BUCK_PERIOD_MAX - BUCK_PERIOD_MIN) / PERIOD_STEP + 1)		// 60 periods
+#define SPREAD_INDEX(p)				(((p) - BUCK_PERIOD_MIN) / PERIOD_STEP)
+#define SPREAD_INDEX_NOMINAL	SPREAD_INDEX(BUCK_PERIOD)
+#define SPREAD_LFSR_TAPS			0xB400U																				// x^16 + x^14 + x^13 + x^11 + 1
+#define SPREAD_PROFILE				SPREAD_TRIANGLE																// profile after reset
+
+typedef
+	enum {
+		SPREAD_OFF = 0,																															// fixed BUCK_PERIOD
+		SPREAD_TRIANGLE,																														// BUCK_PERIOD_MAX -> MIN -> MAX by PERIOD_STEP
+		SPREAD_LFSR,																																// pseudo random period every cycle
+		SPREAD_CUSTOM																																// user table of period indexes
+	} spreadProfile_ent;
+
+/** function prototype declarations **/
+extern void spreadInit(void);
+extern int spreadSetProfile(spreadProfile_ent profile, const uint8_t* pIndex, uint16_t length);
+extern uint16_t spreadNextPeriod(void);
+extern uint16_t spreadScaleDuty(uint16_t dutyRef);
+
+#endif /* CODE_INC_SPREAD_H_ */
@@ -6,13 +6,67 @@
  */
 
 #include "HiResTim.h"
+#include "adc.h"
 
+#define PHASE_OUT_BITS				((1UL << (2 * HRTIM_PHASES)) - 1)									// Tx1 Tx2 of the phases in OENR / ODISR
+#define PHASE_CEN_BITS				(((1UL << HRTIM_PHASES) - 1) << HRTIM_MCR_TACEN_Pos)
+#define PHASE_SWU_BITS				(((1UL << HRTIM_PHASES) - 1) << HRTIM_CR2_TASWU_Pos)
+#define RSTER_TIMACMP4				(1UL << 21)																					// Timer E reset on Timer A compare 4
+
+int16_t hrtimPhaseTrim[HRTIM_PHASES];																				// counts added to the duty of each phase
+
+#if HRTIM_PHASES > 1
+static const uint32_t phaseReset[4] = { HRTIM_RSTR_MSTPER, HRTIM_RSTR_MSTCMP1, HRTIM_RSTR_MSTCMP2, HRTIM_RSTR_MSTCMP3 };
+#endif
+
+/******************************************************************************************
+*  One buck phase: Tx1 high side, Tx2 low side with dead time
+*  Several phases: the master timer resets phase k at k/HRTIM_PHASES of its period
+*******************************************************************************************/
+static void phaseTimerInit(hrTim_ent tim){
+
+	HRTIM1->sTimerxRegs[tim].TIMxCR = HRTIM_TIMCR_CONT |											// timer operates in continuous mode and rolls over to zero when it reaches TIMxPER value
+																		HRTIM_TIMCR_PREEN |											// preload enabled
+																		//HRTIM_TIMCR_TREPU |										// update on repetition enabled
+	                                  HRTIM_TIMCR_TRSTU |            		// update is triggered by Timerx counter reset or roll-over to 0 after reaching the period value  
+																		HRTIM_TIMCR_CK_PSC_1;										// Fhrck equivalent frequency (144 x 8)MHz = 1.152 GHz
+
+#if HRTIM_PHASES > 1
+	HRTIM1->sTimerxRegs[tim].PERxR = PHASE_SLAVE_PERIOD;											// not reached, the master timer resets the phase first
+	HRTIM1->sTimerxRegs[tim].RSTxR = phaseReset[tim];
+	HRTIM1->sTimerxRegs[tim].SETx1R = HRTIM_SET1R_RESYNC;										// out Tx1 set on the reset from the master timer
+#else
+	HRTIM1->sTimerxRegs[tim].PERxR = (uint16_t)BUCK_PERIOD;										// period for timer
+	HRTIM1->sTimerxRegs[tim].SETx1R = HRTIM_SET1R_PER;												// out TA1 set on PER
+#endif
+	HRTIM1->sTimerxRegs[tim].CMP1xR = DUTY_MIN;																// CMP1 event for duty cycle regulation
+#if HRTIM_CURR_LIMIT_EEV
+	HRTIM1->sTimerxRegs[tim].CMP3xR = CURR_LIMIT_BLANK;												// end of the current limit blanking
+	HRTIM1->sTimerxRegs[tim].EEFxR1 = HRTIM_EEFR1_EE1FLTR_1 | HRTIM_EEFR1_EE1FLTR_0;	// EEV1 blanked from the period start to CMP3
+	HRTIM1->sTimerxRegs[tim].RSTx1R = HRTIM_RST1R_CMP1 | HRTIM_RST1R_EXTVNT1;		// out Tx1 reset on CMP1 or on the current limit
+#else
+	HRTIM1->sTimerxRegs[tim].RSTx1R = HRTIM_RST1R_CMP1;												// out Tx1 reset on CMP1
+#endif
+
+	HRTIM1->sTimerxRegs[tim].OUTxR &= ~( HRTIM_OUTR_POL1 |										// output 1 active polarity is high
+																			 HRTIM_OUTR_POL2 |										// output 2 active polarity is high
+																			 HRTIM_OUTR_IDLES1 |									// output 1 idle state inactive
+																			 HRTIM_OUTR_IDLES2 );									// output 2 idle state inactive
+
+	HRTIM1->sTimerxRegs[tim].OUTxR |= HRTIM_OUTR_DTEN |												// dead time enable
+																		HRTIM_OUTR_IDLM1 | HRTIM_OUTR_IDLM2;		// outputs go idle during the burst mode idle time
+
+	HRTIM1->sTimerxRegs[tim].DTxR |= (HRTIM_DTR_DTPRSC_1 | HRTIM_DTR_DTPRSC_0) | 	// select Tdtg = 6.944 ns
+																	 (HRTIM_DTR_DTR_6 | HRTIM_DTR_DTF_6) |		 		// Dead time falling and rising  = DEAD_TIME_INIT * Tdtg = 444 ns
+																	 (HRTIM_DTR_DTFSLK | HRTIM_DTR_DTRSLK);
+}
 
 /******************************************************************************************
 *
 *
 *******************************************************************************************/
 void initHighResolutionTimer(void){
+	uint16_t k;
 
 	RCC->CFGR3 |= RCC_CFGR3_HRTIM1SW_PLL;																			// use the PLLx2 clock for HRTIM
 	RCC->APB2ENR |= RCC_APB2ENR_HRTIM1EN;																			// enable HRTIM clock
@@ -20,43 +74,71 @@ void initHighResolutionTimer(void){
 	HRTIM1->sCommonRegs.DLLCR |= HRTIM_AUTOCLBR_14us | HRTIM_DLLCR_CALEN;			// periodic calibration enabled, with the lowest calibration period (2048 x tHRTIM)
 	while ((HRTIM1->sCommonRegs.ISR & HRTIM_ISR_DLLRDY) == 0);
 
-	HRTIM1->sTimerxRegs[TIM_A].TIMxCR = HRTIM_TIMCR_CONT |										// timer operates in continuous mode and rolls over to zero when it reaches TIMxPER value
-																			HRTIM_TIMCR_PREEN |										// preload enabled
-																			//HRTIM_TIMCR_TREPU |										// update on repetition enabled
-	                                    HRTIM_TIMCR_TRSTU |            // update is triggered by Timerx counter reset or roll-over to 0 after reaching the period value  
-																			HRTIM_TIMCR_CK_PSC_1;									// Fhrck equivalent frequency (144 x 8)MHz = 1.152 GHz
+	for(k = 0; k < HRTIM_PHASES; k++){
+		phaseTimerInit((hrTim_ent)(TIM_A + k));
+		hrtimPhaseTrim[k] = 0;
+	}
 	
 	HRTIM1->sTimerxRegs[TIM_A].REPxR = 0;
+#if ADC_INJECTED_FAST
+	HRTIM1->sTimerxRegs[TIM_A].TIMxDIER = 0;																	// the control runs at the ADC JEOS
+#else
 	HRTIM1->sTimerxRegs[TIM_A].TIMxDIER = HRTIM_TIMDIER_REPIE;								// enable REP interrupts
+#endif
 //	HRTIM1->sTimerxRegs[TIM_A].TIMxDIER = HRTIM_TIMDIER_RSTIE;                // enable Reset/roll-over Interrupt Enable interrupts   
 
-
-	HRTIM1->sTimerxRegs[TIM_A].PERxR = (uint16_t)BUCK_PERIOD;									// period for timer
-	HRTIM1->sTimerxRegs[TIM_A].CMP1xR = DUTY_MIN;															// CMP1 event for duty cycle regulation
-	
-	HRTIM1->sTimerxRegs[TIM_A].SETx1R = HRTIM_SET1R_PER;											// out TA1 set on PER
-	HRTIM1->sTimerxRegs[TIM_A].RSTx1R = HRTIM_RST1R_CMP1;											// out TA1 reset on CMP1
-
 	HRTIM1->sTimerxRegs[TIM_A].CMP2xR = ADC_TRG;															// RDD Duty CMP2-> event for ADC trigger
 	HRTIM1->sCommonRegs.CR1 = HRTIM_CR1_ADC1USRC_0; 													// ADC trigger update: Timer A 
 	HRTIM1->sCommonRegs.ADC1R = HRTIM_ADC1R_AD1TAC2; 													// ADC trigger event: Timer A compare 2
+#if ADC_INJECTED_FAST
+	HRTIM1->sCommonRegs.CR1 |= HRTIM_CR1_ADC2USRC_0;													// the same event on ADC trigger 2, the injected sequence
+	HRTIM1->sCommonRegs.ADC2R = HRTIM_ADC2R_AD2TAC2;
+#endif
 
-	HRTIM1->sTimerxRegs[TIM_A].OUTxR &= ~( HRTIM_OUTR_POL1 |									// output 1 active polarity is high
-																				 HRTIM_OUTR_POL2 |									// output 2 active polarity is high
-																				 HRTIM_OUTR_IDLES1 |								// output 1 idle state inactive
-																				 HRTIM_OUTR_IDLES2 );								// output 2 idle state inactive
+#if HRTIM_CURR_LIMIT_EEV
+	HRTIM1->sCommonRegs.EECR1 = HRTIM_EECR1_EE1SRC_0;													// EEV1 from COMP2, active high, level sensitive, filtered
+	HRTIM1->sTimerxRegs[TIM_A].CPT1xCR = HRTIM_CPT1CR_EXEV1CPT;								// CPT1 flag: the limit acted in this period
+#endif
 
-	HRTIM1->sTimerxRegs[TIM_A].OUTxR |= HRTIM_OUTR_DTEN;											// dead time enable
+#if HRTIM_PEAK_CURRENT
+	HRTIM1->sTimerxRegs[TIM_A].CMP4xR = CURR_LIMIT_BLANK;											// the slope compensation ramp starts with the end of the blanking
+	HRTIM1->sTimerxRegs[TIM_E].TIMxCR = HRTIM_TIMCR_CONT | HRTIM_TIMCR_CK_PSC_1;		// ramp clock, no outputs
+	HRTIM1->sTimerxRegs[TIM_E].PERxR = PCMC_RAMP_STEP;
+	HRTIM1->sTimerxRegs[TIM_E].RSTxR = RSTER_TIMACMP4;												// in step with Timer A
+	HRTIM1->sTimerxRegs[TIM_E].REPxR = 0;
+	HRTIM1->sTimerxRegs[TIM_E].TIMxDIER = HRTIM_TIMDIER_REPDE;								// DMA request every step, comp.c
+#endif
 
-	HRTIM1->sTimerxRegs[TIM_A].DTxR |= (HRTIM_DTR_DTPRSC_1 | HRTIM_DTR_DTPRSC_0) | 	// select Tdtg = 6.944 ns
-																		 (HRTIM_DTR_DTR_6 | HRTIM_DTR_DTF_6) |		 		// Dead time falling and rising  = 16 * Tdtg = 111.1 ns
-																		 (HRTIM_DTR_DTFSLK | HRTIM_DTR_DTRSLK);
+#if HRTIM_PHASES > 1
+	HRTIM1->sMasterRegs.MCR = HRTIM_MCR_CONT |																// master timer sets the period and the phase shifts
+														HRTIM_MCR_PREEN |
+														HRTIM_MCR_MREPU |																// update on every period
+														HRTIM_MCR_CK_PSC_1;															// same clock as the phases
+	HRTIM1->sMasterRegs.MREP = 0;
+	hrtimerUpdatePeriod(BUCK_PERIOD);
+#endif
 
-	HRTIM1->sCommonRegs.ODISR = HRTIM_ODISR_TA1ODIS | HRTIM_ODISR_TA2ODIS;		// TA1 TA2 outputs disable
+	HRTIM1->sCommonRegs.ODISR = PHASE_OUT_BITS;																// Tx1 Tx2 outputs disable
 	
+	HRTIM1->sCommonRegs.BMCR = HRTIM_BMCR_BMCLK_0 |														// burst mode clock: Timer A reset / roll-over
+														 HRTIM_BMCR_BMOM |															// continuous, until hrtimersBurstStop
+														 HRTIM_BMCR_BMPREN;															// TABM = 0: Timer A counts on, REP interrupt and ADC trigger go on
+	HRTIM1->sCommonRegs.BMCMPR = BURST_IDLE_PERIODS;													// idle from the burst start to BMCMPR
+	HRTIM1->sCommonRegs.BMPER = BURST_PERIODS - 1;														// burst counter 0..BMPER
+
+#if HRTIM_PHASES > 1
+	HRTIM1->sCommonRegs.CR2 = PHASE_SWU_BITS | HRTIM_CR2_MSWU;
+
+	HRTIM1->sMasterRegs.MCR |= PHASE_CEN_BITS | HRTIM_MCR_MCEN;
+#else
 	HRTIM1->sCommonRegs.CR2 = HRTIM_CR2_TASWU;
 
+#if HRTIM_PEAK_CURRENT
+	HRTIM1->sMasterRegs.MCR |= HRTIM_MCR_TACEN | HRTIM_MCR_TECEN;
+#else
 	HRTIM1->sMasterRegs.MCR |= HRTIM_MCR_TACEN;
+#endif
+#endif
 
 
 	NVIC_SetPriority(HRTIM1_TIMA_IRQn, 0);
@@ -90,6 +172,34 @@ void hrtimersGpioInit(void){
 	GPIOA->AFR[1] &= ~(GPIO_AFRH_AFRH1_Msk | GPIO_AFRH_AFRH0_Msk);						// enable alternate function for the pins PA8, PA9
 	GPIOA->AFR[1] |= (ALT_FUNC_13 << GPIO_AFRH_AFRH1_Pos) | (ALT_FUNC_13 << GPIO_AFRH_AFRH0_Pos);
 
+#if HRTIM_PHASES > 1																												// TB1 TB2 on PA10, PA11
+	GPIOA->MODER &= ~(GPIO_MODER_MODER11_Msk | GPIO_MODER_MODER10_Msk);
+	GPIOA->MODER |= (MODE_AF << GPIO_MODER_MODER11_Pos) | (MODE_AF << GPIO_MODER_MODER10_Pos);
+	GPIOA->OTYPER &= ~(GPIO_OTYPER_OT_11 | GPIO_OTYPER_OT_10);
+	GPIOA->PUPDR &= ~(GPIO_PUPDR_PUPDR11_Msk | GPIO_PUPDR_PUPDR10_Msk);
+	GPIOA->OSPEEDR |= (HIGH_SPEED_OUT << GPIO_OSPEEDER_OSPEEDR11_Pos) | (HIGH_SPEED_OUT << GPIO_OSPEEDER_OSPEEDR10_Pos);
+	GPIOA->AFR[1] &= ~(GPIO_AFRH_AFRH3_Msk | GPIO_AFRH_AFRH2_Msk);
+	GPIOA->AFR[1] |= (ALT_FUNC_13 << GPIO_AFRH_AFRH3_Pos) | (ALT_FUNC_13 << GPIO_AFRH_AFRH2_Pos);
+#endif
+#if HRTIM_PHASES > 2																												// TC1 TC2 on PB12, PB13, PB12 is an ADC input on this board
+	GPIOB->MODER &= ~(GPIO_MODER_MODER13_Msk | GPIO_MODER_MODER12_Msk);
+	GPIOB->MODER |= (MODE_AF << GPIO_MODER_MODER13_Pos) | (MODE_AF << GPIO_MODER_MODER12_Pos);
+	GPIOB->OTYPER &= ~(GPIO_OTYPER_OT_13 | GPIO_OTYPER_OT_12);
+	GPIOB->PUPDR &= ~(GPIO_PUPDR_PUPDR13_Msk | GPIO_PUPDR_PUPDR12_Msk);
+	GPIOB->OSPEEDR |= (HIGH_SPEED_OUT << GPIO_OSPEEDER_OSPEEDR13_Pos) | (HIGH_SPEED_OUT << GPIO_OSPEEDER_OSPEEDR12_Pos);
+	GPIOB->AFR[1] &= ~(GPIO_AFRH_AFRH5_Msk | GPIO_AFRH_AFRH4_Msk);
+	GPIOB->AFR[1] |= (ALT_FUNC_13 << GPIO_AFRH_AFRH5_Pos) | (ALT_FUNC_13 << GPIO_AFRH_AFRH4_Pos);
+#endif
+#if HRTIM_PHASES > 3																												// TD1 TD2 on PB14, PB15, ADC inputs on this board
+	GPIOB->MODER &= ~(GPIO_MODER_MODER15_Msk | GPIO_MODER_MODER14_Msk);
+	GPIOB->MODER |= (MODE_AF << GPIO_MODER_MODER15_Pos) | (MODE_AF << GPIO_MODER_MODER14_Pos);
+	GPIOB->OTYPER &= ~(GPIO_OTYPER_OT_15 | GPIO_OTYPER_OT_14);
+	GPIOB->PUPDR &= ~(GPIO_PUPDR_PUPDR15_Msk | GPIO_PUPDR_PUPDR14_Msk);
+	GPIOB->OSPEEDR |= (HIGH_SPEED_OUT << GPIO_OSPEEDER_OSPEEDR15_Pos) | (HIGH_SPEED_OUT << GPIO_OSPEEDER_OSPEEDR14_Pos);
+	GPIOB->AFR[1] &= ~(GPIO_AFRH_AFRH7_Msk | GPIO_AFRH_AFRH6_Msk);
+	GPIOB->AFR[1] |= (ALT_FUNC_13 << GPIO_AFRH_AFRH7_Pos) | (ALT_FUNC_13 << GPIO_AFRH_AFRH6_Pos);
+#endif
+
 }
 
 /******************************************************************************************
@@ -97,19 +207,57 @@ void hrtimersGpioInit(void){
 *  Is called from HRTIM interrupt
 *******************************************************************************************/
 uint16_t hrtimerUpdateDuty(uint16_t dutycycle){
+#if HRTIM_PHASES > 1
+	uint16_t k;
+	for(k = 0; k < HRTIM_PHASES; k++){
+		HRTIM1->sTimerxRegs[TIM_A + k].CMP1xR = (uint16_t)(dutycycle + hrtimPhaseTrim[k]);	// common duty and the trim of the phase
+	}
+#else
 	HRTIM1->sTimerxRegs[TIM_A].CMP1xR = dutycycle;														// CMP1 for duty cycle regulation
+#endif
 	HRTIM1->sTimerxRegs[TIM_A].CMP2xR = dutycycle + ADC_OFFSET;
 	return 0;
 }
 
+/******************************************************************************************
+*  Rising and falling dead time of every phase, Tdtg counts.
+*  DTxR has no preload, the new values act from the next edge.
+*******************************************************************************************/
+void hrtimerSetDeadTime(uint16_t rise, uint16_t fall){
+	uint16_t k;
+
+	for(k = 0; k < HRTIM_PHASES; k++){
+		HRTIM1->sTimerxRegs[TIM_A + k].DTxR = (HRTIM1->sTimerxRegs[TIM_A + k].DTxR & ~(HRTIM_DTR_DTR_Msk | HRTIM_DTR_DTF_Msk)) |
+																					((uint32_t)rise << HRTIM_DTR_DTR_Pos) | ((uint32_t)fall << HRTIM_DTR_DTF_Pos);
+	}
+}
+
+/******************************************************************************************
+*  Period of the next PWM period, the phase shifts follow it
+*  Is called from HRTIM interrupt
+*******************************************************************************************/
+void hrtimerUpdatePeriod(uint16_t period){
+#if HRTIM_PHASES > 1
+	HRTIM1->sMasterRegs.MPER = period;
+	HRTIM1->sMasterRegs.MCMP1R = (uint32_t)period / HRTIM_PHASES;
+#if HRTIM_PHASES > 2
+	HRTIM1->sMasterRegs.MCMP2R = (uint32_t)period * 2 / HRTIM_PHASES;
+#endif
+#if HRTIM_PHASES > 3
+	HRTIM1->sMasterRegs.MCMP3R = (uint32_t)period * 3 / HRTIM_PHASES;
+#endif
+#else
+	HRTIM1->sTimerxRegs[TIM_A].PERxR = period;																// next period for timer
+#endif
+}
+
 /******************************************************************************************
 *
 * 
 *******************************************************************************************/
 uint16_t hrtimersOutEnable(uint16_t duty){
-	HRTIM1->sTimerxRegs[TIM_A].CMP1xR = duty;																	// CMP1 event for duty cycle regulation
-	HRTIM1->sTimerxRegs[TIM_A].CMP2xR = duty + ADC_OFFSET;
-	HRTIM1->sCommonRegs.OENR = HRTIM_OENR_TA1OEN | HRTIM_OENR_TA2OEN;
+	hrtimerUpdateDuty(duty);																									// CMP1 event for duty cycle regulation
+	HRTIM1->sCommonRegs.OENR = PHASE_OUT_BITS;																// Tx1 Tx2 of every phase
 	return duty;
 }
 
@@ -118,5 +266,20 @@ uint16_t hrtimersOutEnable(uint16_t duty){
 *
 *******************************************************************************************/
 void hrtimersOutDisable(void){
-	HRTIM1->sCommonRegs.ODISR = HRTIM_ODISR_TA1ODIS | HRTIM_ODISR_TA2ODIS;		// TA1 TA2 outputs disable
+	HRTIM1->sCommonRegs.ODISR = PHASE_OUT_BITS;																// Tx1 Tx2 outputs disable
+	hrtimersBurstStop();
+}
+
+/******************************************************************************************
+*  Pulse skipping at light load: BURST_IDLE_PERIODS of every BURST_PERIODS PWM periods
+*  have no pulse, the duty of the other periods is set by the regulator as usual
+*******************************************************************************************/
+void hrtimersBurstStart(void){
+	HRTIM1->sCommonRegs.BMCR |= HRTIM_BMCR_BME;
+	HRTIM1->sCommonRegs.BMTRGR = HRTIM_BMTRGR_SW;															// software start, cleared by hardware
+}
+
+void hrtimersBurstStop(void){
+	HRTIM1->sCommonRegs.BMCR &= ~HRTIM_BMCR_BMSTAT;														// writing 0 ends the burst at once
+	HRTIM1->sCommonRegs.BMCR &= ~HRTIM_BMCR_BME;
 }
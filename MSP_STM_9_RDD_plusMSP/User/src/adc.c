@@ -14,6 +14,36 @@ static const float conversCoeffArray[] = { I_CONVERCE_COEFF, VIN_CONVERCE_COEFF,
 																					 LEAK_REF_COEFF, LEAK_CHK_COEFF, TMP_CASE_COEFF, INT_REF_COEFF };
 */
 
+static uint32_t adcDmaCount;																				// words of the DMA buffer
+
+typedef char adcSlowRoundCheck_t[((ADC_SLOW_PAIRS << ADC_SLOW_DIV_LOG2) == (1U << ADC_SLOW_ROUND_LOG2) &&
+																	(!ADC_SLOW_ROUND_ROBIN || ADC_INJECTED_FAST)) ? 1 : -1];
+
+#if ADC_SLOW_ROUND_ROBIN
+static const uint8_t adcSlowCh1[ADC_SLOW_PAIRS] = { VREF_CPU, TMP_CMP, V_LEAK_REF, TMP_CASE };
+static const uint8_t adcSlowCh2[ADC_SLOW_PAIRS] = { V12_SENSOR, I_OUTCOM_SENSOR, V_LEAK_CHECK, V_INT_REF };
+#endif
+
+/******************************************************************************************
+ *  Conversions of both groups stopped, the master stops ADC2 too. Thresholds and watchdog
+ *  channels may be written only so.
+ ******************************************************************************************/
+static void adcStop(void){
+	if(ADC1->CR & ADC_CR_ADSTART) { ADC1->CR |= ADC_CR_ADSTP; }
+#if ADC_INJECTED_FAST
+	if(ADC1->CR & ADC_CR_JADSTART) { ADC1->CR |= ADC_CR_JADSTP; }
+#endif
+	while((ADC1->CR | ADC2->CR) & (ADC_CR_ADSTART | ADC_CR_JADSTART)){};
+}
+
+static void adcStart(void){
+#if ADC_INJECTED_FAST
+	ADC1->CR |= ADC_CR_JADSTART;																							// waits for HRTIM_ADCTRG2, the regular sequence is started by the control
+#else
+	ADC1->CR |= ADC_CR_ADSTART;
+#endif
+}
+
 /******************************************************************************************
  *  ADC1 channel 1:  VREF_CPU
  *  ADC1 channel 2:  I_OUT_SENSOR
@@ -37,6 +67,10 @@ static const float conversCoeffArray[] = { I_CONVERCE_COEFF, VIN_CONVERCE_COEFF,
  *  4: (ADC1_4, ADC2_13) - TMP_CMP, I_OUTCOM_SENSOR
  *  5: (ADC1_7, ADC2_8)  - V_LEAK_REF, V_LEAK_CHECK
  *  5: (ADC1_9, ADC2_18) - TMP_CASE, V_INT_REF
+ *
+ *  ADC_INJECTED_FAST: 1 and 2 are the injected sequence of every HRTIM trigger, the
+ *  regular sequence 3..6 is started by software from the control, no HRTIM trigger.
+ *  ADC_SLOW_ROUND_ROBIN: the regular sequence is one of 3..6, see adcSlowStart.
  ******************************************************************************************/
 void initAdcToDualRegularSimultaneousMode(void){  // call from DCDC_Init  
 
@@ -58,7 +92,11 @@ void initAdcToDualRegularSimultaneousMode(void){  // call from DCDC_Init
 											ADC12_CCR_MDMA_1 |																		// MDMA mode enabled (A single DMA channel is used)
 											ADC12_CCR_DMACFG |																		// DMA Circular Mode selected
 											ADC12_CCR_CKMODE_1 |																	// synchronous clock mode ADC_clk = HCLK/2 = 36 MHz
+#if ADC_INJECTED_FAST
+											ADC12_CCR_MULTI_0;																		// dual ADC mode: combined regular simultaneous + injected simultaneous
+#else
 											ADC12_CCR_MULTI_2 | ADC12_CCR_MULTI_1;  							// dual ADC mode selection as Regular simultaneous mode only
+#endif
 	
 	ADC1->CR |= ADC_CR_ADCAL;																									// Calibrate the ADC1 in single-ended input mode
 	while(ADC1->CR & ADC_CR_ADCAL);
@@ -71,6 +109,37 @@ void initAdcToDualRegularSimultaneousMode(void){  // call from DCDC_Init
 	ADC2->CR |= ADC_CR_ADEN;																									// enable ADC2
 	while((ADC2->ISR & ADC_ISR_ADRDY) == 0);
 
+#if ADC_INJECTED_FAST
+	ADC1->CFGR |= ( I_OUT_SENSOR << ADC_CFGR_AWD1CH_Pos )|										// enable analog watchdog for I OUT, now an injected channel
+								ADC_CFGR_JAWD1EN | ADC_CFGR_AWD1SGL;												// no EXTEN: the regular sequence is started by software
+
+	ADC1->JSQR =	ADC_JSQR_JL_0 |																							// injected sequence from 2 conversions
+								( HRTIM_ADCTRG2 << ADC_JSQR_JEXTSEL_Pos ) |
+								ADC_JSQR_JEXTEN_0 |																					// 01: Hardware trigger detection on the rising edge
+								( I_IN_SENSOR << ADC_JSQR_JSQ1_Pos ) |
+								( I_OUT_SENSOR << ADC_JSQR_JSQ2_Pos );
+
+	ADC2->JSQR =	ADC_JSQR_JL_0 |																							// the master trigger starts ADC2
+								( V_IN_SENSOR << ADC_JSQR_JSQ1_Pos ) |
+								( V_OUT_SENSOR << ADC_JSQR_JSQ2_Pos );
+
+#if ADC_SLOW_ROUND_ROBIN
+	ADC1->SQR1 = 	( VREF_CPU << ADC_SQR1_SQ1_Pos );														// one conversion, the pair is selected by adcSlowStart
+	ADC2->SQR1 =	( V12_SENSOR << ADC_SQR1_SQ1_Pos );
+#else
+	ADC1->SQR1 = 	(FOUR_CONVERS << ADC_SQR1_L_Pos) |													// slow sequence from 4 conversions
+								( VREF_CPU << ADC_SQR1_SQ1_Pos ) |
+								( TMP_CMP << ADC_SQR1_SQ2_Pos ) |
+								( V_LEAK_REF << ADC_SQR1_SQ3_Pos ) |
+								( TMP_CASE << ADC_SQR1_SQ4_Pos );
+
+	ADC2->SQR1 =	( FOUR_CONVERS << ADC_SQR1_L_Pos) |
+								( V12_SENSOR << ADC_SQR1_SQ1_Pos ) |
+								( I_OUTCOM_SENSOR << ADC_SQR1_SQ2_Pos ) |
+								( V_LEAK_CHECK << ADC_SQR1_SQ3_Pos ) |
+								( V_INT_REF << ADC_SQR1_SQ4_Pos );
+#endif
+#else
 	ADC1->CFGR |= ( I_OUT_SENSOR << ADC_CFGR_AWD1CH_Pos )|										// enable analog watchdog for I OUT
 								ADC_CFGR_AWD1EN | ADC_CFGR_AWD1SGL |
 								ADC_CFGR_EXTSEL_2 | ADC_CFGR_EXTSEL_1 | ADC_CFGR_EXTSEL_0 |	// HRTIM_ADCTRG1 event Internal signal from on chip timers EXTSEL[3:0] = 0111
@@ -85,13 +154,6 @@ void initAdcToDualRegularSimultaneousMode(void){  // call from DCDC_Init
 	ADC1->SQR2 = 	( V_LEAK_REF << ADC_SQR2_SQ5_Pos ) |
 								( TMP_CASE << ADC_SQR2_SQ6_Pos );
 
-	ADC1->SMPR1 |= ( ADC_SMPL_7C5 << ADC_SMPR1_SMP1_Pos ) |										// Tconv = (7.5 + 12.5) ADC clock cycles = 20 ADC clock cycles = 20/36 = 0.55 µs 
-								 ( ADC_SMPL_7C5 << ADC_SMPR1_SMP2_Pos ) |
-								 ( ADC_SMPL_7C5 << ADC_SMPR1_SMP3_Pos ) |
-								 ( ADC_SMPL_7C5 << ADC_SMPR1_SMP4_Pos ) |
-								 ( ADC_SMPL_7C5 << ADC_SMPR1_SMP7_Pos ) |
-								 ( ADC_SMPL_7C5 << ADC_SMPR1_SMP9_Pos );
-
 	ADC2->SQR1 =	( SIX_CONVERS << ADC_SQR1_L_Pos) |													// sequence from 6 conversions 
 								( V_IN_SENSOR << ADC_SQR1_SQ1_Pos ) |
 								( V_OUT_SENSOR << ADC_SQR1_SQ2_Pos ) |
@@ -100,6 +162,14 @@ void initAdcToDualRegularSimultaneousMode(void){  // call from DCDC_Init
 
 	ADC2->SQR2 = 	( V_LEAK_CHECK << ADC_SQR2_SQ5_Pos ) |
 								( V_INT_REF << ADC_SQR2_SQ6_Pos );
+#endif
+
+	ADC1->SMPR1 |= ( ADC_SMPL_7C5 << ADC_SMPR1_SMP1_Pos ) |										// Tconv = (7.5 + 12.5) ADC clock cycles = 20 ADC clock cycles = 20/36 = 0.55 µs 
+								 ( ADC_SMPL_7C5 << ADC_SMPR1_SMP2_Pos ) |
+								 ( ADC_SMPL_7C5 << ADC_SMPR1_SMP3_Pos ) |
+								 ( ADC_SMPL_7C5 << ADC_SMPR1_SMP4_Pos ) |
+								 ( ADC_SMPL_7C5 << ADC_SMPR1_SMP7_Pos ) |
+								 ( ADC_SMPL_7C5 << ADC_SMPR1_SMP9_Pos );
 
 	ADC2->SMPR1 |= ( ADC_SMPL_7C5 << ADC_SMPR1_SMP8_Pos );
 
@@ -109,11 +179,19 @@ void initAdcToDualRegularSimultaneousMode(void){  // call from DCDC_Init
 								 ( ADC_SMPL_7C5 << ADC_SMPR2_SMP15_Pos ) |
 								 ( ADC_SMPL_7C5 << ADC_SMPR2_SMP18_Pos );
 
+#if ADC_INJECTED_FAST
+	ADC1->ISR = ADC_ISR_JEOS | ADC_ISR_AWD1;
+	ADC1->IER = ADC_IER_JEOSIE | ADC_IER_AWD1IE;															// ADC2 ends its injected pair together with ADC1
+	adcStart();
+
+	NVIC_SetPriority(ADC1_2_IRQn, 0);																					// the control runs at JEOS
+#else
 	ADC1->ISR = ADC_ISR_EOS | ADC_ISR_AWD1;	
 	ADC1->IER = ADC_IER_AWD1IE;
-	ADC1->CR |= ADC_CR_ADSTART;
+	adcStart();
 
 	NVIC_SetPriority(ADC1_2_IRQn, 1);
+#endif
 	NVIC_EnableIRQ(ADC1_2_IRQn);
 }
 
@@ -124,6 +202,7 @@ void initAdcToDualRegularSimultaneousMode(void){  // call from DCDC_Init
 void initDmaForAdc(uint32_t adcBuffAddr, uint32_t byteCount){   // call from DCDC_Init
 
 	RCC->AHBENR |= RCC_AHBENR_DMA1EN;																	// enable clock for DMA1
+	adcDmaCount = byteCount;
 
 	DMA1_Channel1->CPAR = (uint32_t) (&(ADC12_COMMON->CDR));					// set the peripheral register address in the DMA 
 	DMA1_Channel1->CMAR = adcBuffAddr;																// set the memory address in the DMA
@@ -133,11 +212,31 @@ void initDmaForAdc(uint32_t adcBuffAddr, uint32_t byteCount){   // call from DCD
 											 DMA_CCR_PSIZE_1 |														// peripheral size size  PSIZE[1:0] = 10: 32-bits
 											 DMA_CCR_MINC	|																// memory increment mode enabled 
 										   DMA_CCR_CIRC |																// circular mode enabled
+#if ADC_INJECTED_FAST
+											 DMA_CCR_EN;																	// slow channels only, read by the control, no interrupt
+#else
+											 DMA_CCR_HTIE |																// half transfer interrupt enable, ping-pong buffer
 											 DMA_CCR_TCIE |												 				// transfer complete interrupt enable
 											 DMA_CCR_EN;																	// channel enable
 
 	NVIC_SetPriority(DMA1_Channel1_IRQn, 1);
 	NVIC_EnableIRQ(DMA1_Channel1_IRQn);
+#endif
+}
+
+/******************************************************************************************
+ *  Software start of the regular sequence, ADC_INJECTED_FAST. With ADC_SLOW_ROUND_ROBIN
+ *  the sequence is the one pair; SQR1 may be written since the last conversion of the
+ *  pair, ADSTART is clear again well before the next start.
+ ******************************************************************************************/
+void adcSlowStart(uint8_t pair){
+#if ADC_SLOW_ROUND_ROBIN
+	ADC1->SQR1 = (uint32_t)adcSlowCh1[pair] << ADC_SQR1_SQ1_Pos;
+	ADC2->SQR1 = (uint32_t)adcSlowCh2[pair] << ADC_SQR1_SQ1_Pos;
+#else
+	(void)pair;
+#endif
+	ADC1->CR |= ADC_CR_ADSTART;																								// the master starts ADC2
 }
 
 /******************************************************************************************
@@ -194,10 +293,44 @@ void adcGpioConfig(void){  //call from initAdcToDualRegularSimultaneousMode
  *
  ******************************************************************************************************/
 void setAdcMasterAnalogWatchdogThresholds(uint16_t hiThr, uint16_t loThr){   //call from DCDC_init
-	ADC1->CR |= ADC_CR_ADSTP;
-	while(ADC1->CR & ADC_CR_ADSTP){};
+	NVIC_DisableIRQ(ADC1_2_IRQn);
+	adcStop();
 	ADC1->TR1 = (hiThr << ADC_TR1_HT1_Pos) | loThr;
-	ADC1->CR |= ADC_CR_ADSTART;
+	adcStart();
+	NVIC_EnableIRQ(ADC1_2_IRQn);
+}
+
+/******************************************************************************************************
+ *  AWD2 / AWD3 of both ADCs, one channel each, 8-bit window thresholds.
+ *  The thresholds are written with the ADCs stopped, the stop aborts the sequence, so the DMA
+ *  is restarted at the first pair of its buffer. One sequence is lost.
+ *  Is called by the thread: ADC1_2_IRQn is masked from the stop to the start, the JEOS control
+ *  would start the regular sequence again in between (adcSlowStart). The AWD1 peak current
+ *  fault waits for these few microseconds too.
+ ******************************************************************************************************/
+void setAdcWindowWatchdogs(const adcWatchdogs_t* pWd){
+	NVIC_DisableIRQ(ADC1_2_IRQn);
+	adcStop();
+
+	ADC1->TR2 = ((uint32_t)pWd->iIn.hi << ADC_TR2_HT2_Pos) | ((uint32_t)pWd->iIn.lo << ADC_TR2_LT2_Pos);
+	ADC1->TR3 = ((uint32_t)pWd->iOut.hi << ADC_TR3_HT3_Pos) | ((uint32_t)pWd->iOut.lo << ADC_TR3_LT3_Pos);
+	ADC1->AWD2CR = 1UL << I_IN_SENSOR;
+	ADC1->AWD3CR = 1UL << I_OUT_SENSOR;
+	ADC2->TR2 = ((uint32_t)pWd->vIn.hi << ADC_TR2_HT2_Pos) | ((uint32_t)pWd->vIn.lo << ADC_TR2_LT2_Pos);
+	ADC2->TR3 = ((uint32_t)pWd->vOut.hi << ADC_TR3_HT3_Pos) | ((uint32_t)pWd->vOut.lo << ADC_TR3_LT3_Pos);
+	ADC2->AWD2CR = 1UL << V_IN_SENSOR;
+	ADC2->AWD3CR = 1UL << V_OUT_SENSOR;
+
+	ADC1->ISR = ADC_ISR_AWD2 | ADC_ISR_AWD3;
+	ADC2->ISR = ADC_ISR_AWD2 | ADC_ISR_AWD3;
+	ADC1->IER |= ADC_IER_AWD2IE | ADC_IER_AWD3IE;																// ADC1_2_IRQn is enabled by the init
+	ADC2->IER |= ADC_IER_AWD2IE | ADC_IER_AWD3IE;
+
+	DMA1_Channel1->CCR &= ~DMA_CCR_EN;
+	DMA1_Channel1->CNDTR = adcDmaCount;
+	DMA1_Channel1->CCR |= DMA_CCR_EN;
+	adcStart();
+	NVIC_EnableIRQ(ADC1_2_IRQn);
 }
 /******************************************************************************************************
  *
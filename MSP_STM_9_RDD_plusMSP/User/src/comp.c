@@ -0,0 +1,70 @@
+/*
+ * comp.c
+ *
+ *  Created on: 17 OCT. 2026
+ *  Cycle-by-cycle output current limit: COMP2 against a DAC2 threshold
+ *
+ *  The current sensor signal goes to the COMP2 non-inverting input PA7, the threshold
+ *  comes from DAC2 channel 1 on the inverting input with no pin. The comparator
+ *  output is HRTIM external event 1 (initHighResolutionTimer), which resets the phase
+ *  outputs within the same PWM period, no interrupt is involved.
+ *  DAC and ADC both use VDDA, a DAC code is the ADC code of the same voltage.
+ *  Peak current mode: DMA1 channel 7 (HRTIM Timer E request) writes the slope
+ *  compensation ramp to the same DAC register, pcmc.c.
+ */
+
+#include "comp.h"
+
+#define MODE_ANALOG						3UL
+
+/******************************************************************************************
+*
+*
+*******************************************************************************************/
+void initCurrLimitComparator(uint16_t dacCode){
+
+	RCC->APB1ENR |= RCC_APB1ENR_DAC2EN;																					// enable DAC2 clock
+	RCC->APB2ENR |= RCC_APB2ENR_SYSCFGEN;																				// COMP registers are in SYSCFG
+
+	GPIOA->MODER |= MODE_ANALOG << GPIO_MODER_MODER7_Pos;												// PA7 COMP2 non-inverting input
+
+	setCurrLimitCode(dacCode);
+	DAC2->CR = DAC_CR_EN1;																											// OUTEN1 = 0: to the comparators only, PA6 stays free
+
+	COMP2->CSR = COMP2_CSR_COMP2INSEL_2 | COMP2_CSR_COMP2INSEL_1 | COMP2_CSR_COMP2INSEL_0 |		// inverting input DAC2_CH1
+							 COMP2_CSR_COMP2EN;																							// no OUTSEL, the HRTIM takes the output directly
+}
+
+/******************************************************************************************
+*  No trigger: the DAC output follows DHR one APB clock later
+*******************************************************************************************/
+void setCurrLimitCode(uint16_t dacCode){
+	DAC2->DHR12R1 = (dacCode > COMP_DAC_MAX) ? COMP_DAC_MAX : dacCode;
+}
+
+/******************************************************************************************
+*  Ramp of the peak current mode: memory to DAC2, one halfword per Timer E request
+*******************************************************************************************/
+void initSlopeCompensation(void){
+
+	RCC->AHBENR |= RCC_AHBENR_DMA1EN;																						// enable clock for DMA1
+
+	DMA1_Channel7->CCR = 0;
+	DMA1_Channel7->CPAR = (uint32_t)(&(DAC2->DHR12R1));												// set the peripheral register address in the DMA
+	DMA1_Channel7->CCR = DMA_CCR_PL_1 |																					// channel priority level  PL[1:0] = 10: High
+											 DMA_CCR_MSIZE_0 |																			// memory size  MSIZE[1:0] = 01: 16-bits
+											 DMA_CCR_PSIZE_0 |																			// peripheral size  PSIZE[1:0] = 01: 16-bits
+											 DMA_CCR_MINC |																					// memory increment mode enabled
+											 DMA_CCR_DIR;																						// read from memory, not circular: the ramp stops at its last step
+}
+
+/******************************************************************************************
+*  Is called from HRTIM interrupt at the period start, before the ramp clock starts
+*******************************************************************************************/
+void slopeRampStart(const uint16_t* pRamp, uint16_t steps){
+	DMA1_Channel7->CCR &= ~DMA_CCR_EN;
+	DMA1_Channel7->CMAR = (uint32_t)pRamp;
+	DMA1_Channel7->CNDTR = steps;
+	DAC2->DHR12R1 = pRamp[0];																										// settles during the blanking
+	DMA1_Channel7->CCR |= DMA_CCR_EN;
+}
@@ -0,0 +1,58 @@
+/*
+ * isrprof.c
+ *
+ *  Created on: 17 OCT. 2026
+ *  Interrupt execution time from the DWT cycle counter
+ */
+
+#include "isrprof.h"
+
+isrProfStat_t isrProfStat[ISR_PROF_NUM];
+
+/******************************************************************************************
+*  Call before the profiled interrupts are enabled
+*
+*******************************************************************************************/
+void isrProfInit(void){
+
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;														// enable the DWT unit
+	DWT->CYCCNT = 0;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;																			// start the cycle counter
+
+	isrProfReset();
+}
+
+/******************************************************************************************
+*
+*
+*******************************************************************************************/
+void isrProfReset(void){
+	uint16_t i = 0;
+
+	__disable_irq();
+	while(i < ISR_PROF_NUM){
+		uint16_t k = 0;
+		isrProfStat[i].count = 0;
+		isrProfStat[i].min = 0xFFFFFFFFU;
+		isrProfStat[i].max = 0;
+		isrProfStat[i].sum = 0;
+		while(k < ISR_PROF_BINS){
+			isrProfStat[i].bins[k++] = 0;
+		}
+		i++;
+	}
+	__enable_irq();
+}
+
+/******************************************************************************************
+*  Consistent copy of one entry, interrupts are held off for the copy only
+*
+*******************************************************************************************/
+void isrProfGet(isrProf_ent handler, isrProfStat_t* pStat){
+
+	if(handler >= ISR_PROF_NUM) { return; }
+
+	__disable_irq();
+	*pStat = isrProfStat[handler];
+	__enable_irq();
+}
@@ -12,6 +12,7 @@
 #include "meas.h"
 #include "io.h"
 #include "usci.h"
+#include "isrprof.h"
 
 
 volatile uint32_t sysTickCounter = 0;
@@ -51,6 +52,7 @@ int main(void)
 	
 	SystemCoreClock = setSystemClock();
 	SysTick_Config(SystemCoreClock / 1000);																		// set ssystem tick = 1 ms
+	isrProfInit();
 	DCDC_Init();
 	initTim3();
 	
@@ -76,15 +78,19 @@ int main(void)
 *
 **************************************************************************************************************************/
 void SysTick_Handler(void){ 
+	ISR_PROF_ENTER();
 	sysTickCounter--;//do not used
 	SCH_incrMs();
+	ISR_PROF_EXIT(ISR_PROF_SYSTICK);
 }
 
 void TIM3_IRQHandler(void)
 {
+	ISR_PROF_ENTER();
 	TIM3->SR = ~TIM_SR_UIF;
 	PWM_isr();   //function from MSP430 every 512 ms
 	//RDD DEBUG debugFSM(); //RDD DEBUG
+	ISR_PROF_EXIT(ISR_PROF_TIM3);
 	
 //	if(TIM3->SR & TIM_SR_UIF){
 //		TIM3->SR = ~TIM_SR_UIF;